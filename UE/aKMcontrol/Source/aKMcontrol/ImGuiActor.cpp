@@ -6,8 +6,10 @@
 
 #include "Kismet/GameplayStatics.h"
 #include "ImGuiModule.h"
+#include "implot.h"
 #include "Engine/Engine.h"
 #include "UEJackAudioLinkSubsystem.h"
+#include "akMJackGraphSubsystem.h"
 #include "GameFramework/PlayerController.h"
 #include "Misc/OutputDevice.h"
 #include "Misc/ScopeLock.h"
@@ -58,6 +60,10 @@ void AImGuiActor::BeginPlay()
 			// Defer initial scan until akM server is ready (handled in Tick)
 		}
 	}
+	if (SpatServerManager)
+	{
+		SpatServerManager->OnPatchbayRuleNotApplied.AddDynamic(this, &AImGuiActor::OnPatchbayRuleNotApplied);
+	}
 
 	// Attach internal logs capture to UE log
 	if (!InternalLogCapture.IsValid())
@@ -72,6 +78,10 @@ void AImGuiActor::BeginPlay()
 
 void AImGuiActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	if (SpatServerManager)
+	{
+		SpatServerManager->OnPatchbayRuleNotApplied.RemoveDynamic(this, &AImGuiActor::OnPatchbayRuleNotApplied);
+	}
 	if (GLog && InternalLogCapture.IsValid())
 	{
 		GLog->RemoveOutputDevice(InternalLogCapture.Get());
@@ -286,8 +296,25 @@ void AImGuiActor::Tick(float DeltaTime)
 	ImGui::SameLine(0,10);
 
 	ImGui::BeginChild("InternalLogsContainer", ImVec2(AvailableSize.x * 0.5f - 10, 0),ImGuiChildFlags_None,ImGuiWindowFlags_NoScrollbar);
-	ImGui::Text("akM Control Internal Logs");
-	RenderInternalLogsWindow();
+	if (ImGui::BeginTabBar("BottomRightTabs"))
+	{
+		if (ImGui::BeginTabItem("akM Control Internal Logs"))
+		{
+			RenderInternalLogsWindow();
+			ImGui::EndTabItem();
+		}
+		if (ImGui::BeginTabItem("Spectrum"))
+		{
+			RenderSpectrumWindow();
+			ImGui::EndTabItem();
+		}
+		if (ImGui::BeginTabItem("Level History"))
+		{
+			RenderLevelHistoryWindow();
+			ImGui::EndTabItem();
+		}
+		ImGui::EndTabBar();
+	}
 	
 	ImGui::EndChild();
 
@@ -333,7 +360,7 @@ void AImGuiActor::Tick(float DeltaTime)
 				TArray<FString> Clients = Subsystem->GetConnectedClients();
 				for (const FString& Client : Clients)
 				{
-					if (Client.Equals(TEXT("scsynth"), ESearchCase::IgnoreCase)) { continue; }
+					if (SpatServerManager->IsServerJackClient(Client)) { continue; }
 					if (!UnrealClientName.IsEmpty() && Client.Equals(UnrealClientName, ESearchCase::IgnoreCase)) { continue; }
 					TArray<FString> Inputs, Outputs;
 					Subsystem->GetClientPorts(Client, Inputs, Outputs);
@@ -448,7 +475,7 @@ void AImGuiActor::RenderAkMServerWindow() const
 	if (SpatServerManager != nullptr)
 	{
 
-		ImGui::BeginChild("akM_Server",ImVec2(0,200),true,ImGuiChildFlags_Borders);
+		ImGui::BeginChild("akM_Server",ImVec2(0,300),true,ImGuiChildFlags_Borders);
 
 		bool bServerAlive = SpatServerManager->bIsServerAlive;
 		bool bServerIsStarting = SpatServerManager->bServerIsStarting;
@@ -499,10 +526,14 @@ void AImGuiActor::RenderAkMServerWindow() const
 				if (UUEJackAudioLinkSubsystem* Subsystem = GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>())
 				{
 					CpuLoad = Subsystem->GetCpuLoad(); // 0..100
-					TArray<FString> ScIn, ScOut;
-					Subsystem->GetClientPorts(TEXT("scsynth"), ScIn, ScOut);
-					NumScInputs = ScIn.Num();
-					NumScOutputs = ScOut.Num();
+				}
+				if (UakMJackGraphSubsystem* JackGraph = GEngine->GetEngineSubsystem<UakMJackGraphSubsystem>())
+				{
+					if (!JackGraph->GetPortCounts(SpatServerManager->ActiveServerJackClientName, NumScInputs, NumScOutputs))
+					{
+						NumScInputs = -1;
+						NumScOutputs = -1;
+					}
 				}
 			}
 
@@ -525,25 +556,402 @@ void AImGuiActor::RenderAkMServerWindow() const
 			}
 		}
 
-		ImGui::Separator();
-
-		// Scrollable child region
-		ImGui::SetWindowFontScale(0.9f);
-		ImGui::BeginChild("ConsoleRegion", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
+		// Hot standby status
+		if (SpatServerManager->bEnableHotStandby)
+		{
+			const bool bStandbyReady = SpatServerManager->bStandbyReady;
+			ImGui::TextColored(bStandbyReady ? ImVec4(0, 1, 0, 1) : ImVec4(1, 1, 0, 1), bStandbyReady ? "Standby: READY" : (SpatServerManager->bStandbyRunning ? "Standby: BOOTING" : "Standby: OFF"));
+			ImGui::SameLine();
+			if (SpatServerManager->FailoverCount > 0)
+			{
+				ImGui::Text("Failovers: %d  Last switch: %.1f ms  Recovery: %.1f ms", SpatServerManager->FailoverCount, SpatServerManager->LastFailoverSwitchMs, SpatServerManager->LastFailoverRecoveryMs);
+			}
+			else
+			{
+				ImGui::TextDisabled("No failover yet");
+			}
+			if (SpatServerManager->LastFailoverRoutingFailures > 0)
+			{
+				ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "Last failover: %d JACK connection(s) failed, server outputs not connected", SpatServerManager->LastFailoverRoutingFailures);
+			}
+		}
 
-		for (const FString& Line : SpatServerManager->ImGuiConsoleBuffer)
+		// Parsed server output summary
+		const FAkMServerOutputStats& Stats = SpatServerManager->ServerOutputStats;
 		{
-			ImGui::TextUnformatted(TCHAR_TO_ANSI(*Line));
+			ImGui::TextColored(Stats.NumErrors > 0 ? ImVec4(1, 0.3f, 0.3f, 1) : ImVec4(0.6f, 0.6f, 0.6f, 1), "Errors: %d", Stats.NumErrors);
+			ImGui::SameLine();
+			ImGui::TextColored(Stats.NumWarnings > 0 ? ImVec4(1, 1, 0, 1) : ImVec4(0.6f, 0.6f, 0.6f, 1), "Warnings: %d", Stats.NumWarnings);
+			ImGui::SameLine();
+			if (Stats.NumStatusReplies > 0)
+			{
+				const FAkMServerStatus& Status = Stats.LastStatus;
+				ImGui::Text("UGens: %d  Synths: %d  Server CPU: %.1f%% avg / %.1f%% peak", Status.NumUGens, Status.NumSynths, Status.AvgCPU, Status.PeakCPU);
+			}
+			else
+			{
+				ImGui::TextDisabled("No /status reply yet");
+			}
 		}
 
-		// Auto-scroll to bottom
-		if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
-			ImGui::SetScrollHereY(1.0f);
-		
+		ImGui::Separator();
+
+		if (ImGui::BeginTabBar("ServerOutputTabs"))
+		{
+			if (ImGui::BeginTabItem("Console"))
+			{
+				// Error navigation
+				const TArray<uint64>& ErrorLines = Stats.ErrorLineNumbers;
+				if (ConsoleErrorCursor >= ErrorLines.Num())
+				{
+					ConsoleErrorCursor = INDEX_NONE;
+				}
+				ImGui::BeginDisabled(ErrorLines.Num() == 0);
+				if (ImGui::SmallButton("< Prev Error"))
+				{
+					ConsoleErrorCursor = (ConsoleErrorCursor == INDEX_NONE) ? ErrorLines.Num() - 1 : FMath::Max(0, ConsoleErrorCursor - 1);
+					ConsoleScrollToLine = int64(ErrorLines[ConsoleErrorCursor]);
+				}
+				ImGui::SameLine();
+				if (ImGui::SmallButton("Next Error >"))
+				{
+					ConsoleErrorCursor = (ConsoleErrorCursor == INDEX_NONE) ? ErrorLines.Num() - 1 : FMath::Min(ErrorLines.Num() - 1, ConsoleErrorCursor + 1);
+					ConsoleScrollToLine = int64(ErrorLines[ConsoleErrorCursor]);
+				}
+				ImGui::EndDisabled();
+				ImGui::SameLine();
+				ImGui::Text("%d / %d", ConsoleErrorCursor == INDEX_NONE ? 0 : ConsoleErrorCursor + 1, ErrorLines.Num());
+
+				// Scrollable child region
+				ImGui::SetWindowFontScale(0.9f);
+				ImGui::BeginChild("ConsoleRegion", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
+
+				const FAkMConsoleBuffer& Console = SpatServerManager->ImGuiConsoleBuffer;
+				const int64 FirstLineNumber = int64(Console.GetFirstLineNumber());
+				bool bJumped = false;
+				if (ConsoleScrollToLine >= 0)
+				{
+					const int64 TargetIndex = ConsoleScrollToLine - FirstLineNumber;
+					if (TargetIndex >= 0 && TargetIndex < Console.Num())
+					{
+						const float LineHeight = ImGui::GetTextLineHeightWithSpacing();
+						ImGui::SetScrollY(FMath::Max(0.0f, TargetIndex * LineHeight - ImGui::GetWindowHeight() * 0.5f));
+						bJumped = true;
+					}
+					ConsoleScrollToLine = -1;
+				}
+
+				// Only visible rows are submitted; lines are already UTF-8
+				ImGuiListClipper Clipper;
+				Clipper.Begin(Console.Num());
+				while (Clipper.Step())
+				{
+					for (int32 LineIndex = Clipper.DisplayStart; LineIndex < Clipper.DisplayEnd; ++LineIndex)
+					{
+						const char* LineBegin = nullptr;
+						const char* LineEnd = nullptr;
+						Console.GetLine(LineIndex, LineBegin, LineEnd);
+						const EAkMServerEventType LineType = static_cast<EAkMServerEventType>(Console.GetLineTag(LineIndex));
+						if (LineType == EAkMServerEventType::Error || LineType == EAkMServerEventType::Warning)
+						{
+							ImGui::PushStyleColor(ImGuiCol_Text, LineType == EAkMServerEventType::Error ? ImVec4(1, 0.3f, 0.3f, 1) : ImVec4(1, 1, 0, 1));
+							ImGui::TextUnformatted(LineBegin, LineEnd);
+							ImGui::PopStyleColor();
+						}
+						else
+						{
+							ImGui::TextUnformatted(LineBegin, LineEnd);
+						}
+					}
+				}
+				Clipper.End();
+
+				// Auto-scroll to bottom
+				if (!bJumped && ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
+					ImGui::SetScrollHereY(1.0f);
+
+				ImGui::EndChild();
+				ImGui::SetWindowFontScale(1.0f);
+				ImGui::EndTabItem();
+			}
+			if (ImGui::BeginTabItem("Server Stats"))
+			{
+				const TAkMRingHistory<FAkMServerStatus>& History = Stats.StatusHistory;
+				if (History.IsEmpty())
+				{
+					ImGui::TextDisabled("Waiting for /status replies from the server.");
+				}
+				else
+				{
+					// One point per /status reply, oldest on the left
+					const FAkMServerStatus* Samples = History.GetData();
+					const int32 NumSamples = History.Num();
+					const int32 Offset = History.GetOffset();
+					const float PlotHeight = FMath::Max(60.0f, ImGui::GetContentRegionAvail().y * 0.5f - 4.0f);
+					if (ImPlot::BeginPlot("##ServerCPU", ImVec2(-1, PlotHeight), ImPlotFlags_NoMenus))
+					{
+						ImPlot::SetupAxes(nullptr, "CPU %", ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+						ImPlot::PlotLine("avg", &Samples->AvgCPU, NumSamples, 1.0, 0.0, 0, Offset, sizeof(FAkMServerStatus));
+						ImPlot::PlotLine("peak", &Samples->PeakCPU, NumSamples, 1.0, 0.0, 0, Offset, sizeof(FAkMServerStatus));
+						ImPlot::EndPlot();
+					}
+					if (ImPlot::BeginPlot("##ServerNodes", ImVec2(-1, PlotHeight), ImPlotFlags_NoMenus))
+					{
+						ImPlot::SetupAxes(nullptr, "count", ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+						ImPlot::PlotStairs("UGens", &Samples->NumUGens, NumSamples, 1.0, 0.0, 0, Offset, sizeof(FAkMServerStatus));
+						ImPlot::PlotStairs("Synths", &Samples->NumSynths, NumSamples, 1.0, 0.0, 0, Offset, sizeof(FAkMServerStatus));
+						ImPlot::EndPlot();
+					}
+				}
+				ImGui::EndTabItem();
+			}
+			if (ImGui::BeginTabItem("Processes"))
+			{
+				const FAkMProcessSampler* Sampler = SpatServerManager->ProcessSampler.Get();
+				const uint32 SclangPid = Sampler ? Sampler->GetSnapshot(FAkMProcessSampler::ETarget::Sclang, SclangProcessSamples) : 0;
+				const uint32 ScsynthPid = Sampler ? Sampler->GetSnapshot(FAkMProcessSampler::ETarget::Scsynth, ScsynthProcessSamples) : 0;
+				if (SclangProcessSamples.IsEmpty() && ScsynthProcessSamples.IsEmpty())
+				{
+					ImGui::TextDisabled("No process samples yet.");
+				}
+				else
+				{
+					auto DrawSummary = [](const char* Name, uint32 Pid, const TArray<FAkMProcessSample>& Samples)
+					{
+						if (Pid == 0 || Samples.IsEmpty())
+						{
+							ImGui::TextDisabled("%s: not running", Name);
+							return;
+						}
+						const FAkMProcessSample& Last = Samples.Last();
+						if (Last.ContextSwitchesPerSec >= 0.0f)
+						{
+							ImGui::Text("%s (pid %u)  CPU %.1f%%  RSS %.1f MB  threads %d  ctx sw %.0f/s", Name, Pid, Last.CpuPercent, Last.ResidentMB, int32(Last.NumThreads), Last.ContextSwitchesPerSec);
+						}
+						else
+						{
+							ImGui::Text("%s (pid %u)  CPU %.1f%%  RSS %.1f MB  threads %d", Name, Pid, Last.CpuPercent, Last.ResidentMB, int32(Last.NumThreads));
+						}
+					};
+					DrawSummary("sclang", SclangPid, SclangProcessSamples);
+					DrawSummary("scsynth", ScsynthPid, ScsynthProcessSamples);
+
+					// X axis is minutes relative to now so both processes share it across restarts
+					struct FPlotSeries
+					{
+						const TArray<FAkMProcessSample>* Samples;
+						double Now;
+						float FAkMProcessSample::* Field;
+					};
+					auto Getter = [](int Index, void* Data) -> ImPlotPoint
+					{
+						const FPlotSeries& Series = *static_cast<const FPlotSeries*>(Data);
+						const FAkMProcessSample& Sample = (*Series.Samples)[Index];
+						return ImPlotPoint((Sample.Time - Series.Now) / 60.0, Sample.*(Series.Field));
+					};
+					const double Now = FPlatformTime::Seconds();
+					auto PlotField = [&](float FAkMProcessSample::* Field, ImPlotLineFlags Flags)
+					{
+						FPlotSeries Sclang { &SclangProcessSamples, Now, Field };
+						FPlotSeries Scsynth { &ScsynthProcessSamples, Now, Field };
+						ImPlot::PlotLineG("sclang", Getter, &Sclang, SclangProcessSamples.Num(), Flags);
+						ImPlot::PlotLineG("scsynth", Getter, &Scsynth, ScsynthProcessSamples.Num(), Flags);
+					};
+
+					const float PlotHeight = FMath::Max(60.0f, ImGui::GetContentRegionAvail().y / 3.0f - 4.0f);
+					if (ImPlot::BeginPlot("##ProcessCPU", ImVec2(-1, PlotHeight), ImPlotFlags_NoMenus))
+					{
+						ImPlot::SetupAxes(nullptr, "CPU %", ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+						PlotField(&FAkMProcessSample::CpuPercent, ImPlotLineFlags_None);
+						ImPlot::EndPlot();
+					}
+					if (ImPlot::BeginPlot("##ProcessRSS", ImVec2(-1, PlotHeight), ImPlotFlags_NoMenus))
+					{
+						ImPlot::SetupAxes(nullptr, "RSS MB", ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+						PlotField(&FAkMProcessSample::ResidentMB, ImPlotLineFlags_None);
+						ImPlot::EndPlot();
+					}
+					if (ImPlot::BeginPlot("##ProcessThreads", ImVec2(-1, -1), ImPlotFlags_NoMenus))
+					{
+						ImPlot::SetupAxes("minutes", "threads", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+						PlotField(&FAkMProcessSample::NumThreads, ImPlotLineFlags_None);
+						ImPlot::EndPlot();
+					}
+				}
+				ImGui::EndTabItem();
+			}
+			if (ImGui::BeginTabItem("Heartbeat"))
+			{
+				const FAkMRttHistogram& Rtt = SpatServerManager->RttHistogram;
+				if (Rtt.Num() == 0)
+				{
+					ImGui::TextDisabled("No /akm/pong received yet.");
+				}
+				else
+				{
+					const float P50 = Rtt.GetPercentile(0.50f);
+					const float P95 = Rtt.GetPercentile(0.95f);
+					const float P99 = Rtt.GetPercentile(0.99f);
+					ImGui::Text("RTT ms  last %.2f  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f", Rtt.GetLast(), P50, P95, P99, Rtt.GetMax());
+					ImGui::TextColored(SpatServerManager->bServerStalled ? ImVec4(1, 0.3f, 0.3f, 1) : ImVec4(0.6f, 0.6f, 0.6f, 1),
+						"%s  pending %.1f ms / stall at %.1f ms", SpatServerManager->bServerStalled ? "STALLED" : "Watchdog OK",
+						SpatServerManager->GetOldestPendingPingAgeMs(), SpatServerManager->GetStallThresholdMs());
+
+					// Step plot over log-spaced bucket edges
+					double Edges[FAkMRttHistogram::NumBuckets + 1];
+					double Counts[FAkMRttHistogram::NumBuckets + 1];
+					const int32* BucketCounts = Rtt.GetBucketCounts();
+					for (int32 Bucket = 0; Bucket <= FAkMRttHistogram::NumBuckets; ++Bucket)
+					{
+						Edges[Bucket] = FAkMRttHistogram::GetBucketEdgeMs(Bucket);
+						Counts[Bucket] = Bucket < FAkMRttHistogram::NumBuckets ? BucketCounts[Bucket] : 0.0;
+					}
+					if (ImPlot::BeginPlot("##RttHistogram", ImVec2(-1, -1), ImPlotFlags_NoMenus))
+					{
+						ImPlot::SetupAxes("RTT (ms)", "pings", ImPlotAxisFlags_None, ImPlotAxisFlags_AutoFit);
+						ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Log10);
+						ImPlot::SetupAxisLimits(ImAxis_X1, FMath::Max(double(FAkMRttHistogram::MinRttMs), P50 * 0.25), FMath::Min(double(FAkMRttHistogram::MaxRttMs), Rtt.GetMax() * 4.0), ImPlotCond_Always);
+						ImPlot::PlotStairs("RTT", Edges, Counts, FAkMRttHistogram::NumBuckets + 1, ImPlotStairsFlags_Shaded);
+						const double Marks[3] = { P50, P95, P99 };
+						ImPlot::PlotInfLines("p50/p95/p99", Marks, 3);
+						ImPlot::EndPlot();
+					}
+				}
+				ImGui::EndTabItem();
+			}
+			if (ImGui::BeginTabItem("Latency"))
+			{
+				ImGui::PushItemWidth(80);
+				ImGui::InputInt("Unreal out", &SpatServerManager->LatencyProbeUnrealOutput);
+				ImGui::SameLine();
+				ImGui::InputInt("scsynth in", &SpatServerManager->LatencyProbeServerInput);
+				ImGui::SameLine();
+				ImGui::SliderFloat("Level", &SpatServerManager->LatencyProbeLevelDb, -90.0f, -20.0f, "%.0f dBFS");
+				ImGui::PopItemWidth();
+				SpatServerManager->LatencyProbeUnrealOutput = FMath::Max(1, SpatServerManager->LatencyProbeUnrealOutput);
+				SpatServerManager->LatencyProbeServerInput = FMath::Max(1, SpatServerManager->LatencyProbeServerInput);
+
+				const bool bRunning = SpatServerManager->IsLatencyMeasurementRunning();
+				ImGui::BeginDisabled(bRunning);
+				if (ImGui::Button(bRunning ? "Measuring..." : "Measure"))
+				{
+					SpatServerManager->StartLatencyMeasurement();
+				}
+				ImGui::EndDisabled();
+				ImGui::SameLine();
+				ImGui::Checkbox("Every", &SpatServerManager->bEnablePeriodicLatencyProbe);
+				ImGui::SameLine();
+				ImGui::SetNextItemWidth(80);
+				ImGui::InputFloat("s##LatencyInterval", &SpatServerManager->LatencyProbeIntervalSeconds, 0.0f, 0.0f, "%.0f");
+				ImGui::SameLine();
+				if (ImGui::SmallButton("Reset baseline"))
+				{
+					SpatServerManager->ResetLatencyBaseline();
+				}
+				if (SpatServerManager->bLatencyDrift)
+				{
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "DRIFT (%d alarms)", SpatServerManager->LatencyDriftAlarmCount);
+				}
+
+				const TArray<FAkMLatencyResult>& Results = SpatServerManager->LatencyResults;
+				if (Results.IsEmpty())
+				{
+					ImGui::TextDisabled("No measurement yet.");
+				}
+				else if (ImGui::BeginTable("LatencyTable", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit))
+				{
+					ImGui::TableSetupScrollFreeze(0, 1);
+					ImGui::TableSetupColumn("Feed");
+					ImGui::TableSetupColumn("Unreal in");
+					ImGui::TableSetupColumn("Samples");
+					ImGui::TableSetupColumn("ms");
+					ImGui::TableSetupColumn("Baseline / PNR");
+					ImGui::TableHeadersRow();
+					const int32 SampleRate = SpatServerManager->LatencySampleRate;
+					for (int32 i = 0; i < Results.Num(); ++i)
+					{
+						const FAkMLatencyResult& Result = Results[i];
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn();
+						ImGui::Text("%d", i + 1);
+						ImGui::TableNextColumn();
+						ImGui::Text("%d", Result.Channel + 1);
+						if (Result.LatencySamples == INDEX_NONE)
+						{
+							ImGui::TableNextColumn();
+							ImGui::TextDisabled("not found");
+							ImGui::TableNextColumn();
+							ImGui::TableNextColumn();
+							ImGui::TextDisabled("%.0f dB", Result.PeakToNoiseDb);
+							continue;
+						}
+						ImGui::TableNextColumn();
+						ImGui::Text("%d", Result.LatencySamples);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.2f", SampleRate > 0 ? Result.LatencySamples * 1000.0 / SampleRate : 0.0);
+						ImGui::TableNextColumn();
+						const int32 Baseline = SpatServerManager->LatencyBaselineSamples.IsValidIndex(i) ? SpatServerManager->LatencyBaselineSamples[i] : INDEX_NONE;
+						ImGui::Text("%d / %.0f dB", Baseline, Result.PeakToNoiseDb);
+					}
+					ImGui::EndTable();
+				}
+				ImGui::EndTabItem();
+			}
+			if (ImGui::BeginTabItem("Player"))
+			{
+				const FAkMFilePlayer& Player = FAkMAudioTap::Get().GetFilePlayer();
+				const bool bPlaying = SpatServerManager->IsFilePlaying();
+				ImGui::BeginDisabled(bPlaying);
+				ImGui::SetNextItemWidth(-60);
+				ImGui::InputText("File", FilePlayerPath, sizeof(FilePlayerPath));
+				ImGui::SetNextItemWidth(160);
+				ImGui::InputText("Sources", FilePlayerSources, sizeof(FilePlayerSources));
+				ImGui::SameLine();
+				ImGui::SetNextItemWidth(80);
+				ImGui::InputInt("First Unreal out", &SpatServerManager->FilePlayerFirstUnrealOutput);
+				SpatServerManager->FilePlayerFirstUnrealOutput = FMath::Max(1, SpatServerManager->FilePlayerFirstUnrealOutput);
+				ImGui::SameLine();
+				ImGui::Checkbox("Loop", &bFilePlayerLoop);
+				ImGui::EndDisabled();
+
+				if (!bPlaying)
+				{
+					if (ImGui::Button("Play"))
+					{
+						TArray<FString> Fields;
+						FString(UTF8_TO_TCHAR(FilePlayerSources)).ParseIntoArray(Fields, TEXT(","));
+						TArray<int32> SourceIds;
+						for (const FString& Field : Fields)
+						{
+							SourceIds.Add(FCString::Atoi(*Field.TrimStartAndEnd()));
+						}
+						SpatServerManager->StartFilePlayback(UTF8_TO_TCHAR(FilePlayerPath), SourceIds, bFilePlayerLoop);
+					}
+				}
+				else
+				{
+					if (ImGui::Button("Stop"))
+					{
+						SpatServerManager->StopFilePlayback();
+					}
+					const FAkMWaveFormat& Format = Player.GetFormat();
+					const int64 FileFrames = FMath::Max<int64>(Format.GetNumFrames(), 1);
+					const double Position = Format.SampleRate > 0 ? double(Player.GetFramesPlayed() % FileFrames) / Format.SampleRate : 0.0;
+					const double Length = Format.SampleRate > 0 ? double(FileFrames) / Format.SampleRate : 0.0;
+					ImGui::SameLine();
+					ImGui::Text("%d ch  %d Hz  %.1f / %.1f s  read-ahead %.0f%%", Format.NumChannels, Format.SampleRate, Position, Length, Player.GetRingFill() * 100.0f);
+					if (Player.GetNumUnderruns() > 0)
+					{
+						ImGui::SameLine();
+						ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "%llu underruns", Player.GetNumUnderruns());
+					}
+				}
+				ImGui::EndTabItem();
+			}
+			ImGui::EndTabBar();
+		}
 
-		ImGui::EndChild();
-		ImGui::SetWindowFontScale(1.0f);
-		
 		ImGui::EndChild();
 	}
 	else {
@@ -565,56 +973,76 @@ void AImGuiActor::RenderAudioMonitoringWindow() const
 		return;
 	}
 
-	// Layout constants
-	const float MeterWidth = 10.0f;
-	const float MeterSpacing = 8.0f;
-	const float GroupPadding = 4.0f;
-
-	const ImVec2 avail = ImGui::GetContentRegionAvail();
-	const float sectionHeight = FMath::Max(0, avail.y * 0.5f);
-
-	// Helpers
+	// Meter ballistics
+	ImGui::SetNextItemWidth(140.0f);
+	if (ImGui::BeginCombo("Ballistics", TCHAR_TO_UTF8(FAkMMeterBallistics::GetPresetName(AudioManager->MeterBallistics))))
+	{
+		for (uint8 p = 0; p < uint8(EAkMMeterBallistics::Num); ++p)
+		{
+			const EAkMMeterBallistics Preset = EAkMMeterBallistics(p);
+			if (ImGui::Selectable(TCHAR_TO_UTF8(FAkMMeterBallistics::GetPresetName(Preset)), Preset == AudioManager->MeterBallistics))
+			{
+				AudioManager->MeterBallistics = Preset;
+			}
+		}
+		ImGui::EndCombo();
+	}
+	ImGui::SameLine();
+	ImGui::TextDisabled(AudioManager->IsUsingAudioThreadLevels() ? "(per audio block)" : "(polled per frame)");
 
-	auto DrawSingleMeter = [&](ImDrawList* DrawList, const ImVec2& topLeft, float meterHeight, float rms, float peak)
+	// Recorder of the speaker feeds (and optionally the sources)
+	const FAkMRecorder& Recorder = AudioManager->GetRecorder();
+	ImGui::SameLine();
+	if (Recorder.IsRecording())
 	{
-		const float MinDB = -60.0f;
-		const float MaxDB = 6.0f;
-		const float RmsDB = 20.0f * FMath::LogX(10.0f, FMath::Max(rms, 1e-9f));
-		const float PeakDB = 20.0f * FMath::LogX(10.0f, FMath::Max(peak, 1e-9f));
-		const float NormalizedRms = (FMath::Clamp(RmsDB, MinDB, MaxDB) - MinDB) / (MaxDB - MinDB);
-		const float NormalizedPeak = (FMath::Clamp(PeakDB, MinDB, MaxDB) - MinDB) / (MaxDB - MinDB);
-
-		const ImVec2 BarStart = ImVec2(topLeft.x, topLeft.y + meterHeight);
-		// Background
-		DrawList->AddRectFilled(topLeft, ImVec2(topLeft.x + MeterWidth, topLeft.y + meterHeight), IM_COL32(30, 30, 30, 255), 2.0f);
-		// RMS
-		if (NormalizedRms > 0.0f)
+		ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.8f, 0.1f, 0.1f, 1.0f));
+		if (ImGui::Button("STOP REC"))
+		{
+			AudioManager->StopRecording();
+		}
+		ImGui::PopStyleColor();
+		const int32 RecordRate = Recorder.GetSampleRate();
+		const double Elapsed = RecordRate > 0 ? double(Recorder.GetFramesWritten()) / RecordRate : 0.0;
+		const double SizeMB = double(Recorder.GetFramesWritten()) * Recorder.GetNumChannels() * sizeof(float) / (1024.0 * 1024.0);
+		ImGui::SameLine();
+		ImGui::Text("%d ch  %02d:%02d  %.0f MB  ring %.0f%%", Recorder.GetNumChannels(), int32(Elapsed) / 60, int32(Elapsed) % 60, SizeMB, Recorder.GetRingFill() * 100.0f);
+		if (Recorder.GetNumXruns() > 0)
 		{
-			const ImU32 GreenColor = IM_COL32(0, 200, 0, 255);
-			const ImU32 YellowColor = IM_COL32(255, 255, 0, 255);
-			const ImU32 RedColor = IM_COL32(255, 0, 0, 255);
-			const float YellowT = 0.75f;
-			const float RedT = 0.90f;
-			float GreenHeight = FMath::Min(meterHeight * NormalizedRms, meterHeight * YellowT);
-			DrawList->AddRectFilled(ImVec2(BarStart.x, BarStart.y - GreenHeight), ImVec2(BarStart.x + MeterWidth, BarStart.y), GreenColor, 2.0f, ImDrawFlags_RoundCornersBottom);
-			if (NormalizedRms > YellowT)
+			ImGui::SameLine();
+			ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "%llu xruns (%lld frames silenced)", Recorder.GetNumXruns(), Recorder.GetDroppedFrames());
+		}
+	}
+	else
+	{
+		if (ImGui::Button("REC"))
+		{
+			TArray<int32> Inputs = SpatServerManager->ConnectedUnrealInputIndicesFromScsynth;
+			if (bRecordSources)
 			{
-				float YellowHeight = FMath::Min(meterHeight * NormalizedRms, meterHeight * RedT) - GreenHeight;
-				DrawList->AddRectFilled(ImVec2(BarStart.x, BarStart.y - GreenHeight - YellowHeight), ImVec2(BarStart.x + MeterWidth, BarStart.y - GreenHeight), YellowColor);
+				TArray<FString> Clients;
+				SpatServerManager->ConnectedUnrealInputIndicesByClient.GetKeys(Clients);
+				Clients.Sort();
+				for (const FString& Client : Clients)
+				{
+					Inputs.Append(SpatServerManager->ConnectedUnrealInputIndicesByClient[Client]);
+				}
 			}
-			if (NormalizedRms > RedT)
+			if (!Inputs.IsEmpty())
 			{
-				float RedHeight = (meterHeight * NormalizedRms) - (meterHeight * RedT);
-				DrawList->AddRectFilled(ImVec2(BarStart.x, BarStart.y - (meterHeight * RedT) - RedHeight), ImVec2(BarStart.x + MeterWidth, BarStart.y - (meterHeight * RedT)), RedColor);
+				AudioManager->StartRecording(Inputs);
 			}
 		}
-		// Peak
-		if (NormalizedPeak > 0.0f)
-		{
-			const float PeakLineY = BarStart.y - (meterHeight * NormalizedPeak);
-			DrawList->AddLine(ImVec2(topLeft.x, PeakLineY), ImVec2(topLeft.x + MeterWidth, PeakLineY), IM_COL32(255, 255, 255, 180), 1.0f);
-		}
-	};
+		ImGui::SameLine();
+		ImGui::Checkbox("with sources", &bRecordSources);
+	}
+
+	const ImVec2 avail = ImGui::GetContentRegionAvail();
+	const float sectionHeight = FMath::Max(0, avail.y * 0.5f);
+	const float meterHeight = 80.0f;
+
+	// Meter layouts are rebuilt only when the routing changes
+	const UakMJackGraphSubsystem* JackGraph = GEngine ? GEngine->GetEngineSubsystem<UakMJackGraphSubsystem>() : nullptr;
+	const uint64 RoutingGeneration = JackGraph ? JackGraph->GetGraph().GetGeneration() : 0;
 
 	const bool bHaveScsynth = SpatServerManager->ConnectedUnrealInputIndicesFromScsynth.Num() > 0;
 	const bool bHaveSources = SpatServerManager->ConnectedUnrealInputIndicesByClient.Num() > 0;
@@ -636,69 +1064,78 @@ void AImGuiActor::RenderAudioMonitoringWindow() const
 		ImGui::BeginChild("SpeakersOutputChild", ImVec2(0, sectionHeight), true, ImGuiWindowFlags_HorizontalScrollbar);
 		ImGui::SetWindowFontScale(1.0f);
 
+		// Columns of three speakers, the last one being the subs
 		const TArray<int32>& UnrealInputsFromSc = SpatServerManager->ConnectedUnrealInputIndicesFromScsynth;
-		const int32 totalPorts = UnrealInputsFromSc.Num();
-		const int32 numGroups = FMath::DivideAndRoundUp(totalPorts, 3);
-		const float meterHeight = 80.0f;
+		if (!SpeakersMeterBank.IsLayoutValid(RoutingGeneration, UnrealInputsFromSc.Num()))
+		{
+			SpeakersMeterBank.ResetLayout(RoutingGeneration, UnrealInputsFromSc.Num());
+			const int32 numGroups = FMath::DivideAndRoundUp(UnrealInputsFromSc.Num(), 3);
+			for (int32 g = 0; g < numGroups; ++g)
+			{
+				const TConstArrayView<int32> Inputs = MakeArrayView(UnrealInputsFromSc).Slice(g * 3, FMath::Min(3, UnrealInputsFromSc.Num() - g * 3));
+				SpeakersMeterBank.AddGroup(g == numGroups - 1 ? FString(TEXT("SUBS")) : FString::Printf(TEXT("COL. %d"), g + 1), Inputs, Inputs);
+			}
+		}
+		const int32 numGroups = SpeakersMeterBank.GetNumGroups();
 
 		ImGui::Text("SPEAKERS OUTPUT");
 
+		// Loudness (BS.1770): master without subs, per column below the meters
+		const auto FormatLufs = [](float Lufs) { return Lufs <= FAkMLoudness::MinLufs ? FString(TEXT("  -inf")) : FString::Printf(TEXT("%6.1f"), Lufs); };
+		const bool bHaveLoudness = AudioManager->IsUsingAudioThreadLevels() && AudioManager->GroupLoudness.Num() > 0;
+		if (bHaveLoudness)
+		{
+			const FAkMLoudness& Master = AudioManager->MasterLoudness;
+			ImGui::SameLine();
+			ImGui::Text("  MASTER  M %s  S %s  I %s LUFS", TCHAR_TO_UTF8(*FormatLufs(Master.MomentaryLufs)),
+				TCHAR_TO_UTF8(*FormatLufs(Master.ShortTermLufs)), TCHAR_TO_UTF8(*FormatLufs(Master.IntegratedLufs)));
+			ImGui::SameLine();
+			if (ImGui::SmallButton("Reset I"))
+			{
+				FAkMAudioTap::Get().GetLoudnessMeter().ResetIntegrated();
+			}
+		}
+
 		ImGuiTableFlags TableFlags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_ScrollX;
-		const int32 tableCols = numGroups; //
-		if (ImGui::BeginTable("SpeakersTable", tableCols, TableFlags, ImVec2(0, 0)))
+		if (numGroups > 0 && ImGui::BeginTable("SpeakersTable", numGroups, TableFlags, ImVec2(0, 0)))
 		{
 			for (int32 g = 0; g < numGroups; ++g)
 			{
-				const int32 countInGroup = FMath::Min(3, totalPorts - g * 3);
-				const float groupWidth = countInGroup * MeterWidth + (countInGroup - 1) * MeterSpacing + GroupPadding * 2.0f;
-				FString ColName = FString::Printf(TEXT("G%d"), g + 1);
-				ImGui::TableSetupColumn(TCHAR_TO_UTF8(*ColName), ImGuiTableColumnFlags_WidthFixed, groupWidth);
+				ImGui::TableSetupColumn(SpeakersMeterBank.GetColumnId(g), ImGuiTableColumnFlags_WidthFixed, SpeakersMeterBank.GetGroupWidth(g));
 			}
 			ImGui::TableNextRow();
 			for (int32 g = 0; g < numGroups; ++g)
 			{
 				ImGui::TableNextColumn();
-				if (g == numGroups - 1) { ImGui::Text("SUBS"); }
-				else { ImGui::Text("COL. %1.d", g + 1); }
+				ImGui::TextUnformatted(SpeakersMeterBank.GetHeader(g));
 			}
 
 			ImGui::TableNextRow();
-
-			ImDrawList* DrawList = ImGui::GetWindowDrawList();
 			for (int32 g = 0; g < numGroups; ++g)
 			{
 				ImGui::TableNextColumn();
-				const ImVec2 cellPos = ImGui::GetCursorScreenPos();
-				float x = cellPos.x + GroupPadding;
-				float y = cellPos.y;
-				const int32 start = g * 3;
-				const int32 count = FMath::Min(3, totalPorts - start);
-				
-				for (int32 i = 0; i < count; ++i)
-				{
-					const int32 unrealIdx1 = UnrealInputsFromSc[start + i];
-					const int32 ch = unrealIdx1 - 1;
-					if (AudioManager->SmoothedRmsLevels.IsValidIndex(ch) && AudioManager->PeakLevels.IsValidIndex(ch))
-					{
-						DrawSingleMeter(DrawList, ImVec2(x, y), meterHeight, AudioManager->SmoothedRmsLevels[ch], AudioManager->PeakLevels[ch]);
-					}
-					x += MeterWidth + MeterSpacing;
-				}
-				// Space for meters area
-				ImGui::Dummy(ImVec2(GroupPadding * 2.0f + count * MeterWidth + (count - 1) * MeterSpacing, meterHeight));
+				SpeakersMeterBank.MeterCell(g, meterHeight);
 			}
+			SpeakersMeterBank.DrawMeters(ImGui::GetWindowDrawList(), AudioManager->SmoothedRmsLevels, AudioManager->PeakLevels, meterHeight);
+
 			ImGui::TableNextRow();
 			for (int32 g = 0; g < numGroups; ++g)
 			{
 				ImGui::TableNextColumn();
-				const int32 start = g * 3;
-				const int32 count = FMath::Min(3, totalPorts - start);
-				
-				for (int32 i = 0; i < count; ++i)
+				SpeakersMeterBank.LabelCell(g);
+			}
+			if (bHaveLoudness)
+			{
+				ImGui::TableNextRow();
+				for (int32 g = 0; g < numGroups; ++g)
 				{
-					const int32 unrealIdx1 = UnrealInputsFromSc[start + i];
-					const int32 ch = unrealIdx1;
-					ImGui::Text("%.2d",ch);ImGui::SameLine(0,4);
+					ImGui::TableNextColumn();
+					if (AudioManager->GroupLoudness.IsValidIndex(g))
+					{
+						const FAkMLoudness& Loudness = AudioManager->GroupLoudness[g];
+						ImGui::TextDisabled("M%s", TCHAR_TO_UTF8(*FormatLufs(Loudness.MomentaryLufs)));
+						ImGui::TextDisabled("S%s", TCHAR_TO_UTF8(*FormatLufs(Loudness.ShortTermLufs)));
+					}
 				}
 			}
 
@@ -722,90 +1159,65 @@ void AImGuiActor::RenderAudioMonitoringWindow() const
 		ImGui::BeginChild("SourcesInputChild", ImVec2(0, sectionHeight), true, ImGuiWindowFlags_HorizontalScrollbar);
 		ImGui::SetWindowFontScale(1.0f);
 
-		// Prepare groups (max 4 meters per group) ordered by client name
-		TArray<FString> ClientNames;
-		SpatServerManager->ConnectedUnrealInputIndicesByClient.GetKeys(ClientNames);
-		ClientNames.Sort();
-
-		struct FGroup { FString Name; TArray<int32> Indices; TArray<int32> Labels; };
-		TArray<FGroup> Groups; Groups.Reserve(16);
-		for (const FString& Client : ClientNames)
+		// Groups of at most 4 meters, ordered by client name, labelled with the client's port numbers
+		int32 NumSourceInputs = 0;
+		for (const TPair<FString, TArray<int32>>& Pair : SpatServerManager->ConnectedUnrealInputIndicesByClient)
+		{
+			NumSourceInputs += Pair.Value.Num();
+		}
+		if (!SourcesMeterBank.IsLayoutValid(RoutingGeneration, NumSourceInputs))
 		{
-			const TArray<int32>* UnrealInputsPtr = SpatServerManager->ConnectedUnrealInputIndicesByClient.Find(Client);
-			if (!UnrealInputsPtr) { continue; }
-			const TArray<int32>& UnrealInputs = *UnrealInputsPtr;
-			for (int32 start = 0; start < UnrealInputs.Num(); start += 4)
+			SourcesMeterBank.ResetLayout(RoutingGeneration, NumSourceInputs);
+			TArray<FString> ClientNames;
+			SpatServerManager->ConnectedUnrealInputIndicesByClient.GetKeys(ClientNames);
+			ClientNames.Sort();
+			TArray<int32> Labels;
+			for (const FString& Client : ClientNames)
 			{
-				FGroup G;
-				const int32 count = FMath::Min(4, UnrealInputs.Num() - start);
-				G.Indices.Reserve(count);
-				G.Labels.Reserve(count);
-
-				for (int32 i = 0; i < count; ++i)
+				const TArray<int32>& UnrealInputs = SpatServerManager->ConnectedUnrealInputIndicesByClient.FindChecked(Client);
+				for (int32 start = 0; start < UnrealInputs.Num(); start += 4)
 				{
-					G.Indices.Add(UnrealInputs[start + i]);
-					G.Labels.Add(start + i + 1);
+					const int32 count = FMath::Min(4, UnrealInputs.Num() - start);
+					Labels.Reset();
+					for (int32 i = 0; i < count; ++i)
+					{
+						Labels.Add(start + i + 1);
+					}
+					SourcesMeterBank.AddGroup(Client, MakeArrayView(UnrealInputs).Slice(start, count), Labels);
 				}
-				G.Name = FString::Printf(TEXT("%s"), *Client);
-				Groups.Add(MoveTemp(G));
 			}
 		}
-		
-		const float meterHeight = 80.0f;
+		const int32 numGroups = SourcesMeterBank.GetNumGroups();
 
 		ImGui::Text("AUDIO SOURCES INPUTS");
 
 		ImGuiTableFlags TableFlags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_ScrollX;
-		const int32 tableCols = 1 + Groups.Num();
-		if (ImGui::BeginTable("SourcesTable", tableCols, TableFlags, ImVec2(0, 0)))
+		if (numGroups > 0 && ImGui::BeginTable("SourcesTable", numGroups, TableFlags, ImVec2(0, 0)))
 		{
-			for (int32 g = 0; g < Groups.Num(); ++g)
+			for (int32 g = 0; g < numGroups; ++g)
 			{
-				const int32 count = Groups[g].Indices.Num();
-				const float groupWidth = count * MeterWidth + (count - 1) * MeterSpacing + GroupPadding * 2.0f;
-				FString ColName = FString::Printf(TEXT("C%d"), g + 1);
-				ImGui::TableSetupColumn(TCHAR_TO_UTF8(*ColName), ImGuiTableColumnFlags_WidthFixed, groupWidth);
+				ImGui::TableSetupColumn(SourcesMeterBank.GetColumnId(g), ImGuiTableColumnFlags_WidthFixed, SourcesMeterBank.GetGroupWidth(g));
 			}
 			ImGui::TableNextRow();
-			for (int32 g = 0; g < Groups.Num(); ++g)
+			for (int32 g = 0; g < numGroups; ++g)
 			{
 				ImGui::TableNextColumn();
-				ImGui::Text(TCHAR_TO_UTF8(*Groups[g].Name));
+				ImGui::TextUnformatted(SourcesMeterBank.GetHeader(g));
 			}
-			ImGui::TableNextRow();
 
-			ImDrawList* DrawList = ImGui::GetWindowDrawList();
-			for (int32 g = 0; g < Groups.Num(); ++g)
+			ImGui::TableNextRow();
+			for (int32 g = 0; g < numGroups; ++g)
 			{
 				ImGui::TableNextColumn();
-				const ImVec2 cellPos = ImGui::GetCursorScreenPos();
-				float x = cellPos.x + GroupPadding;
-				float y = cellPos.y;
-				const TArray<int32>& Indices = Groups[g].Indices;
-				for (int32 i = 0; i < Indices.Num(); ++i)
-				{
-					const int32 ch = Indices[i] - 1;
-					if (AudioManager->SmoothedRmsLevels.IsValidIndex(ch) && AudioManager->PeakLevels.IsValidIndex(ch))
-					{
-						DrawSingleMeter(DrawList, ImVec2(x, y), meterHeight, AudioManager->SmoothedRmsLevels[ch], AudioManager->PeakLevels[ch]);
-					}
-					x += MeterWidth + MeterSpacing;
-				}
-				// Space for meters
-				ImGui::Dummy(ImVec2(GroupPadding * 2.0f + Indices.Num() * MeterWidth + (Indices.Num() - 1) * MeterSpacing, meterHeight));
+				SourcesMeterBank.MeterCell(g, meterHeight);
 			}
-			
+			SourcesMeterBank.DrawMeters(ImGui::GetWindowDrawList(), AudioManager->SmoothedRmsLevels, AudioManager->PeakLevels, meterHeight);
+
 			ImGui::TableNextRow();
-			
-			for (int32 g = 0; g < Groups.Num(); ++g)
+			for (int32 g = 0; g < numGroups; ++g)
 			{
 				ImGui::TableNextColumn();
-				const TArray<int32>& Labels = Groups[g].Labels;
-				for (int32 i = 0; i < Labels.Num(); ++i)
-				{
-					const int32 ch = Labels[i];
-					ImGui::Text("%.2d",ch);ImGui::SameLine(0,4);
-				}
+				SourcesMeterBank.LabelCell(g);
 			}
 
 			ImGui::EndTable();
@@ -847,6 +1259,137 @@ void AImGuiActor::RenderInternalLogsWindow() const
     ImGui::EndChild();
 }
 
+void AImGuiActor::RenderSpectrumWindow() const
+{
+	if (AudioManager == nullptr)
+	{
+		return;
+	}
+
+	const FAkMSpectrumFrame& Spectrum = AudioManager->GetSpectrum();
+
+	// Unreal inputs shown per slot, 1-based; 0 turns the slot off
+	ImGui::PushItemWidth(70);
+	for (int32 Slot = 0; Slot < FAkMSpectrumAnalyzer::MaxSlots; ++Slot)
+	{
+		int Input = AudioManager->SpectrumChannels[Slot] + 1;
+		ImGui::PushID(Slot);
+		if (ImGui::InputInt("##Input", &Input))
+		{
+			AudioManager->SpectrumChannels[Slot] = FMath::Clamp(Input, 0, FAkMAudioTap::MaxChannels) - 1;
+		}
+		ImGui::PopID();
+		ImGui::SameLine();
+	}
+	ImGui::PopItemWidth();
+	ImGui::TextDisabled("inputs");
+
+	ImGui::PushItemWidth(90);
+	if (ImGui::BeginCombo("FFT", TCHAR_TO_UTF8(*FString::FromInt(AudioManager->SpectrumFFTSize))))
+	{
+		for (int32 Size = FAkMSpectrumAnalyzer::MinFFTSize; Size <= FAkMSpectrumAnalyzer::MaxFFTSize; Size *= 2)
+		{
+			if (ImGui::Selectable(TCHAR_TO_UTF8(*FString::FromInt(Size)), Size == AudioManager->SpectrumFFTSize))
+			{
+				AudioManager->SpectrumFFTSize = Size;
+			}
+		}
+		ImGui::EndCombo();
+	}
+	ImGui::SameLine();
+	ImGui::SliderFloat("CPU budget", &AudioManager->SpectrumCpuBudgetPercent, 0.5f, 25.0f, "%.1f %%");
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	ImGui::Text("used %.1f %% | skipped %lld | overflows %lld", Spectrum.CpuPercent, Spectrum.NumSkipped, Spectrum.NumOverflows);
+
+	if (ImPlot::BeginPlot("##Spectrum", ImVec2(-1, -1), ImPlotFlags_NoMenus))
+	{
+		ImPlot::SetupAxes("Hz", "dBFS");
+		ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Log10);
+		ImPlot::SetupAxisLimits(ImAxis_X1, FAkMSpectrumAnalyzer::MinFrequencyHz, FMath::Max(Spectrum.SampleRate * 0.5, 1000.0), ImPlotCond_Always);
+		ImPlot::SetupAxisLimits(ImAxis_Y1, -120.0, 0.0, ImPlotCond_Once);
+		for (int32 Slot = 0; Slot < FAkMSpectrumAnalyzer::MaxSlots; ++Slot)
+		{
+			if (Spectrum.Channels[Slot] != INDEX_NONE && Spectrum.NumBins > 0)
+			{
+				const FString Label = FString::Printf(TEXT("In %d"), Spectrum.Channels[Slot] + 1);
+				ImPlot::PlotLine(TCHAR_TO_UTF8(*Label), Spectrum.FrequenciesHz.GetData(), Spectrum.MagnitudesDb.GetData() + Slot * Spectrum.NumBins, Spectrum.NumBins);
+			}
+		}
+		if (SpatServerManager)
+		{
+			// Crossover points of the server's satellite and sub filters
+			const double Crossovers[] = { SpatServerManager->satsFilterFrequency, SpatServerManager->subsFilterFrequency };
+			ImPlot::PlotInfLines("Crossovers", Crossovers, UE_ARRAY_COUNT(Crossovers));
+		}
+		ImPlot::EndPlot();
+	}
+}
+
+void AImGuiActor::RenderLevelHistoryWindow() const
+{
+	if (AudioManager == nullptr)
+	{
+		return;
+	}
+
+	const FAkMLevelHistory& History = AudioManager->LevelHistory;
+	if (History.GetNumChannels() == 0)
+	{
+		ImGui::TextDisabled("No history: levels are not computed per audio block");
+		return;
+	}
+
+	int Input = HistoryChannel + 1;
+	ImGui::PushItemWidth(70);
+	if (ImGui::InputInt("Input", &Input))
+	{
+		HistoryChannel = FMath::Clamp(Input, 1, History.GetNumChannels()) - 1;
+	}
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	bool bFrozen = HistoryFrozenTime >= 0.0;
+	if (ImGui::Checkbox("Freeze", &bFrozen))
+	{
+		HistoryFrozenTime = bFrozen ? FPlatformTime::Seconds() : -1.0;
+	}
+	ImGui::SameLine();
+	ImGui::Text("%.0f of %.0f s held, %.1f MB", History.GetDurationSeconds(), History.GetSpanSeconds(), History.GetAllocatedSize() / (1024.0 * 1024.0));
+	if (const uint64 NumDrops = FAkMAudioTap::Get().GetNumHistoryDrops())
+	{
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "%llu blocks dropped", NumDrops);
+	}
+
+	// Times are relative to the newest block; a frozen view keeps its times by shifting the query instead
+	const double Offset = bFrozen ? FPlatformTime::Seconds() - HistoryFrozenTime : 0.0;
+	if (ImPlot::BeginPlot("##LevelHistory", ImVec2(-1, -1), ImPlotFlags_NoMenus))
+	{
+		ImPlot::SetupAxes("s", "dBFS");
+		ImPlot::SetupAxisLimits(ImAxis_X1, -60.0, 0.0, ImPlotCond_Once);
+		ImPlot::SetupAxisLimits(ImAxis_Y1, FAkMLevelRange::FloorDb, 6.0, ImPlotCond_Once);
+		ImPlot::SetupFinish();
+
+		// One point per horizontal pixel, whatever the zoom
+		const ImPlotRect Limits = ImPlot::GetPlotLimits();
+		const int32 NumPoints = FMath::Max(1, int32(ImPlot::GetPlotSize().x));
+		HistorySeconds.SetNumUninitialized(NumPoints, EAllowShrinking::No);
+		HistoryMinDb.SetNumUninitialized(NumPoints, EAllowShrinking::No);
+		HistoryMaxDb.SetNumUninitialized(NumPoints, EAllowShrinking::No);
+		const int32 NumValid = History.Query(HistoryChannel, Limits.X.Min - Offset, Limits.X.Max - Offset, NumPoints, HistorySeconds.GetData(), HistoryMinDb.GetData(), HistoryMaxDb.GetData());
+		for (int32 i = 0; i < NumValid; ++i)
+		{
+			HistorySeconds[i] += float(Offset);
+		}
+
+		ImPlot::PlotShaded("RMS..peak", HistorySeconds.GetData(), HistoryMinDb.GetData(), HistoryMaxDb.GetData(), NumValid);
+		ImPlot::PlotLine("Peak", HistorySeconds.GetData(), HistoryMaxDb.GetData(), NumValid);
+		const double FullScale = 0.0;
+		ImPlot::PlotInfLines("0 dBFS", &FullScale, 1, ImPlotInfLinesFlags_Horizontal);
+		ImPlot::EndPlot();
+	}
+}
+
 void AImGuiActor::RenderGeneralServerParametersWindow() const
 {
 
@@ -946,7 +1489,89 @@ void AImGuiActor::RenderSpeakersParametersWindow() const
 	ImGui::NewLine();
 
 	ImVec2 AvailableSize = ImGui::GetContentRegionAvail();
-	ImGui::BeginChild("SpeakersGain", ImVec2(AvailableSize.x, 300));
+	ImGui::BeginChild("SpeakersGain", ImVec2(AvailableSize.x, 360));
+
+	// Calibration generator; the speaker is picked with the buttons under the gain sliders
+	ImGui::Text("Calibration");
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(120.0f);
+	if (ImGui::BeginCombo("##CalibrationSignal", TCHAR_TO_UTF8(FAkMSignalGenerator::GetSignalName(SpatServerManager->CalibrationSignal))))
+	{
+		for (uint8 s = 0; s < uint8(EAkMTestSignal::Num); ++s)
+		{
+			const EAkMTestSignal Signal = EAkMTestSignal(s);
+			if (ImGui::Selectable(TCHAR_TO_UTF8(FAkMSignalGenerator::GetSignalName(Signal)), Signal == SpatServerManager->CalibrationSignal))
+			{
+				SpatServerManager->CalibrationSignal = Signal;
+			}
+		}
+		ImGui::EndCombo();
+	}
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(120.0f);
+	ImGui::SliderFloat("##CalibrationLevel", &SpatServerManager->CalibrationLevelDb, -60.0f, 0.0f, "%.0f dBFS");
+	if (SpatServerManager->CalibrationSignal == EAkMTestSignal::Sweep)
+	{
+		FAkMSweepSettings& Sweep = SpatServerManager->CalibrationSweep;
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(140.0f);
+		ImGui::DragFloatRange2("Hz##Sweep", &Sweep.StartHz, &Sweep.EndHz, 10.0f, 10.0f, 24000.0f, "%.0f", "%.0f");
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(60.0f);
+		ImGui::DragFloat("s##SweepSeconds", &Sweep.Seconds, 0.1f, 0.5f, 60.0f, "%.1f");
+	}
+	ImGui::SameLine();
+	if (SpatServerManager->IsSpeakerAlignmentRunning())
+	{
+		if (ImGui::Button("Cancel alignment"))
+		{
+			SpatServerManager->CancelSpeakerAlignment();
+		}
+		ImGui::SameLine();
+		const int32 Measuring = SpatServerManager->GetAlignmentSpeaker();
+		if (Measuring != INDEX_NONE)
+		{
+			ImGui::Text("Sweeping speaker %d / %d", Measuring + 1, SpatServerManager->CalibrationSpeakerPorts.Num());
+		}
+		else
+		{
+			ImGui::TextUnformatted("Deconvolving...");
+		}
+	}
+	else
+	{
+		ImGui::BeginDisabled(SpatServerManager->CalibrationSignal != EAkMTestSignal::Off);
+		if (ImGui::Button("Align speakers"))
+		{
+			SpatServerManager->StartSpeakerAlignment();
+		}
+		ImGui::EndDisabled();
+		if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+		{
+			ImGui::SetTooltip("Sweeps every speaker into %s and sets the delays and gains", TCHAR_TO_UTF8(*SpatServerManager->CalibrationMicPort));
+		}
+	}
+	const int32 WiredSpeaker = SpatServerManager->GetWiredCalibrationSpeaker();
+	auto CalibrationButton = [this, WiredSpeaker](int32 Speaker)
+	{
+		const bool bSelected = SpatServerManager->CalibrationSpeaker == Speaker;
+		if (Speaker == WiredSpeaker && SpatServerManager->CalibrationSignal != EAkMTestSignal::Off)
+		{
+			ImGui::PushStyleColor(ImGuiCol_CheckMark, ImVec4(1.0f, 0.6f, 0.0f, 1.0f));
+			ImGui::RadioButton("##cal", true);
+			ImGui::PopStyleColor();
+		}
+		else
+		{
+			ImGui::RadioButton("##cal", bSelected);
+		}
+		if (ImGui::IsItemClicked())
+		{
+			SpatServerManager->CalibrationSpeaker = bSelected ? INDEX_NONE : Speaker;
+		}
+	};
+	ImGui::Separator();
+
 	ImGui::Text("Satellites Gain");
 	ImGui::PushStyleVar(ImGuiStyleVar_GrabMinSize, 20);
 	ImVec2 sliderSize = ImVec2(20, 90);
@@ -962,6 +1587,11 @@ void AImGuiActor::RenderSpeakersParametersWindow() const
 			const FString address = "/sat" + FString::FromInt(i + 1) + "/gain";
 			SpatServerManager->SendOSCFloat(address, SpatServerManager->satsGains[i]);
 		};
+		CalibrationButton(i);
+		if (SpatServerManager->satsDelaysMs.IsValidIndex(i) && SpatServerManager->satsDelaysMs[i] > 0.0f)
+		{
+			ImGui::TextDisabled("%.1f", SpatServerManager->satsDelaysMs[i]);
+		}
 		ImGui::EndGroup();
 		ImGui::PopID();
 	}
@@ -980,6 +1610,11 @@ void AImGuiActor::RenderSpeakersParametersWindow() const
 			const FString address = "/sub" + FString::FromInt(i + 1) + "/gain";
 			SpatServerManager->SendOSCFloat(address, SpatServerManager->subsGains[i]);
 		};
+		CalibrationButton(SpatServerManager->satsGains.Num() + i);
+		if (SpatServerManager->subsDelaysMs.IsValidIndex(i) && SpatServerManager->subsDelaysMs[i] > 0.0f)
+		{
+			ImGui::TextDisabled("%.1f", SpatServerManager->subsDelaysMs[i]);
+		}
 		ImGui::EndGroup();
 		ImGui::PopID();
 	}
@@ -991,8 +1626,8 @@ void AImGuiActor::RenderSpeakersParametersWindow() const
 }
 void AImGuiActor::OnNewJackClient(const FString& ClientName, int32 NumInputs, int32 NumOutputs)
 {
-	// Ignore scsynth (handled by manager) and our own Unreal client
-	if (ClientName.Equals(TEXT("scsynth"), ESearchCase::IgnoreCase))
+	// Ignore scsynth instances (handled by manager) and our own Unreal client
+	if (ClientName.Equals(TEXT("scsynth"), ESearchCase::IgnoreCase) || (SpatServerManager && SpatServerManager->IsServerJackClient(ClientName)))
 	{
 		return;
 	}
@@ -1001,6 +1636,12 @@ void AImGuiActor::OnNewJackClient(const FString& ClientName, int32 NumInputs, in
 	{
 		return;
 	}
+	// Clients known to the patchbay profile are wired by the manager without asking; if their rule cannot be applied
+	// the manager hands them back through OnPatchbayRuleNotApplied
+	if (SpatServerManager && SpatServerManager->FindPatchbayRule(ClientName))
+	{
+		return;
+	}
 	UUEJackAudioLinkSubsystem* Subsystem = (GEngine ? GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>() : nullptr);
 	if (Subsystem)
 	{
@@ -1011,6 +1652,20 @@ void AImGuiActor::OnNewJackClient(const FString& ClientName, int32 NumInputs, in
 		}
 	}
 
+	QueueClientPrompt(ClientName, NumInputs, NumOutputs);
+}
+
+void AImGuiActor::OnPatchbayRuleNotApplied(FString ClientName, int32 NumInputs, int32 NumOutputs)
+{
+	QueueClientPrompt(ClientName, NumInputs, NumOutputs);
+}
+
+void AImGuiActor::QueueClientPrompt(const FString& ClientName, int32 NumInputs, int32 NumOutputs)
+{
+	if (PendingClientPrompts.ContainsByPredicate([&ClientName](const FPendingClientPrompt& Prompt) { return Prompt.ClientName.Equals(ClientName, ESearchCase::IgnoreCase); }))
+	{
+		return;
+	}
 	FPendingClientPrompt P; P.ClientName = ClientName; P.NumInputs = NumInputs; P.NumOutputs = NumOutputs;
 	PendingClientPrompts.Add(MoveTemp(P));
 	bImGuiOpenNextPopup = true;
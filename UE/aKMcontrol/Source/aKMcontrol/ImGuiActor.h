@@ -8,6 +8,7 @@
 #include "akMSpatServerManager.h"
 #include "akMControlAudioManager.h"
 #include "akMInternalLogCapture.h"
+#include "akMMeterBank.h"
 
 #include "ImGuiActor.generated.h"
 
@@ -66,6 +67,8 @@ private:
 	void RenderBottomBar(float DeltaTime) const;
 	void RenderAudioMonitoringWindow() const;
 	void RenderInternalLogsWindow() const;
+	void RenderSpectrumWindow() const;
+	void RenderLevelHistoryWindow() const;
 	void RenderGeneralServerParametersWindow() const;
 	void RenderSpeakersParametersWindow() const;
 
@@ -87,10 +90,43 @@ private:
 	UFUNCTION()
 	void OnJackClientDisconnected(const FString& ClientName);
 
+	// A client the patchbay skipped over (its rule could not be applied) is prompted like any other
+	UFUNCTION()
+	void OnPatchbayRuleNotApplied(FString ClientName, int32 NumInputs, int32 NumOutputs);
+
+	void QueueClientPrompt(const FString& ClientName, int32 NumInputs, int32 NumOutputs);
+
 	// Helper to draw popup
 	void DrawNewClientPopup();
 
 	int BottomBarHeight = 20;
+
+	// Server console error navigation (index into ServerOutputStats.ErrorLineNumbers, console line to scroll to)
+	mutable int32 ConsoleErrorCursor = INDEX_NONE;
+	mutable int64 ConsoleScrollToLine = -1;
+
+	// Per-frame copies of the process sampler history (reused storage)
+	mutable TArray<FAkMProcessSample> SclangProcessSamples;
+	mutable TArray<FAkMProcessSample> ScsynthProcessSamples;
+
+	// Level meters of the speakers and sources sections, laid out once per routing change
+	mutable FAkMMeterBank SpeakersMeterBank;
+	mutable FAkMMeterBank SourcesMeterBank;
+
+	// Recorder: also record the client sources next to the speaker feeds
+	mutable bool bRecordSources = false;
+
+	// File player: path, sources per file channel ("1, 2, 5") and looping
+	mutable char FilePlayerPath[1024] = {};
+	mutable char FilePlayerSources[256] = "1, 2";
+	mutable bool bFilePlayerLoop = true;
+
+	// Level history timeline: input shown (0-based), wall time the view was frozen at (< 0 = live), query storage
+	mutable int32 HistoryChannel = 0;
+	mutable double HistoryFrozenTime = -1.0;
+	mutable TArray<float> HistorySeconds;
+	mutable TArray<float> HistoryMinDb;
+	mutable TArray<float> HistoryMaxDb;
 	
 	// Internal logs capture device
 	TUniquePtr<FAkMInternalLogCapture> InternalLogCapture;
@@ -146,7 +146,7 @@ void ASource::SetPosition(const FVector& InPosition)
 {
 	Position = InPosition;
 	SetActorLocation(Position);
-	SendParamsToServer();
+	UpdateServerParams();
 }
 
 void ASource::SetRadius(float InRadius)
@@ -154,7 +154,7 @@ void ASource::SetRadius(float InRadius)
 	Radius = FMath::Max(1.0f, InRadius);
 	InnerMeshRadius = FMath::Min(10.0f,InRadius * 0.2f);
 	RefreshVisual();
-	SendParamsToServer();
+	UpdateServerParams();
 }
 
 void ASource::SetColor(const FColor& InColor)
@@ -172,24 +172,35 @@ void ASource::SetGain(float InGain)
 void ASource::SetA(int InA)
 {
 	A = InA;
-	SendParamsToServer();
+	UpdateServerParams();
 }
 
 void ASource::SetDelayMultiplier(float InDelayMultiplier)
 {
 	DelayMultiplier = FMath::Clamp(InDelayMultiplier, 0.0f, 100.0f);
-	SendParamsToServer();
+	UpdateServerParams();
 }
 
 void ASource::SetReverb(float InReverb)
 {
 	Reverb = FMath::Clamp(InReverb, 0.0f, 1.0f);
-	SendParamsToServer();
+	UpdateServerParams();
 }
 
 
 
 
+void ASource::SetLevel(float InLevel)
+{
+	// Steps below one 8-bit emissive step would only dirty the render state
+	if (FMath::Abs(InLevel - VisualLevel) < 1.0f / 256.0f || !SourceOuterMesh)
+	{
+		return;
+	}
+	VisualLevel = InLevel;
+	SourceOuterMesh->SetCustomPrimitiveDataFloat(LevelPrimitiveDataIndex, InLevel);
+}
+
 void ASource::RefreshVisual()
 {
 	if (SourceOuterMesh)
@@ -288,6 +299,8 @@ void ASource::SendParamsToServer() const
 	{
 		return;
 	}
+	bParamsPending = false;
+	LastParamsSendSeconds = FPlatformTime::Seconds();
 	const FString address = FString::Printf(TEXT("/source%d/params"), ID);
 	const TArray<float> values = {
 		float(Position.X * 0.01f),
@@ -301,3 +314,33 @@ void ASource::SendParamsToServer() const
 	SpatServerManager->SendOSCFloatArray(address, values);
 }
 
+void ASource::UpdateServerParams()
+{
+	if (!bSignalActive && Active)
+	{
+		bParamsPending = true;
+		return;
+	}
+	SendParamsToServer();
+}
+
+void ASource::SetSignalActive(bool bInSignalActive)
+{
+	if (bInSignalActive == bSignalActive)
+	{
+		return;
+	}
+	bSignalActive = bInSignalActive;
+	if (bSignalActive && bParamsPending)
+	{
+		SendParamsToServer();
+	}
+}
+
+void ASource::FlushPendingParams(double MinIntervalSeconds)
+{
+	if (bParamsPending && FPlatformTime::Seconds() - LastParamsSendSeconds >= MinIntervalSeconds)
+	{
+		SendParamsToServer();
+	}
+}
@@ -5,6 +5,9 @@
 #include "Engine/World.h"
 #include "UObject/ConstructorHelpers.h"
 #include "akMSpatServerManager.h"
+#include "akMAudioTap.h"
+#include "akMControlAudioManager.h"
+#include "Kismet/GameplayStatics.h"
 
 // Sets default values
 ASourcesManager::ASourcesManager()
@@ -19,10 +22,23 @@ void ASourcesManager::BeginPlay()
 {
 	Super::BeginPlay();
 	InitializeSources();
+
+	if (SpatServerManager)
+	{
+		SpatServerManager->OnServerStateResyncRequested.AddDynamic(this, &ASourcesManager::ResendAllSourceParams);
+	}
+	if (!AudioManager)
+	{
+		AudioManager = Cast<AakMControlAudioManager>(UGameplayStatics::GetActorOfClass(this, AakMControlAudioManager::StaticClass()));
+	}
 }
 
 void ASourcesManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	if (SpatServerManager)
+	{
+		SpatServerManager->OnServerStateResyncRequested.RemoveDynamic(this, &ASourcesManager::ResendAllSourceParams);
+	}
 	DespawnAllSources();
 	Super::EndPlay(EndPlayReason);
 }
@@ -92,6 +108,17 @@ int32 ASourcesManager::GetNumActive() const
 	return Count;
 }
 
+void ASourcesManager::ResendAllSourceParams()
+{
+	for (ASource* Src : Sources)
+	{
+		if (IsValid(Src) && Src->Active)
+		{
+			Src->SendParamsToServer();
+		}
+	}
+}
+
 ASource* ASourcesManager::ActivateNextInactiveSource()
 {
 	for (ASource* Src : Sources)
@@ -125,6 +152,57 @@ bool ASourcesManager::DeactivateSourceByID(int32 ID)
 void ASourcesManager::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+	if (SpatServerManager)
+	{
+		SpatServerManager->GetUnrealInputsBySource(SourceInputs, Sources.Num());
+	}
+	else
+	{
+		SourceInputs.Init(INDEX_NONE, Sources.Num());
+	}
+	UpdateSourceLevels();
+	UpdateSourceActivity();
+}
 
+void ASourcesManager::UpdateSourceLevels()
+{
+	// Each change is one custom primitive data write; the renderer picks them all up in its end-of-frame update,
+	// without a material instance per source being touched
+	const TArray<float>* Levels = bAudioReactiveVisuals && AudioManager ? &AudioManager->SmoothedRmsLevels : nullptr;
+	const float FloorDb = FMath::Min(VisualLevelFloorDb, -1.0f);
+	for (int32 i = 0; i < Sources.Num(); ++i)
+	{
+		ASource* Src = Sources[i];
+		if (!IsValid(Src) || !Src->Active)
+		{
+			continue;
+		}
+		float Fraction = 0.0f;
+		const int32 Channel = Levels ? SourceInputs[i] - 1 : INDEX_NONE;
+		if (Levels && Levels->IsValidIndex(Channel) && (*Levels)[Channel] > 0.0f)
+		{
+			const float Db = 20.0f * FMath::LogX(10.0f, (*Levels)[Channel]);
+			Fraction = FMath::Clamp(1.0f - Db / FloorDb, 0.0f, 1.0f);
+		}
+		Src->SetLevel(Fraction);
+	}
 }
 
+void ASourcesManager::UpdateSourceActivity()
+{
+	const FAkMActivityDetector& Activity = FAkMAudioTap::Get().GetActivityDetector();
+	for (int32 i = 0; i < Sources.Num(); ++i)
+	{
+		ASource* Src = Sources[i];
+		if (!IsValid(Src))
+		{
+			continue;
+		}
+		const int32 Channel = SourceInputs[i] - 1;
+		Src->SetSignalActive(!bGateSilentSources || Channel < 0 || Activity.IsActive(Channel));
+		if (!Src->IsSignalActive())
+		{
+			Src->FlushPendingParams(SilentSourceUpdateSeconds);
+		}
+	}
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMActivityDetector.h"
+
+FAkMActivityDetector::FAkMActivityDetector()
+{
+	States.SetNum(MaxChannels);
+	for (std::atomic<uint64>& Bits : ActiveBits)
+	{
+		Bits.store(0, std::memory_order_relaxed);
+	}
+}
+
+void FAkMActivityDetector::Process(const float* BlockSumSquares, int32 NumChannels, int32 NumFrames, int32 SampleRate)
+{
+	NumChannels = FMath::Min(NumChannels, MaxChannels);
+	const float Seconds = SampleRate > 0 ? float(NumFrames) / SampleRate : 0.0f;
+	if (Seconds <= 0.0f)
+	{
+		return;
+	}
+	if (Seconds != BlockSeconds)
+	{
+		BlockSeconds = Seconds;
+		AttackSmoothing = FMath::Exp(-Seconds / AttackSeconds);
+		ReleaseSmoothing = FMath::Exp(-Seconds / ReleaseSeconds);
+	}
+	static const float OpenLevel = FMath::Pow(10.0f, OpenDb / 20.0f);
+	static const float CloseLevel = FMath::Pow(10.0f, CloseDb / 20.0f);
+	const float InvFrames = 1.0f / NumFrames;
+
+	for (int32 Word = 0; Word * 64 < NumChannels; ++Word)
+	{
+		uint64 Bits = ActiveBits[Word].load(std::memory_order_relaxed);
+		const uint64 Previous = Bits;
+		for (int32 Channel = Word * 64; Channel < FMath::Min(NumChannels, (Word + 1) * 64); ++Channel)
+		{
+			FAkMActivityState& State = States[Channel];
+			const float Rms = FMath::Sqrt(BlockSumSquares[Channel] * InvFrames);
+			const float Smoothing = Rms > State.Envelope ? AttackSmoothing : ReleaseSmoothing;
+			State.Envelope = Rms + (State.Envelope - Rms) * Smoothing;
+
+			// Opens above OpenDb; closes once below CloseDb for HoldSeconds
+			if (State.Envelope >= OpenLevel)
+			{
+				State.bActive = true;
+				State.HoldSecondsLeft = HoldSeconds;
+			}
+			else if (State.bActive && State.Envelope < CloseLevel)
+			{
+				State.HoldSecondsLeft -= Seconds;
+				State.bActive = State.HoldSecondsLeft > 0.0f;
+			}
+			const uint64 Mask = uint64(1) << (Channel & 63);
+			Bits = State.bActive ? (Bits | Mask) : (Bits & ~Mask);
+		}
+		if (Bits != Previous)
+		{
+			ActiveBits[Word].store(Bits, std::memory_order_relaxed);
+		}
+	}
+	NumProcessedChannels.store(NumChannels, std::memory_order_relaxed);
+	LastProcessCycles.store(FPlatformTime::Cycles64(), std::memory_order_release);
+}
+
+bool FAkMActivityDetector::IsActive(int32 Channel) const
+{
+	const uint64 LastCycles = LastProcessCycles.load(std::memory_order_acquire);
+	if (LastCycles == 0 || FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - LastCycles) > StaleSeconds
+		|| Channel < 0 || Channel >= NumProcessedChannels.load(std::memory_order_relaxed))
+	{
+		return true;
+	}
+	return (ActiveBits[Channel / 64].load(std::memory_order_relaxed) >> (Channel & 63)) & 1;
+}
@@ -0,0 +1,163 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMAudioTap.h"
+#include "akMLevelKernel.h"
+
+FAkMAudioTap& FAkMAudioTap::Get()
+{
+	static FAkMAudioTap Tap;
+	return Tap;
+}
+
+FAkMAudioTap::FAkMAudioTap()
+{
+	BlockSumSquares.SetNumZeroed(MaxChannels);
+	BlockPeaks.SetNumZeroed(MaxChannels);
+	BlockClips.SetNumZeroed(MaxChannels);
+	SumSquares.SetNumZeroed(MaxChannels);
+	Peaks.SetNumZeroed(MaxChannels);
+	ClipCounts.SetNumZeroed(MaxChannels);
+	MeterStates.SetNum(MaxChannels);
+	BlockRanges.SetNum(MaxChannels);
+	Levels.ForEachBuffer([](FAkMLevelMeterFrame& Frame)
+	{
+		Frame.Channels.SetNum(MaxChannels);
+		Frame.GroupLoudness.SetNum(FAkMLoudnessMeter::MaxGroups);
+	});
+}
+
+void FAkMAudioTap::JackProcessHook(void* UserData, const float* const* Inputs, int32 NumInputs, float* const* Outputs, int32 NumOutputs, int32 NumFrames, int32 SampleRate)
+{
+	FAkMAudioTap* Tap = static_cast<FAkMAudioTap*>(UserData);
+	if (!Tap)
+	{
+		return;
+	}
+	Tap->ProcessBlock(Inputs, NumInputs, NumFrames, SampleRate);
+	Tap->RenderOutputBlock(Outputs, NumOutputs, NumFrames, SampleRate);
+}
+
+void FAkMAudioTap::ProcessBlock(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, int32 SampleRate)
+{
+	NumChannels = FMath::Min(NumChannels, MaxChannels);
+	if (!ChannelData || NumChannels <= 0 || NumFrames <= 0)
+	{
+		return;
+	}
+	FAkMLevelKernel::AnalyzePlanar(ChannelData, NumChannels, NumFrames, ClipThreshold, BlockSumSquares.GetData(), BlockPeaks.GetData(), BlockClips.GetData());
+	Loudness.ProcessPlanar(ChannelData, NumChannels, NumFrames, SampleRate);
+	Spectrum.PushPlanar(ChannelData, NumChannels, NumFrames, SampleRate);
+	LatencyProbe.CapturePlanar(ChannelData, NumChannels, NumFrames, InputFrames);
+	SweepMeasurement.CapturePlanar(ChannelData, NumChannels, NumFrames, InputFrames);
+	Recorder.PushPlanar(ChannelData, NumChannels, NumFrames, SampleRate);
+	InputFrames += NumFrames;
+	AccumulateAndPublish(NumChannels, NumFrames, SampleRate);
+}
+
+void FAkMAudioTap::ProcessInterleavedBlock(const float* Samples, int32 NumChannels, int32 NumFrames, int32 SampleRate)
+{
+	if (!Samples || NumChannels <= 0 || NumChannels > MaxChannels || NumFrames <= 0)
+	{
+		return;
+	}
+	FAkMLevelKernel::AnalyzeInterleaved(Samples, NumChannels, NumFrames, ClipThreshold, BlockSumSquares.GetData(), BlockPeaks.GetData(), BlockClips.GetData());
+	Loudness.ProcessInterleaved(Samples, NumChannels, NumFrames, SampleRate);
+	Spectrum.PushInterleaved(Samples, NumChannels, NumFrames, SampleRate);
+	LatencyProbe.CaptureInterleaved(Samples, NumChannels, NumFrames, InputFrames);
+	SweepMeasurement.CaptureInterleaved(Samples, NumChannels, NumFrames, InputFrames);
+	Recorder.PushInterleaved(Samples, NumChannels, NumFrames, SampleRate);
+	InputFrames += NumFrames;
+	AccumulateAndPublish(NumChannels, NumFrames, SampleRate);
+}
+
+void FAkMAudioTap::RenderOutputBlock(float* const* OutputData, int32 NumChannels, int32 NumFrames, int32 SampleRate)
+{
+	if (!OutputData || NumChannels <= 0 || NumFrames <= 0)
+	{
+		return;
+	}
+	StreamSampleRate.store(SampleRate, std::memory_order_relaxed);
+	FilePlayer.RenderOutput(OutputData, NumChannels, NumFrames);
+	SignalGenerator.Render(OutputData, NumChannels, NumFrames, SampleRate);
+	LatencyProbe.RenderOutput(OutputData, NumChannels, NumFrames, OutputFrames, SampleRate);
+	SweepMeasurement.RenderOutput(OutputData, NumChannels, NumFrames, OutputFrames);
+	OutputFrames += NumFrames;
+}
+
+void FAkMAudioTap::AccumulateAndPublish(int32 NumChannels, int32 NumFrames, int32 SampleRate)
+{
+	// Start over once the reader has the previous snapshot; otherwise merge this block into the one it has not seen.
+	// If the reader takes it in between, the next snapshot repeats a block, which only widens its window.
+	if (Levels.IsLastPublishConsumed())
+	{
+		FMemory::Memzero(SumSquares.GetData(), NumChannels * sizeof(double));
+		FMemory::Memzero(Peaks.GetData(), NumChannels * sizeof(float));
+		AccumulatedBlocks = 0;
+		AccumulatedFrames = 0;
+	}
+
+	const EAkMMeterBallistics Requested = RequestedBallistics.load(std::memory_order_relaxed);
+	const float BlockSeconds = SampleRate > 0 ? float(NumFrames) / SampleRate : 0.0f;
+	if (Requested != AppliedBallistics || BlockSeconds != StepCoefficients.Seconds)
+	{
+		AppliedBallistics = Requested;
+		Ballistics = FAkMMeterBallistics::FromPreset(Requested);
+		StepCoefficients = Ballistics.GetStepCoefficients(BlockSeconds);
+	}
+	const float InvBlockFrames = 1.0f / NumFrames;
+
+	for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+	{
+		Ballistics.Step(MeterStates[Channel], FMath::Sqrt(BlockSumSquares[Channel] * InvBlockFrames), BlockPeaks[Channel], StepCoefficients);
+		SumSquares[Channel] += BlockSumSquares[Channel];
+		Peaks[Channel] = FMath::Max(Peaks[Channel], BlockPeaks[Channel]);
+		ClipCounts[Channel] += BlockClips[Channel];
+		BlockRanges[Channel] = { FAkMLevelRange::Encode(FMath::Sqrt(BlockSumSquares[Channel] * InvBlockFrames)), FAkMLevelRange::Encode(BlockPeaks[Channel]) };
+	}
+
+	Activity.Process(BlockSumSquares.GetData(), NumChannels, NumFrames, SampleRate);
+
+	// Ranges first, so the reader never sees a block header before its data
+	if (HistoryBlocks.NumFree() > 0 && HistoryRanges.NumFree() >= NumChannels)
+	{
+		const FAkMHistoryBlock Block { NumChannels, NumFrames, SampleRate };
+		HistoryRanges.Write(BlockRanges.GetData(), NumChannels);
+		HistoryBlocks.Write(&Block, 1);
+	}
+	else
+	{
+		NumHistoryDrops.fetch_add(1, std::memory_order_relaxed);
+	}
+	++AccumulatedBlocks;
+	AccumulatedFrames += NumFrames;
+	++BlockCounter;
+
+	FAkMLevelMeterFrame& Frame = Levels.GetWriteBuffer();
+	const double InvFrames = 1.0 / AccumulatedFrames;
+	for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+	{
+		FAkMChannelLevel& Level = Frame.Channels[Channel];
+		Level.Rms = float(FMath::Sqrt(SumSquares[Channel] * InvFrames));
+		Level.Peak = Peaks[Channel];
+		Level.ClipCount = ClipCounts[Channel];
+		Level.Meter = MeterStates[Channel].Level;
+		Level.HoldPeak = MeterStates[Channel].HoldPeak;
+	}
+	Frame.NumChannels = NumChannels;
+	Frame.NumBlocks = AccumulatedBlocks;
+	Frame.NumFrames = AccumulatedFrames;
+	Frame.SampleRate = SampleRate;
+	Frame.BlockCounter = BlockCounter;
+	Frame.NumLoudnessGroups = Loudness.GetResults(Frame.GroupLoudness.GetData(), Frame.MasterLoudness);
+	Levels.Publish();
+}
+
+bool FAkMAudioTap::ReadHistoryBlock(FAkMHistoryBlock& OutBlock, FAkMLevelRange* OutRanges)
+{
+	if (HistoryBlocks.Read(&OutBlock, 1) == 0)
+	{
+		return false;
+	}
+	HistoryRanges.Read(OutRanges, OutBlock.NumChannels);
+	return true;
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMConsoleBuffer.h"
+
+FAkMConsoleBuffer::FAkMConsoleBuffer(int32 InMaxLines)
+	: MaxLines(FMath::Max(1, InMaxLines))
+{
+}
+
+void FAkMConsoleBuffer::AddLine(FStringView Line, uint8 Tag)
+{
+	// Pipe output on Windows keeps the CR of CRLF line endings
+	if (Line.EndsWith(TEXT('\r')))
+	{
+		Line.LeftChopInline(1);
+	}
+
+	int32 Slot;
+	if (Count < MaxLines)
+	{
+		Slot = (Head + Count) % MaxLines;
+		if (Slot >= Lines.Num())
+		{
+			Lines.AddDefaulted(Slot - Lines.Num() + 1);
+			Tags.SetNumZeroed(Lines.Num());
+		}
+		++Count;
+	}
+	else
+	{
+		// Full: overwrite the oldest slot, reusing its allocation
+		Slot = Head;
+		Head = (Head + 1) % MaxLines;
+	}
+
+	const FTCHARToUTF8 Converted(Line.GetData(), Line.Len());
+	TArray<ANSICHAR>& Storage = Lines[Slot];
+	Storage.SetNumUninitialized(Converted.Length(), EAllowShrinking::No);
+	if (Converted.Length() > 0)
+	{
+		FMemory::Memcpy(Storage.GetData(), Converted.Get(), Converted.Length());
+	}
+	Tags[Slot] = Tag;
+	++TotalLinesAdded;
+}
+
+void FAkMConsoleBuffer::Clear()
+{
+	for (TArray<ANSICHAR>& Storage : Lines)
+	{
+		Storage.Reset();
+	}
+	Head = 0;
+	Count = 0;
+}
+
+void FAkMConsoleBuffer::SetMaxLines(int32 InMaxLines)
+{
+	InMaxLines = FMath::Max(1, InMaxLines);
+	if (InMaxLines == MaxLines)
+	{
+		return;
+	}
+
+	// Re-linearize, keeping the newest lines that still fit
+	const int32 NumToKeep = FMath::Min(Count, InMaxLines);
+	TArray<TArray<ANSICHAR>> Kept;
+	TArray<uint8> KeptTags;
+	Kept.Reserve(NumToKeep);
+	KeptTags.Reserve(NumToKeep);
+	for (int32 i = Count - NumToKeep; i < Count; ++i)
+	{
+		const int32 Slot = (Head + i) % MaxLines;
+		Kept.Add(MoveTemp(Lines[Slot]));
+		KeptTags.Add(Tags[Slot]);
+	}
+	Lines = MoveTemp(Kept);
+	Tags = MoveTemp(KeptTags);
+	MaxLines = InMaxLines;
+	Head = 0;
+	Count = NumToKeep;
+}
+
+void FAkMConsoleBuffer::GetLine(int32 Index, const char*& OutBegin, const char*& OutEnd) const
+{
+	check(Index >= 0 && Index < Count);
+	const TArray<ANSICHAR>& Storage = Lines[(Head + Index) % MaxLines];
+	OutBegin = Storage.GetData();
+	OutEnd = OutBegin + Storage.Num();
+}
@@ -4,6 +4,7 @@
 #include "akMControlAudioManager.h"
 
 #include "Misc/LowLevelTestAdapter.h"
+#include "Misc/Paths.h"
 
 DEFINE_LOG_CATEGORY(LogAkMControl);
 
@@ -21,7 +22,53 @@ void AakMControlAudioManager::BeginPlay()
 	Super::BeginPlay();
 
 	JackAudioLinkSubsystem = GEngine ? GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>() : nullptr;
-	
+	JackGraphSubsystem = GEngine ? GEngine->GetEngineSubsystem<UakMJackGraphSubsystem>() : nullptr;
+
+	FAkMAudioTap::Get().GetSpectrumAnalyzer().Start();
+}
+
+void AakMControlAudioManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FAkMAudioTap::Get().GetSpectrumAnalyzer().StopAndWait();
+	StopRecording();
+	Super::EndPlay(EndPlayReason);
+}
+
+bool AakMControlAudioManager::StartRecording(const TArray<int32>& Inputs1Based)
+{
+	TArray<int32> Channels;
+	Channels.Reserve(Inputs1Based.Num());
+	for (const int32 Input : Inputs1Based)
+	{
+		Channels.Add(Input - 1);
+	}
+	// The rate of the blocks reaching the tap; none yet means there is nothing to record
+	const int32 SampleRate = FAkMAudioTap::Get().GetSampleRate();
+	if (SampleRate <= 0)
+	{
+		UE_LOG(LogAkMControl, Error, TEXT("Cannot record: no audio has reached the tap yet, so the sample rate is unknown"));
+		return false;
+	}
+	const FString FilePath = FPaths::ProjectSavedDir() / TEXT("akM/Recordings") / FString::Printf(TEXT("akM_%s.wav"), *FDateTime::Now().ToString());
+	if (!FAkMAudioTap::Get().GetRecorder().StartRecording(FilePath, Channels, SampleRate))
+	{
+		UE_LOG(LogAkMControl, Error, TEXT("Could not start recording %d channels to %s"), Channels.Num(), *FilePath);
+		return false;
+	}
+	UE_LOG(LogAkMControl, Log, TEXT("Recording %d channels to %s"), Channels.Num(), *FilePath);
+	return true;
+}
+
+void AakMControlAudioManager::StopRecording()
+{
+	FAkMRecorder& Recorder = FAkMAudioTap::Get().GetRecorder();
+	if (!Recorder.IsRecording())
+	{
+		return;
+	}
+	Recorder.StopRecording();
+	UE_LOG(LogAkMControl, Log, TEXT("Recorded %lld frames to %s (%llu xruns, %lld frames replaced by silence)"),
+		Recorder.GetFramesWritten(), *Recorder.GetFilePath(), Recorder.GetNumXruns(), Recorder.GetDroppedFrames());
 }
 
 // Called every frame
@@ -30,45 +77,93 @@ void AakMControlAudioManager::Tick(float DeltaTime)
 	Super::Tick(DeltaTime);
 
 	// --- Update Level Meter State ---
-	if (JackAudioLinkSubsystem != nullptr)
+	if (JackAudioLinkSubsystem != nullptr && JackGraphSubsystem != nullptr)
 	{
-		const FString UEJackClientName = JackAudioLinkSubsystem->GetJackClientName();
-		TArray<FString>	InputPorts;
-		TArray<FString>	OutputPorts;
-		JackAudioLinkSubsystem->GetClientPorts(UEJackClientName,InputPorts,OutputPorts);
-		const int32 NumChannels = InputPorts.Num();
+		// Levels and ballistics computed per audio block when the tap is fed; the game thread only reads them
+		FAkMAudioTap& AudioTap = FAkMAudioTap::Get();
+		AudioTap.SetBallistics(MeterBallistics);
+
+		FAkMSpectrumAnalyzer& Spectrum = AudioTap.GetSpectrumAnalyzer();
+		for (int32 Slot = 0; Slot < FAkMSpectrumAnalyzer::MaxSlots; ++Slot)
+		{
+			Spectrum.SetChannel(Slot, SpectrumChannels[Slot]);
+		}
+		Spectrum.SetFFTSize(SpectrumFFTSize);
+		Spectrum.SetCpuBudgetPercent(SpectrumCpuBudgetPercent);
+		Spectrum.ReadSpectrum();
+		const double Now = FPlatformTime::Seconds();
+		if (AudioTap.ReadLevels())
+		{
+			LastTapSnapshotTime = Now;
+		}
+		bUsingAudioThreadLevels = LastTapSnapshotTime >= 0.0 && Now - LastTapSnapshotTime < 0.5;
+
+		// Queued per-block ranges into the history; a new channel count or block size starts it over
+		HistoryBlockRanges.SetNum(FAkMAudioTap::MaxChannels, EAllowShrinking::No);
+		FAkMHistoryBlock HistoryBlock;
+		while (AudioTap.ReadHistoryBlock(HistoryBlock, HistoryBlockRanges.GetData()))
+		{
+			if (HistoryBlock.SampleRate > 0)
+			{
+				const int32 NumHistoryChannels = FMath::Clamp(LevelHistoryChannels, 0, HistoryBlock.NumChannels);
+				LevelHistory.Configure(NumHistoryChannels, double(HistoryBlock.NumFrames) / HistoryBlock.SampleRate, LevelHistoryMinutes * 60.0,
+					SIZE_T(FMath::Max(0.0f, LevelHistoryMaxMB) * 1024.0 * 1024.0));
+				LevelHistory.AddBlock(HistoryBlockRanges.GetData());
+			}
+		}
+		const FAkMLevelMeterFrame& TapLevels = AudioTap.LatestLevels();
+
+		// Channel count from the port registry: no JACK call and no allocation per frame
+		int32 NumChannels = 0;
+		int32 NumOutputs = 0;
+		JackGraphSubsystem->GetPortCounts(JackGraphSubsystem->GetUnrealClientName(), NumChannels, NumOutputs);
+		if (bUsingAudioThreadLevels)
+		{
+			NumChannels = TapLevels.NumChannels;
+		}
 
 		// Ensure our state arrays are the correct size
 		if (SmoothedRmsLevels.Num() != NumChannels)
 		{
 			SmoothedRmsLevels.Init(0.0f, NumChannels);
 			PeakLevels.Init(0.0f, NumChannels);
-			TimesOfLastPeak.Init(0.0f, NumChannels);
+			SamplePeakLevels.Init(0.0f, NumChannels);
+			ClipCounts.Init(0, NumChannels);
+			PolledMeterStates.Init(FAkMMeterState(), NumChannels);
 		}
-		
-		for (int32 i = 0; i < NumChannels; ++i)
-		{
-			// Get the raw RMS level for the current channel
-			const float RawRms = JackAudioLinkSubsystem->GetInputLevel(i);
-
-			// Apply smoothing (exponential moving average)
-			const float SmoothingFactor = 0.6f;
-			SmoothedRmsLevels[i] = (RawRms * (1.0f - SmoothingFactor)) + (SmoothedRmsLevels[i] * SmoothingFactor);
 
-			// Update peak level
-			if (SmoothedRmsLevels[i] > PeakLevels[i])
+		if (bUsingAudioThreadLevels)
+		{
+			for (int32 i = 0; i < NumChannels; ++i)
 			{
-				PeakLevels[i] = SmoothedRmsLevels[i];
-				TimesOfLastPeak[i] = GetWorld()->GetTimeSeconds();
+				const FAkMChannelLevel& Level = TapLevels.Channels[i];
+				SmoothedRmsLevels[i] = Level.Meter;
+				PeakLevels[i] = Level.HoldPeak;
+				SamplePeakLevels[i] = Level.Peak;
+				ClipCounts[i] = Level.ClipCount;
 			}
-
-			// Let peak level fall off after a short time
-			const float PeakHoldTime = 1.5f;
-			if (GetWorld()->GetTimeSeconds() - TimesOfLastPeak[i] > PeakHoldTime)
+			GroupLoudness.SetNum(TapLevels.NumLoudnessGroups, EAllowShrinking::No);
+			for (int32 g = 0; g < TapLevels.NumLoudnessGroups; ++g)
+			{
+				GroupLoudness[g] = TapLevels.GroupLoudness[g];
+			}
+			MasterLoudness = TapLevels.MasterLoudness;
+		}
+		else
+		{
+			// The plugin's level is already an RMS; treat it as both detector inputs over the elapsed frame time
+			const FAkMMeterBallistics Ballistics = FAkMMeterBallistics::FromPreset(MeterBallistics);
+			const FAkMMeterBallistics::FStepCoefficients Coefficients = Ballistics.GetStepCoefficients(DeltaTime);
+			for (int32 i = 0; i < NumChannels; ++i)
 			{
-				// Decay peak level smoothly
-				PeakLevels[i] = FMath::Max(0.0f, PeakLevels[i] - (DeltaTime * 0.5f));
+				const float RawRms = JackAudioLinkSubsystem->GetInputLevel(i);
+				Ballistics.Step(PolledMeterStates[i], RawRms, RawRms, Coefficients);
+				SmoothedRmsLevels[i] = PolledMeterStates[i].Level;
+				PeakLevels[i] = PolledMeterStates[i].HoldPeak;
+				SamplePeakLevels[i] = RawRms;
 			}
+			GroupLoudness.Reset();
+			MasterLoudness = FAkMLoudness();
 		}
 	}
 	// --- End Update ---
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMFFT.h"
+
+FAkMFFT::FAkMFFT(int32 InSize)
+	: Size(GetSizeFor(InSize))
+{
+	const int32 NumBits = FMath::FloorLog2(uint32(Size));
+	BitReverse.SetNumUninitialized(Size);
+	for (int32 i = 0; i < Size; ++i)
+	{
+		int32 Reversed = 0;
+		for (int32 Bit = 0; Bit < NumBits; ++Bit)
+		{
+			Reversed |= ((i >> Bit) & 1) << (NumBits - 1 - Bit);
+		}
+		BitReverse[i] = Reversed;
+	}
+
+	Cos.SetNumUninitialized(Size / 2);
+	Sin.SetNumUninitialized(Size / 2);
+	for (int32 i = 0; i < Size / 2; ++i)
+	{
+		const double Angle = -2.0 * PI * i / Size;
+		Cos[i] = float(FMath::Cos(Angle));
+		Sin[i] = float(FMath::Sin(Angle));
+	}
+}
+
+void FAkMFFT::Inverse(float* Real, float* Imag) const
+{
+	Transform(Real, Imag, true);
+	const float Scale = 1.0f / Size;
+	for (int32 i = 0; i < Size; ++i)
+	{
+		Real[i] *= Scale;
+		Imag[i] *= Scale;
+	}
+}
+
+void FAkMFFT::Transform(float* Real, float* Imag, bool bInverse) const
+{
+	for (int32 i = 0; i < Size; ++i)
+	{
+		const int32 j = BitReverse[i];
+		if (j > i)
+		{
+			Swap(Real[i], Real[j]);
+			Swap(Imag[i], Imag[j]);
+		}
+	}
+
+	const float SinSign = bInverse ? -1.0f : 1.0f;
+	for (int32 Length = 2; Length <= Size; Length <<= 1)
+	{
+		const int32 Half = Length >> 1;
+		const int32 TwiddleStep = Size / Length;
+		for (int32 Start = 0; Start < Size; Start += Length)
+		{
+			for (int32 k = 0; k < Half; ++k)
+			{
+				const float Wr = Cos[k * TwiddleStep];
+				const float Wi = SinSign * Sin[k * TwiddleStep];
+				const int32 a = Start + k;
+				const int32 b = a + Half;
+				const float Tr = Real[b] * Wr - Imag[b] * Wi;
+				const float Ti = Real[b] * Wi + Imag[b] * Wr;
+				Real[b] = Real[a] - Tr;
+				Imag[b] = Imag[a] - Ti;
+				Real[a] += Tr;
+				Imag[a] += Ti;
+			}
+		}
+	}
+}
@@ -0,0 +1,326 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMFilePlayer.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+
+namespace
+{
+	constexpr double StopAcknowledgeTimeoutSeconds = 0.5;
+
+	template<typename T>
+	T ReadLE(const uint8* Data)
+	{
+		T Value;
+		FMemory::Memcpy(&Value, Data, sizeof(T));
+		return Value;
+	}
+}
+
+bool FAkMWaveFormat::Read(IFileHandle& File, FAkMWaveFormat& OutFormat)
+{
+	OutFormat = FAkMWaveFormat();
+	uint8 Header[40];
+	if (!File.Seek(0) || !File.Read(Header, 12) || FMemory::Memcmp(Header + 8, "WAVE", 4) != 0)
+	{
+		return false;
+	}
+	const bool bRf64 = FMemory::Memcmp(Header, "RF64", 4) == 0;
+	if (!bRf64 && FMemory::Memcmp(Header, "RIFF", 4) != 0)
+	{
+		return false;
+	}
+
+	const int64 FileSize = File.Size();
+	uint64 Rf64DataBytes = 0;
+	uint16 FormatTag = 0;
+	while (File.Tell() + 8 <= FileSize && File.Read(Header, 8))
+	{
+		const uint32 ChunkBytes = ReadLE<uint32>(Header + 4);
+		const int64 ChunkStart = File.Tell();
+		if (FMemory::Memcmp(Header, "ds64", 4) == 0 && ChunkBytes >= 16)
+		{
+			if (!File.Read(Header, 16))
+			{
+				return false;
+			}
+			Rf64DataBytes = ReadLE<uint64>(Header + 8);
+		}
+		else if (FMemory::Memcmp(Header, "fmt ", 4) == 0 && ChunkBytes >= 16)
+		{
+			const int32 FormatBytes = FMath::Min<int32>(ChunkBytes, sizeof(Header));
+			if (!File.Read(Header, FormatBytes))
+			{
+				return false;
+			}
+			FormatTag = ReadLE<uint16>(Header);
+			OutFormat.NumChannels = ReadLE<uint16>(Header + 2);
+			OutFormat.SampleRate = int32(ReadLE<uint32>(Header + 4));
+			OutFormat.BitsPerSample = ReadLE<uint16>(Header + 14);
+			// WAVE_FORMAT_EXTENSIBLE: the format tag is the start of the sub-format GUID
+			if (FormatTag == 0xFFFE && FormatBytes >= 40)
+			{
+				FormatTag = ReadLE<uint16>(Header + 24);
+			}
+		}
+		else if (FMemory::Memcmp(Header, "data", 4) == 0)
+		{
+			OutFormat.DataOffset = ChunkStart;
+			OutFormat.DataBytes = (bRf64 && ChunkBytes == MAX_uint32) ? int64(Rf64DataBytes) : int64(ChunkBytes);
+			// Files still being written, or cut short, hold less than the header says
+			OutFormat.DataBytes = FMath::Min(OutFormat.DataBytes, FileSize - ChunkStart);
+			break;
+		}
+		if (!File.Seek(ChunkStart + ChunkBytes + (ChunkBytes & 1)))
+		{
+			return false;
+		}
+	}
+
+	OutFormat.bFloat = FormatTag == 3;
+	const bool bPcm = FormatTag == 1 && (OutFormat.BitsPerSample == 16 || OutFormat.BitsPerSample == 24 || OutFormat.BitsPerSample == 32);
+	const bool bFloat32 = OutFormat.bFloat && OutFormat.BitsPerSample == 32;
+	return OutFormat.DataOffset > 0 && OutFormat.NumChannels > 0 && (bPcm || bFloat32);
+}
+
+FAkMFilePlayer::~FAkMFilePlayer()
+{
+	StopPlayback();
+}
+
+bool FAkMFilePlayer::StartPlayback(const FString& InFilePath, TConstArrayView<int32> OutputChannels, bool bLoop, float ReadAheadSeconds)
+{
+	if (Thread)
+	{
+		return false;
+	}
+	File = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*InFilePath);
+	if (!File)
+	{
+		return false;
+	}
+	if (!FAkMWaveFormat::Read(*File, Format) || Format.NumChannels > MaxChannels || Format.GetNumFrames() == 0)
+	{
+		delete File;
+		File = nullptr;
+		return false;
+	}
+	FilePath = InFilePath;
+	NumFileChannels = Format.NumChannels;
+	for (int32 c = 0; c < NumFileChannels; ++c)
+	{
+		OutputChannelMap[c] = OutputChannels.IsValidIndex(c) ? OutputChannels[c] : INDEX_NONE;
+	}
+	bLooping = bLoop;
+
+	// Idle or Stopped: the audio thread does not touch the ring, so it can be replaced
+	const int32 RingFrames = FMath::Max(ReadChunkFrames * 2, FMath::CeilToInt(ReadAheadSeconds * (Format.SampleRate > 0 ? Format.SampleRate : AssumedSampleRate)));
+	const int32 RingSamples = RingFrames * NumFileChannels;
+	if (!Ring || Ring->GetCapacity() < RingSamples)
+	{
+		Ring = MakeUnique<TAkMSpscRing<float>>(RingSamples);
+	}
+	Ring->Skip(Ring->NumReadable());
+	Staging.SetNumUninitialized(StagingFrames * NumFileChannels);
+	ReadBuffer.SetNumUninitialized(ReadChunkFrames * Format.GetBlockAlign());
+	DecodeBuffer.SetNumUninitialized(ReadChunkFrames * NumFileChannels);
+
+	File->Seek(Format.DataOffset);
+	ReadPosition = 0;
+	bPrimed.store(false);
+	bEndOfFile.store(false);
+	bFinished.store(false);
+	FramesPlayed.store(0);
+	NumUnderruns.store(0);
+
+	bStopRequested = false;
+	State.store(EState::Playing, std::memory_order_release);
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("AkMFilePlayerReader"), 0, TPri_AboveNormal);
+	if (!Thread)
+	{
+		State.store(EState::Idle);
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+		delete File;
+		File = nullptr;
+		return false;
+	}
+	return true;
+}
+
+void FAkMFilePlayer::StopPlayback()
+{
+	if (!Thread)
+	{
+		return;
+	}
+	EState Expected = EState::Playing;
+	State.compare_exchange_strong(Expected, EState::Stopping);
+	Stop();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+void FAkMFilePlayer::Stop()
+{
+	bStopRequested = true;
+	if (WakeEvent)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+float FAkMFilePlayer::GetRingFill() const
+{
+	return Ring && IsPlaying() ? float(Ring->NumReadable()) / Ring->GetCapacity() : 0.0f;
+}
+
+void FAkMFilePlayer::RenderOutput(float* const* OutputData, int32 NumChannels, int32 NumFrames)
+{
+	const EState Current = State.load(std::memory_order_acquire);
+	if (Current == EState::Stopping)
+	{
+		State.store(EState::Stopped, std::memory_order_release);
+	}
+	// Wait for the reader to fill the ring before the first block
+	if (Current != EState::Playing || !bPrimed.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	bool bShort = false;
+	for (int32 First = 0; First < NumFrames; First += StagingFrames)
+	{
+		const int32 Count = FMath::Min(StagingFrames, NumFrames - First);
+		// The reader writes whole frames, so this reads whole frames too
+		const int32 Got = Ring->Read(Staging.GetData(), Count * NumFileChannels) / NumFileChannels;
+		bShort |= Got < Count;
+		for (int32 c = 0; c < NumFileChannels; ++c)
+		{
+			const int32 Channel = OutputChannelMap[c];
+			if (Channel < 0 || Channel >= NumChannels || !OutputData[Channel])
+			{
+				continue;
+			}
+			float* Out = OutputData[Channel] + First;
+			const float* Source = Staging.GetData() + c;
+			for (int32 i = 0; i < Got; ++i)
+			{
+				Out[i] += Source[i * NumFileChannels];
+			}
+		}
+		FramesPlayed.fetch_add(Got, std::memory_order_relaxed);
+	}
+
+	if (bShort)
+	{
+		if (bEndOfFile.load(std::memory_order_acquire) && Ring->NumReadable() == 0)
+		{
+			bFinished.store(true, std::memory_order_release);
+		}
+		else
+		{
+			NumUnderruns.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+}
+
+uint32 FAkMFilePlayer::Run()
+{
+	double StopRequestTime = -1.0;
+	while (true)
+	{
+		if (bStopRequested)
+		{
+			const double Now = FPlatformTime::Seconds();
+			StopRequestTime = StopRequestTime < 0.0 ? Now : StopRequestTime;
+			if (State.load(std::memory_order_acquire) == EState::Stopped || Now - StopRequestTime > StopAcknowledgeTimeoutSeconds)
+			{
+				break;
+			}
+			WakeEvent->Wait(5);
+			continue;
+		}
+		if (!ReadChunk())
+		{
+			WakeEvent->Wait(5);
+		}
+	}
+
+	delete File;
+	File = nullptr;
+	State.store(EState::Idle, std::memory_order_release);
+	return 0;
+}
+
+bool FAkMFilePlayer::ReadChunk()
+{
+	if (bEndOfFile.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+	if (Ring->NumFree() < ReadChunkFrames * NumFileChannels)
+	{
+		bPrimed.store(true, std::memory_order_release);
+		return false;
+	}
+
+	const int32 BlockAlign = Format.GetBlockAlign();
+	const int32 NumFrames = int32(FMath::Min<int64>(ReadChunkFrames, (Format.DataBytes - ReadPosition) / BlockAlign));
+	if (NumFrames <= 0 || !File->Read(ReadBuffer.GetData(), int64(NumFrames) * BlockAlign))
+	{
+		// Loop without a gap: the next chunk follows in the same ring
+		if (bLooping && ReadPosition > 0 && File->Seek(Format.DataOffset))
+		{
+			ReadPosition = 0;
+			return true;
+		}
+		bEndOfFile.store(true, std::memory_order_release);
+		bPrimed.store(true, std::memory_order_release);
+		return false;
+	}
+	ReadPosition += int64(NumFrames) * BlockAlign;
+
+	const int32 NumSamples = NumFrames * NumFileChannels;
+	const uint8* Bytes = ReadBuffer.GetData();
+	float* Decoded = DecodeBuffer.GetData();
+	switch (Format.BitsPerSample)
+	{
+	case 16:
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			Decoded[i] = ReadLE<int16>(Bytes + i * 2) * (1.0f / 32768.0f);
+		}
+		break;
+	case 24:
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			const uint8* Sample = Bytes + i * 3;
+			const int32 Value = int32((uint32(Sample[0]) << 8) | (uint32(Sample[1]) << 16) | (uint32(Sample[2]) << 24)) >> 8;
+			Decoded[i] = Value * (1.0f / 8388608.0f);
+		}
+		break;
+	default:
+		if (Format.bFloat)
+		{
+			FMemory::Memcpy(Decoded, Bytes, NumSamples * sizeof(float));
+		}
+		else
+		{
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				Decoded[i] = float(ReadLE<int32>(Bytes + i * 4) * (1.0 / 2147483648.0));
+			}
+		}
+		break;
+	}
+	Ring->Write(Decoded, NumSamples);
+	return true;
+}
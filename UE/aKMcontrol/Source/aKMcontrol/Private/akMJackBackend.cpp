@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMJackBackend.h"
+#include "Engine/Engine.h"
+#include "UEJackAudioLinkSubsystem.h"
+
+UUEJackAudioLinkSubsystem* FAkMJackLinkBackend::GetJackSubsystem()
+{
+	return GEngine ? GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>() : nullptr;
+}
+
+FString FAkMJackLinkBackend::GetJackClientName() const
+{
+	UUEJackAudioLinkSubsystem* Subsystem = GetJackSubsystem();
+	return Subsystem ? Subsystem->GetJackClientName() : FString();
+}
+
+TArray<FString> FAkMJackLinkBackend::GetConnectedClients() const
+{
+	UUEJackAudioLinkSubsystem* Subsystem = GetJackSubsystem();
+	return Subsystem ? Subsystem->GetConnectedClients() : TArray<FString>();
+}
+
+void FAkMJackLinkBackend::GetClientPorts(const FString& ClientName, TArray<FString>& OutInputPorts, TArray<FString>& OutOutputPorts) const
+{
+	if (UUEJackAudioLinkSubsystem* Subsystem = GetJackSubsystem())
+	{
+		Subsystem->GetClientPorts(ClientName, OutInputPorts, OutOutputPorts);
+	}
+}
+
+bool FAkMJackLinkBackend::GetPortConnections(const FString& Port, TArray<FString>& OutConnectedPorts) const
+{
+	OutConnectedPorts.Reset();
+#if AKM_WITH_JACK_PORT_CONNECTIONS
+	if (UUEJackAudioLinkSubsystem* Subsystem = GetJackSubsystem())
+	{
+		OutConnectedPorts = Subsystem->GetPortConnections(Port);
+		return true;
+	}
+#endif
+	return false;
+}
+
+bool FAkMJackLinkBackend::ConnectPorts(const FString& SourcePort, const FString& DestinationPort)
+{
+	UUEJackAudioLinkSubsystem* Subsystem = GetJackSubsystem();
+	return Subsystem && Subsystem->ConnectPorts(SourcePort, DestinationPort);
+}
+
+bool FAkMJackLinkBackend::DisconnectPorts(const FString& SourcePort, const FString& DestinationPort)
+{
+	UUEJackAudioLinkSubsystem* Subsystem = GetJackSubsystem();
+	return Subsystem && Subsystem->DisconnectPorts(SourcePort, DestinationPort);
+}
@@ -0,0 +1,176 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMJackGraph.h"
+
+void FAkMJackGraph::SetClient(const FString& ClientName, TArray<FString> InputPorts, TArray<FString> OutputPorts)
+{
+	FClient& Client = Clients.FindOrAdd(ClientName);
+	Client.InputPorts = MoveTemp(InputPorts);
+	Client.OutputPorts = MoveTemp(OutputPorts);
+	++Generation;
+}
+
+void FAkMJackGraph::RemoveClient(const FString& ClientName)
+{
+	// JACK drops every connection of a client's ports when it unregisters
+	TArray<FAkMJackConnection> Connections;
+	GetClientConnections(ClientName, Connections);
+	for (const FAkMJackConnection& Connection : Connections)
+	{
+		RemoveConnection(Connection.Source, Connection.Destination);
+	}
+	Clients.Remove(ClientName);
+	++Generation;
+}
+
+void FAkMJackGraph::Reset()
+{
+	Clients.Reset();
+	Downstream.Reset();
+	Upstream.Reset();
+	NumConnections = 0;
+	++Generation;
+}
+
+const FString* FAkMJackGraph::GetInputPort(const FString& ClientName, int32 Index1Based) const
+{
+	const FClient* Client = Clients.Find(ClientName);
+	return (Client && Client->InputPorts.IsValidIndex(Index1Based - 1)) ? &Client->InputPorts[Index1Based - 1] : nullptr;
+}
+
+const FString* FAkMJackGraph::GetOutputPort(const FString& ClientName, int32 Index1Based) const
+{
+	const FClient* Client = Clients.Find(ClientName);
+	return (Client && Client->OutputPorts.IsValidIndex(Index1Based - 1)) ? &Client->OutputPorts[Index1Based - 1] : nullptr;
+}
+
+void FAkMJackGraph::AddConnection(const FString& Source, const FString& Destination)
+{
+	if (IsConnected(Source, Destination))
+	{
+		return;
+	}
+	Downstream.Add(Source, Destination);
+	Upstream.Add(Destination, Source);
+	++NumConnections;
+	++Generation;
+}
+
+void FAkMJackGraph::RemoveConnection(const FString& Source, const FString& Destination)
+{
+	if (Downstream.RemoveSingle(Source, Destination) > 0)
+	{
+		Upstream.RemoveSingle(Destination, Source);
+		--NumConnections;
+		++Generation;
+	}
+}
+
+bool FAkMJackGraph::IsConnected(const FString& Source, const FString& Destination) const
+{
+	return Downstream.FindPair(Source, Destination) != nullptr;
+}
+
+void FAkMJackGraph::GetDestinations(const FString& SourcePort, TArray<FString>& OutDestinations) const
+{
+	Downstream.MultiFind(SourcePort, OutDestinations);
+}
+
+void FAkMJackGraph::GetSources(const FString& DestinationPort, TArray<FString>& OutSources) const
+{
+	Upstream.MultiFind(DestinationPort, OutSources);
+}
+
+void FAkMJackGraph::GetClientConnections(const FString& ClientName, TArray<FAkMJackConnection>& OutConnections) const
+{
+	if (const FClient* Client = Clients.Find(ClientName))
+	{
+		for (const FString& Output : Client->OutputPorts)
+		{
+			for (auto It = Downstream.CreateConstKeyIterator(Output); It; ++It)
+			{
+				OutConnections.Emplace(Output, It.Value());
+			}
+		}
+		for (const FString& Input : Client->InputPorts)
+		{
+			for (auto It = Upstream.CreateConstKeyIterator(Input); It; ++It)
+			{
+				OutConnections.Emplace(It.Value(), Input);
+			}
+		}
+		return;
+	}
+
+	// Ports not cached: match connections by client prefix
+	for (const TPair<FString, FString>& Pair : Downstream)
+	{
+		if (GetClientOfPort(Pair.Key).Equals(ClientName, ESearchCase::IgnoreCase) || GetClientOfPort(Pair.Value).Equals(ClientName, ESearchCase::IgnoreCase))
+		{
+			OutConnections.Emplace(Pair.Key, Pair.Value);
+		}
+	}
+}
+
+void FAkMJackGraph::Reduce(const FAkMJackRoutingTransaction& Transaction, FAkMJackRoutingTransaction& OutMinimal) const
+{
+	TSet<FAkMJackConnection> Seen;
+	for (const FAkMJackConnection& Connection : Transaction.Disconnects)
+	{
+		bool bAlreadySeen = false;
+		Seen.Add(Connection, &bAlreadySeen);
+		if (!bAlreadySeen && IsConnected(Connection.Source, Connection.Destination))
+		{
+			OutMinimal.Disconnects.Add(Connection);
+		}
+	}
+
+	// A connect following a disconnect of the same pair in one transaction is a reconnect, not a no-op
+	TSet<FAkMJackConnection> Disconnected(OutMinimal.Disconnects);
+	Seen.Reset();
+	for (const FAkMJackConnection& Connection : Transaction.Connects)
+	{
+		bool bAlreadySeen = false;
+		Seen.Add(Connection, &bAlreadySeen);
+		if (!bAlreadySeen && (!IsConnected(Connection.Source, Connection.Destination) || Disconnected.Contains(Connection)))
+		{
+			OutMinimal.Connects.Add(Connection);
+		}
+	}
+}
+
+void FAkMJackGraph::DiffClientPair(const FString& SourceClient, const FString& DestinationClient, const TArray<FAkMJackConnection>& Desired, FAkMJackRoutingTransaction& OutTransaction) const
+{
+	const TSet<FAkMJackConnection> DesiredSet(Desired);
+
+	// Existing connections from SourceClient into DestinationClient that are not wanted anymore
+	TArray<FAkMJackConnection> Existing;
+	GetClientConnections(SourceClient, Existing);
+	for (const FAkMJackConnection& Connection : Existing)
+	{
+		if (GetClientOfPort(Connection.Source).Equals(SourceClient, ESearchCase::IgnoreCase)
+			&& GetClientOfPort(Connection.Destination).Equals(DestinationClient, ESearchCase::IgnoreCase)
+			&& !DesiredSet.Contains(Connection))
+		{
+			OutTransaction.Disconnects.Add(Connection);
+		}
+	}
+
+	// Keep the caller's channel order
+	TSet<FAkMJackConnection> Seen;
+	for (const FAkMJackConnection& Connection : Desired)
+	{
+		bool bAlreadySeen = false;
+		Seen.Add(Connection, &bAlreadySeen);
+		if (!bAlreadySeen && !IsConnected(Connection.Source, Connection.Destination))
+		{
+			OutTransaction.Connects.Add(Connection);
+		}
+	}
+}
+
+FString FAkMJackGraph::GetClientOfPort(const FString& PortName)
+{
+	int32 Separator = INDEX_NONE;
+	return PortName.FindChar(TEXT(':'), Separator) ? PortName.Left(Separator) : PortName;
+}
@@ -0,0 +1,338 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMJackGraphSubsystem.h"
+#include "Algo/Count.h"
+#include "Engine/Engine.h"
+#include "UEJackAudioLinkSubsystem.h"
+
+DEFINE_LOG_CATEGORY(LogAkMJackGraph);
+
+void UakMJackGraphSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Backend = MakeShared<FAkMJackLinkBackend>();
+
+	// Bind to UEJackAudioLink events
+	if (UUEJackAudioLinkSubsystem* JackSubsystem = Collection.InitializeDependency<UUEJackAudioLinkSubsystem>())
+	{
+		JackSubsystem->OnNewJackClientConnected.AddDynamic(this, &UakMJackGraphSubsystem::HandleJackClientConnected);
+		JackSubsystem->OnJackClientDisconnected.AddDynamic(this, &UakMJackGraphSubsystem::HandleJackClientDisconnected);
+#if AKM_WITH_JACK_PORT_CONNECT_EVENT
+		JackSubsystem->OnJackPortConnectionChanged.AddDynamic(this, &UakMJackGraphSubsystem::HandlePortConnect);
+		bPortConnectEventBound = true;
+#endif
+	}
+}
+
+void UakMJackGraphSubsystem::Deinitialize()
+{
+	if (UUEJackAudioLinkSubsystem* JackSubsystem = GetJackSubsystem())
+	{
+		JackSubsystem->OnNewJackClientConnected.RemoveDynamic(this, &UakMJackGraphSubsystem::HandleJackClientConnected);
+		JackSubsystem->OnJackClientDisconnected.RemoveDynamic(this, &UakMJackGraphSubsystem::HandleJackClientDisconnected);
+#if AKM_WITH_JACK_PORT_CONNECT_EVENT
+		JackSubsystem->OnJackPortConnectionChanged.RemoveDynamic(this, &UakMJackGraphSubsystem::HandlePortConnect);
+#endif
+	}
+	bPortConnectEventBound = false;
+	SyncedClientPairs.Reset();
+	Graph.Reset();
+	Backend.Reset();
+
+	Super::Deinitialize();
+}
+
+void UakMJackGraphSubsystem::InitializeWithBackend(const TSharedRef<IAkMJackBackend>& InBackend, bool bInGraphComplete)
+{
+	Backend = InBackend;
+	bPortConnectEventBound = false;
+	bGraphComplete = bInGraphComplete;
+	SyncedClientPairs.Reset();
+	Graph.Reset();
+	UnrealClientName.Reset();
+	LastMissRefreshTimes.Reset();
+}
+
+UUEJackAudioLinkSubsystem* UakMJackGraphSubsystem::GetJackSubsystem() const
+{
+	return GEngine ? GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>() : nullptr;
+}
+
+const FAkMJackGraph::FClient* UakMJackGraphSubsystem::GetClient(const FString& ClientName)
+{
+	if (const FAkMJackGraph::FClient* Client = Graph.FindClient(ClientName))
+	{
+		return Client;
+	}
+	RefreshClient(ClientName);
+	return Graph.FindClient(ClientName);
+}
+
+bool UakMJackGraphSubsystem::GetPortCounts(const FString& ClientName, int32& OutNumInputs, int32& OutNumOutputs)
+{
+	const FAkMJackGraph::FClient* Client = Graph.FindClient(ClientName);
+	if (!Client && !ClientName.IsEmpty())
+	{
+		const double Now = FPlatformTime::Seconds();
+		double& LastRefresh = LastMissRefreshTimes.FindOrAdd(ClientName, -1.0);
+		if (LastRefresh < 0.0 || Now - LastRefresh > 1.0)
+		{
+			LastRefresh = Now;
+			RefreshClient(ClientName);
+			Client = Graph.FindClient(ClientName);
+		}
+	}
+
+	OutNumInputs = Client ? Client->InputPorts.Num() : 0;
+	OutNumOutputs = Client ? Client->OutputPorts.Num() : 0;
+	return Client != nullptr;
+}
+
+void UakMJackGraphSubsystem::RefreshClient(const FString& ClientName)
+{
+	if (!Backend || ClientName.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<FString> Inputs, Outputs;
+	Backend->GetClientPorts(ClientName, Inputs, Outputs);
+	if (Inputs.Num() > 0 || Outputs.Num() > 0)
+	{
+		Graph.SetClient(ClientName, MoveTemp(Inputs), MoveTemp(Outputs));
+		LastMissRefreshTimes.Remove(ClientName);
+	}
+}
+
+const FString& UakMJackGraphSubsystem::GetUnrealClientName()
+{
+	if (UnrealClientName.IsEmpty())
+	{
+		if (Backend)
+		{
+			UnrealClientName = Backend->GetJackClientName();
+		}
+	}
+	return UnrealClientName;
+}
+
+bool UakMJackGraphSubsystem::AddConnectByIndex(FAkMJackRoutingTransaction& Transaction, const FString& SourceClient, int32 OutputIndex1Based, const FString& DestinationClient, int32 InputIndex1Based)
+{
+	// Cache both clients first; fetching one may reallocate the client map
+	GetClient(SourceClient);
+	GetClient(DestinationClient);
+	const FString* Source = Graph.GetOutputPort(SourceClient, OutputIndex1Based);
+	const FString* Destination = Graph.GetInputPort(DestinationClient, InputIndex1Based);
+	if (!Source || !Destination)
+	{
+		UE_LOG(LogAkMJackGraph, Warning, TEXT("Unknown port %s output #%d or %s input #%d."), *SourceClient, OutputIndex1Based, *DestinationClient, InputIndex1Based);
+		return false;
+	}
+	Transaction.Connect(*Source, *Destination);
+	return true;
+}
+
+bool UakMJackGraphSubsystem::IsConnectedByIndex(const FString& SourceClient, int32 OutputIndex1Based, const FString& DestinationClient, int32 InputIndex1Based)
+{
+	GetClient(SourceClient);
+	GetClient(DestinationClient);
+	const FString* Source = Graph.GetOutputPort(SourceClient, OutputIndex1Based);
+	const FString* Destination = Graph.GetInputPort(DestinationClient, InputIndex1Based);
+	return Source && Destination && Graph.IsConnected(*Source, *Destination);
+}
+
+int32 UakMJackGraphSubsystem::ApplyRouting(const FAkMJackRoutingTransaction& Transaction)
+{
+	if (!Backend)
+	{
+		return Transaction.Num();
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	FAkMJackRoutingTransaction Minimal;
+	Graph.Reduce(Transaction, Minimal);
+
+	int32 NumFailed = 0;
+	for (const FAkMJackConnection& Connection : Minimal.Disconnects)
+	{
+		// A failed disconnect means JACK no longer has the connection either (e.g. removed by another patchbay)
+		if (!Backend->DisconnectPorts(Connection.Source, Connection.Destination))
+		{
+			++NumFailed;
+		}
+		Graph.RemoveConnection(Connection.Source, Connection.Destination);
+	}
+	for (const FAkMJackConnection& Connection : Minimal.Connects)
+	{
+		if (Backend->ConnectPorts(Connection.Source, Connection.Destination))
+		{
+			Graph.AddConnection(Connection.Source, Connection.Destination);
+		}
+		else
+		{
+			UE_LOG(LogAkMJackGraph, Warning, TEXT("Failed to connect %s -> %s."), *Connection.Source, *Connection.Destination);
+			++NumFailed;
+		}
+	}
+
+	NumAppliedOperations += Minimal.Num();
+	LastApplySeconds = FPlatformTime::Seconds() - StartTime;
+	UE_LOG(LogAkMJackGraph, Verbose, TEXT("Applied %d of %d routing operations in %.3f ms (%d failed)."),
+		Minimal.Num(), Transaction.Num(), LastApplySeconds * 1000.0, NumFailed);
+	return NumFailed;
+}
+
+int32 UakMJackGraphSubsystem::DisconnectClient(const FString& ClientName)
+{
+	if (!Backend || ClientName.IsEmpty())
+	{
+		return 0;
+	}
+	if (bGraphComplete)
+	{
+		FAkMJackRoutingTransaction Transaction;
+		Graph.GetClientConnections(ClientName, Transaction.Disconnects);
+		const int32 NumConnections = Transaction.Disconnects.Num();
+		return NumConnections - ApplyRouting(Transaction);
+	}
+
+	TArray<FString> Inputs, Outputs;
+	Backend->GetClientPorts(ClientName, Inputs, Outputs);
+	int32 NumRemoved = 0;
+	auto TryDisconnect = [this, &NumRemoved](const FString& Source, const FString& Destination)
+	{
+		if (Backend->DisconnectPorts(Source, Destination))
+		{
+			++NumRemoved;
+		}
+	};
+	TArray<FString> OtherInputs, OtherOutputs;
+	for (const FString& Other : Backend->GetConnectedClients())
+	{
+		if (Other.Equals(ClientName, ESearchCase::IgnoreCase))
+		{
+			continue;
+		}
+		Backend->GetClientPorts(Other, OtherInputs, OtherOutputs);
+		for (const FString& Output : Outputs)
+		{
+			for (const FString& Input : OtherInputs)
+			{
+				TryDisconnect(Output, Input);
+			}
+		}
+		for (const FString& Output : OtherOutputs)
+		{
+			for (const FString& Input : Inputs)
+			{
+				TryDisconnect(Output, Input);
+			}
+		}
+	}
+
+	// Nothing the cache still holds for the client exists in JACK any more
+	TArray<FAkMJackConnection> Connections;
+	Graph.GetClientConnections(ClientName, Connections);
+	for (const FAkMJackConnection& Connection : Connections)
+	{
+		Graph.RemoveConnection(Connection.Source, Connection.Destination);
+	}
+	return NumRemoved;
+}
+
+int32 UakMJackGraphSubsystem::SyncConnections(const FString& SourceClient, const FString& DestinationClient)
+{
+	if (!Backend || SourceClient.IsEmpty() || DestinationClient.IsEmpty())
+	{
+		return 0;
+	}
+
+	GetClient(SourceClient);
+	GetClient(DestinationClient);
+	const FAkMJackGraph::FClient* Source = Graph.FindClient(SourceClient);
+	const FAkMJackGraph::FClient* Destination = Graph.FindClient(DestinationClient);
+	if (!Source || !Destination)
+	{
+		return 0;
+	}
+
+	const TPair<FString, FString> Pair(SourceClient.ToLower(), DestinationClient.ToLower());
+	if (bGraphComplete || (bPortConnectEventBound && SyncedClientPairs.Contains(Pair)))
+	{
+		int32 NumKnown = 0;
+		TArray<FString> Destinations;
+		for (const FString& Output : Source->OutputPorts)
+		{
+			Destinations.Reset();
+			Graph.GetDestinations(Output, Destinations);
+			NumKnown += Algo::CountIf(Destinations, [&DestinationClient](const FString& Port)
+			{
+				return FAkMJackGraph::GetClientOfPort(Port).Equals(DestinationClient, ESearchCase::IgnoreCase);
+			});
+		}
+		return NumKnown;
+	}
+
+	// Copy the port names: recording a connection must not invalidate what is being iterated
+	const TArray<FString> Outputs = Source->OutputPorts;
+	const TArray<FString> Inputs = Destination->InputPorts;
+	int32 NumFound = 0;
+	for (const FString& Output : Outputs)
+	{
+		bool bFound = false;
+		for (const FString& Input : Inputs)
+		{
+			if (!bFound && Backend->DisconnectPorts(Output, Input))
+			{
+				Backend->ConnectPorts(Output, Input);
+				Graph.AddConnection(Output, Input);
+				bFound = true;
+				++NumFound;
+			}
+			else if (!bFound)
+			{
+				Graph.RemoveConnection(Output, Input);
+			}
+		}
+	}
+	if (bPortConnectEventBound)
+	{
+		SyncedClientPairs.Add(Pair);
+	}
+	return NumFound;
+}
+
+void UakMJackGraphSubsystem::HandlePortConnect(const FString& SourcePort, const FString& DestinationPort, bool bConnected)
+{
+	if (bConnected)
+	{
+		Graph.AddConnection(SourcePort, DestinationPort);
+	}
+	else
+	{
+		Graph.RemoveConnection(SourcePort, DestinationPort);
+	}
+}
+
+void UakMJackGraphSubsystem::HandleJackClientConnected(const FString& ClientName, int32 NumInputPorts, int32 NumOutputPorts)
+{
+	RefreshClient(ClientName);
+}
+
+void UakMJackGraphSubsystem::HandleJackClientDisconnected(const FString& ClientName)
+{
+	Graph.RemoveClient(ClientName);
+	for (auto It = SyncedClientPairs.CreateIterator(); It; ++It)
+	{
+		if (It->Key.Equals(ClientName, ESearchCase::IgnoreCase) || It->Value.Equals(ClientName, ESearchCase::IgnoreCase))
+		{
+			It.RemoveCurrent();
+		}
+	}
+	if (ClientName.Equals(UnrealClientName, ESearchCase::IgnoreCase))
+	{
+		UnrealClientName.Reset();
+	}
+}
@@ -0,0 +1,196 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "UObject/Package.h"
+#include "akMJackGraphSubsystem.h"
+#include "akMMockJackBackend.h"
+#include "akMSpatServerManager.h"
+
+// akM.Jack.BenchmarkRouting: runs the routing code of AakMSpatServerManager against FAkMMockJackBackend and reports
+// per-operation latency. Needs a game world (PIE or -game); nothing touches the real JACK server, and the manager on
+// the mock graph leaves the process-wide state (UEJackAudioLink events, OSC, audio tap) to the real one.
+
+namespace
+{
+	struct FAkMRoutingBenchmarkScale
+	{
+		const TCHAR* Name;
+		int32 NumClients;
+		int32 ChannelsPerClient;
+		int32 NumUnrealInputs;
+		int32 NumServerChannels;
+		float CallLatencyUs;	// ~20 us is a local jack_connect round trip
+	};
+
+	struct FAkMLatencySamples
+	{
+		TArray<double> Ms;
+
+		FString ToString() const
+		{
+			if (Ms.IsEmpty())
+			{
+				return TEXT("no samples");
+			}
+			TArray<double> Sorted = Ms;
+			Sorted.Sort();
+			double Sum = 0.0;
+			for (double Value : Sorted)
+			{
+				Sum += Value;
+			}
+			const auto Percentile = [&Sorted](double P) { return Sorted[FMath::Clamp(int32(P * (Sorted.Num() - 1) + 0.5), 0, Sorted.Num() - 1)]; };
+			return FString::Printf(TEXT("n=%d mean %.3f ms, p50 %.3f, p99 %.3f, max %.3f"),
+				Sorted.Num(), Sum / Sorted.Num(), Percentile(0.5), Percentile(0.99), Sorted.Last());
+		}
+	};
+
+	double MsSince(double StartTime)
+	{
+		return (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+
+	void RunRoutingBenchmark(UWorld* World, const FAkMRoutingBenchmarkScale& Scale, FOutputDevice& Ar)
+	{
+		Ar.Logf(TEXT("== %s: %d clients x %d ch, %d Unreal inputs, %d server channels, %.0f us per JACK call"),
+			Scale.Name, Scale.NumClients, Scale.ChannelsPerClient, Scale.NumUnrealInputs, Scale.NumServerChannels, Scale.CallLatencyUs);
+
+		TSharedRef<FAkMMockJackBackend> Mock = MakeShared<FAkMMockJackBackend>(TEXT("akM-bench-unreal"));
+		Mock->AddClient(TEXT("system"), 64, 64);
+		Mock->AddClient(Mock->GetJackClientName(), Scale.NumUnrealInputs, 0);
+
+		UakMJackGraphSubsystem* Graph = NewObject<UakMJackGraphSubsystem>(GetTransientPackage());
+		// Nothing but this benchmark patches the mock, so the graph needs no probing
+		Graph->InitializeWithBackend(Mock, true);
+
+		AakMSpatServerManager* Manager = World->SpawnActorDeferred<AakMSpatServerManager>(AakMSpatServerManager::StaticClass(), FTransform::Identity);
+		if (!Manager)
+		{
+			Ar.Logf(ELogVerbosity::Error, TEXT("Could not spawn a server manager."));
+			return;
+		}
+		Manager->JackGraphOverride = Graph;
+		Manager->bEnableHotStandby = false;
+		Manager->bEnablePatchbay = false;
+		Manager->FinishSpawning(FTransform::Identity);
+		Manager->UnrealJackClientName = Mock->GetJackClientName();
+		const FString ServerName = Manager->ActiveServerJackClientName;
+
+		// JACK client events, as the plugin delivers them: graph first, then the manager
+		Mock->OnClientConnected.AddLambda([Graph, Manager](const FString& ClientName, int32 NumIn, int32 NumOut)
+		{
+			Graph->HandleJackClientConnected(ClientName, NumIn, NumOut);
+			Manager->HandleNewJackClientConnected(ClientName, NumIn, NumOut);
+		});
+		Mock->OnClientDisconnected.AddLambda([Graph, Manager](const FString& ClientName)
+		{
+			Graph->HandleJackClientDisconnected(ClientName);
+			Manager->HandleJackClientDisconnected(ClientName);
+		});
+		Mock->SimulatedCallLatencyUs = Scale.CallLatencyUs;
+
+		// Server appears: scsynth <-> system cleanup plus scsynth -> Unreal block
+		Mock->ResetCounters();
+		double StartTime = FPlatformTime::Seconds();
+		Mock->AddClient(ServerName, Scale.NumServerChannels, Scale.NumServerChannels);
+		Ar.Logf(TEXT("server connect: %.3f ms, %lld connection queries, %lld connect / %lld disconnect calls, %d connections"),
+			MsSince(StartTime), Mock->NumConnectionQueries, Mock->NumConnectCalls, Mock->NumDisconnectCalls, Mock->GetNumConnections());
+
+		// Clients appear and are accepted one by one
+		TArray<FString> ClientNames;
+		FAkMLatencySamples AppearSamples, AcceptSamples;
+		Mock->ResetCounters();
+		for (int32 i = 0; i < Scale.NumClients; ++i)
+		{
+			const FString& ClientName = ClientNames.Add_GetRef(FString::Printf(TEXT("bench_client_%03d"), i));
+			StartTime = FPlatformTime::Seconds();
+			Mock->AddClient(ClientName, 0, Scale.ChannelsPerClient);
+			AppearSamples.Ms.Add(MsSince(StartTime));
+
+			StartTime = FPlatformTime::Seconds();
+			Manager->AcceptExternalClient(ClientName, 0, Scale.ChannelsPerClient);
+			AcceptSamples.Ms.Add(MsSince(StartTime));
+		}
+		Ar.Logf(TEXT("client appear: %s"), *AppearSamples.ToString());
+		Ar.Logf(TEXT("client accept: %s"), *AcceptSamples.ToString());
+		Ar.Logf(TEXT("  %lld connect calls, %lld port queries, %d connections, %d Unreal inputs free"),
+			Mock->NumConnectCalls, Mock->NumPortQueries, Mock->GetNumConnections(), Manager->UnrealInputAllocator.GetNumFree());
+
+		// Accepting an already wired client must not reach JACK
+		if (ClientNames.Num() > 0)
+		{
+			Mock->ResetCounters();
+			StartTime = FPlatformTime::Seconds();
+			Manager->AcceptExternalClient(ClientNames[0], 0, Scale.ChannelsPerClient);
+			Ar.Logf(TEXT("re-accept: %.3f ms, %lld JACK calls"), MsSince(StartTime), Mock->NumConnectCalls + Mock->NumDisconnectCalls);
+		}
+
+		// Half of the clients leave
+		FAkMLatencySamples LeaveSamples;
+		for (int32 i = 0; i < ClientNames.Num(); i += 2)
+		{
+			StartTime = FPlatformTime::Seconds();
+			Mock->RemoveClient(ClientNames[i]);
+			LeaveSamples.Ms.Add(MsSince(StartTime));
+		}
+		Ar.Logf(TEXT("client leave: %s"), *LeaveSamples.ToString());
+
+		// Teardown; a blind sweep over every port pair touching the Unreal client would cost SweepCalls
+		int64 SweepCalls = 0;
+		for (const FString& ClientName : Mock->GetConnectedClients())
+		{
+			int32 NumIn = 0, NumOut = 0;
+			Graph->GetPortCounts(ClientName, NumIn, NumOut);
+			SweepCalls += int64(NumOut) * Scale.NumUnrealInputs;
+		}
+		Mock->ResetCounters();
+		StartTime = FPlatformTime::Seconds();
+		Manager->DisconnectAllConnectionsToUnreal();
+		Ar.Logf(TEXT("disconnect all: %.3f ms, %lld disconnect calls (blind sweep: %lld)"), MsSince(StartTime), Mock->NumDisconnectCalls, SweepCalls);
+
+		Mock->OnClientConnected.Clear();
+		Mock->OnClientDisconnected.Clear();
+		Manager->Destroy();
+	}
+
+	void BenchmarkRoutingCommand(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (!World || !World->HasBegunPlay())
+		{
+			Ar.Logf(ELogVerbosity::Warning, TEXT("akM.Jack.BenchmarkRouting needs a running game world."));
+			return;
+		}
+
+		TArray<FAkMRoutingBenchmarkScale> Scales;
+		if (Args.Num() >= 4)
+		{
+			Scales.Add({ TEXT("custom"), FCString::Atoi(*Args[0]), FCString::Atoi(*Args[1]), FCString::Atoi(*Args[2]), FCString::Atoi(*Args[3]),
+				Args.IsValidIndex(4) ? FCString::Atof(*Args[4]) : 0.0f });
+		}
+		else
+		{
+			Scales.Add({ TEXT("realistic"), 8, 8, 256, 64, 20.0f });
+			Scales.Add({ TEXT("extreme"), 500, 4, 4096, 128, 20.0f });
+			Scales.Add({ TEXT("extreme, no JACK latency"), 500, 4, 4096, 128, 0.0f });
+		}
+
+		// Per-operation logs would dominate the timings
+		const ELogVerbosity::Type SpatVerbosity = LogSpatServer.GetVerbosity();
+		const ELogVerbosity::Type GraphVerbosity = LogAkMJackGraph.GetVerbosity();
+		LogSpatServer.SetVerbosity(ELogVerbosity::Warning);
+		LogAkMJackGraph.SetVerbosity(ELogVerbosity::Warning);
+		for (const FAkMRoutingBenchmarkScale& Scale : Scales)
+		{
+			RunRoutingBenchmark(World, Scale, Ar);
+		}
+		LogSpatServer.SetVerbosity(SpatVerbosity);
+		LogAkMJackGraph.SetVerbosity(GraphVerbosity);
+	}
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice BenchmarkRoutingCmd(
+		TEXT("akM.Jack.BenchmarkRouting"),
+		TEXT("Benchmark JACK routing against a mock server. Args: [NumClients ChannelsPerClient UnrealInputs ServerChannels [CallLatencyUs]]; none runs the realistic and extreme presets."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&BenchmarkRoutingCommand));
+}
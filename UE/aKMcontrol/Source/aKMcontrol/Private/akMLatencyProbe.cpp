@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMLatencyProbe.h"
+#include "Async/ParallelFor.h"
+
+FAkMLatencyProbe::FAkMLatencyProbe()
+{
+	// Fibonacci LFSR x^14 + x^5 + x^3 + x + 1 (maximal length)
+	Mls.SetNumUninitialized(MlsLength);
+	uint32 Register = 1;
+	for (int32 i = 0; i < MlsLength; ++i)
+	{
+		const uint32 Feedback = ((Register >> 13) ^ (Register >> 4) ^ (Register >> 2) ^ Register) & 1u;
+		Register = ((Register << 1) | Feedback) & ((1u << MlsOrder) - 1);
+		Mls[i] = Feedback ? 1.0f : -1.0f;
+	}
+
+	// Linear correlation over every lag up to MaxLatencySamples without wrap-around
+	FFT = MakeUnique<FAkMFFT>(CaptureLength + MlsLength);
+	const int32 FFTSize = FFT->GetSize();
+	MlsSpectrumReal.SetNumZeroed(FFTSize);
+	MlsSpectrumImag.SetNumZeroed(FFTSize);
+	FMemory::Memcpy(MlsSpectrumReal.GetData(), Mls.GetData(), MlsLength * sizeof(float));
+	FFT->Forward(MlsSpectrumReal.GetData(), MlsSpectrumImag.GetData());
+}
+
+FAkMLatencyProbe::~FAkMLatencyProbe()
+{
+	AnalysisTask.Wait();
+}
+
+bool FAkMLatencyProbe::Start(int32 OutputChannel, TConstArrayView<int32> InputChannels, float LevelDb)
+{
+	if (IsBusy() || OutputChannel < 0 || InputChannels.IsEmpty())
+	{
+		return false;
+	}
+	// Allocated once, at full size: after a Cancel the audio thread may still finish writing its current block
+	if (Captures.IsEmpty())
+	{
+		Captures.SetNumUninitialized(MaxInputs * CaptureLength);
+	}
+	ProbeChannel = OutputChannel;
+	NumCaptureChannels = FMath::Min(InputChannels.Num(), MaxInputs);
+	FMemory::Memcpy(CaptureChannels, InputChannels.GetData(), NumCaptureChannels * sizeof(int32));
+	FMemory::Memzero(Captures.GetData(), NumCaptureChannels * CaptureLength * sizeof(float));
+	ProbeGain = FMath::Pow(10.0f, FMath::Min(LevelDb, 0.0f) / 20.0f);
+	StartTime = FPlatformTime::Seconds();
+	State.store(EAkMLatencyProbeState::Armed, std::memory_order_release);
+	return true;
+}
+
+void FAkMLatencyProbe::Cancel()
+{
+	EAkMLatencyProbeState Expected = EAkMLatencyProbeState::Armed;
+	if (!State.compare_exchange_strong(Expected, EAkMLatencyProbeState::Idle))
+	{
+		Expected = EAkMLatencyProbeState::Running;
+		State.compare_exchange_strong(Expected, EAkMLatencyProbeState::Idle);
+	}
+}
+
+bool FAkMLatencyProbe::Tick()
+{
+	switch (GetState())
+	{
+	case EAkMLatencyProbeState::Armed:
+	case EAkMLatencyProbeState::Running:
+		if (FPlatformTime::Seconds() - StartTime > TimeoutSeconds)
+		{
+			Cancel();
+		}
+		return false;
+
+	case EAkMLatencyProbeState::Captured:
+		State.store(EAkMLatencyProbeState::Analyzing, std::memory_order_relaxed);
+		AnalysisTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this] { Analyze(); });
+		return false;
+
+	case EAkMLatencyProbeState::Analyzing:
+		if (!AnalysisTask.IsCompleted())
+		{
+			return false;
+		}
+		Results = MoveTemp(PendingResults);
+		PendingResults.Reset();
+		ResultSampleRate = StreamSampleRate.load(std::memory_order_relaxed);
+		State.store(EAkMLatencyProbeState::Idle, std::memory_order_release);
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+void FAkMLatencyProbe::RenderOutput(float* const* OutputData, int32 NumChannels, int32 NumFrames, uint64 FrameCounter, int32 SampleRate)
+{
+	EAkMLatencyProbeState Current = State.load(std::memory_order_acquire);
+	if (Current == EAkMLatencyProbeState::Armed)
+	{
+		EmitFrame.store(FrameCounter, std::memory_order_relaxed);
+		EmitPosition = 0;
+		StreamSampleRate.store(SampleRate, std::memory_order_relaxed);
+		// Lost to a concurrent Cancel: leave it idle
+		if (!State.compare_exchange_strong(Current, EAkMLatencyProbeState::Running, std::memory_order_acq_rel))
+		{
+			return;
+		}
+		Current = EAkMLatencyProbeState::Running;
+	}
+	if (Current != EAkMLatencyProbeState::Running || EmitPosition >= MlsLength || ProbeChannel >= NumChannels || !OutputData[ProbeChannel])
+	{
+		return;
+	}
+	float* Out = OutputData[ProbeChannel];
+	const int32 Count = FMath::Min(NumFrames, MlsLength - EmitPosition);
+	for (int32 i = 0; i < Count; ++i)
+	{
+		Out[i] += Mls[EmitPosition + i] * ProbeGain;
+	}
+	EmitPosition += Count;
+}
+
+bool FAkMLatencyProbe::BeginCapture(int32 NumFrames, uint64 FrameCounter, int32& OutStart, int32& OutEnd, int64& OutOffset) const
+{
+	if (State.load(std::memory_order_acquire) != EAkMLatencyProbeState::Running)
+	{
+		return false;
+	}
+	// Position of this block relative to the marker's first frame
+	OutOffset = int64(FrameCounter) - int64(EmitFrame.load(std::memory_order_relaxed));
+	OutStart = int32(FMath::Clamp<int64>(-OutOffset, 0, NumFrames));
+	OutEnd = int32(FMath::Clamp<int64>(CaptureLength - OutOffset, 0, NumFrames));
+	return true;
+}
+
+void FAkMLatencyProbe::EndCapture(int32 NumFrames, int64 Offset)
+{
+	if (Offset + NumFrames >= CaptureLength)
+	{
+		EAkMLatencyProbeState Expected = EAkMLatencyProbeState::Running;
+		State.compare_exchange_strong(Expected, EAkMLatencyProbeState::Captured, std::memory_order_acq_rel);
+	}
+}
+
+void FAkMLatencyProbe::CapturePlanar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, uint64 FrameCounter)
+{
+	int32 Start, End;
+	int64 Offset;
+	if (!BeginCapture(NumFrames, FrameCounter, Start, End, Offset))
+	{
+		return;
+	}
+	for (int32 c = 0; c < NumCaptureChannels && End > Start; ++c)
+	{
+		const int32 Channel = CaptureChannels[c];
+		if (Channel >= 0 && Channel < NumChannels && ChannelData[Channel])
+		{
+			FMemory::Memcpy(Captures.GetData() + c * CaptureLength + Offset + Start, ChannelData[Channel] + Start, (End - Start) * sizeof(float));
+		}
+	}
+	EndCapture(NumFrames, Offset);
+}
+
+void FAkMLatencyProbe::CaptureInterleaved(const float* Samples, int32 NumChannels, int32 NumFrames, uint64 FrameCounter)
+{
+	int32 Start, End;
+	int64 Offset;
+	if (!BeginCapture(NumFrames, FrameCounter, Start, End, Offset))
+	{
+		return;
+	}
+	for (int32 c = 0; c < NumCaptureChannels; ++c)
+	{
+		const int32 Channel = CaptureChannels[c];
+		if (Channel >= 0 && Channel < NumChannels)
+		{
+			float* Capture = Captures.GetData() + c * CaptureLength + Offset;
+			for (int32 i = Start; i < End; ++i)
+			{
+				Capture[i] = Samples[i * NumChannels + Channel];
+			}
+		}
+	}
+	EndCapture(NumFrames, Offset);
+}
+
+void FAkMLatencyProbe::Analyze()
+{
+	const int32 FFTSize = FFT->GetSize();
+	PendingResults.SetNum(NumCaptureChannels);
+	ParallelFor(NumCaptureChannels, [this, FFTSize](int32 c)
+	{
+		TArray<float> Real;
+		TArray<float> Imag;
+		Real.SetNumZeroed(FFTSize);
+		Imag.SetNumZeroed(FFTSize);
+		FMemory::Memcpy(Real.GetData(), Captures.GetData() + c * CaptureLength, CaptureLength * sizeof(float));
+		FFT->Forward(Real.GetData(), Imag.GetData());
+
+		// Cross-correlation: capture spectrum times the conjugate of the sequence's
+		for (int32 k = 0; k < FFTSize; ++k)
+		{
+			const float Re = Real[k] * MlsSpectrumReal[k] + Imag[k] * MlsSpectrumImag[k];
+			const float Im = Imag[k] * MlsSpectrumReal[k] - Real[k] * MlsSpectrumImag[k];
+			Real[k] = Re;
+			Imag[k] = Im;
+		}
+		FFT->Inverse(Real.GetData(), Imag.GetData());
+
+		int32 PeakLag = 0;
+		double SumSquares = 0.0;
+		for (int32 Lag = 0; Lag <= MaxLatencySamples; ++Lag)
+		{
+			SumSquares += double(Real[Lag]) * Real[Lag];
+			if (FMath::Abs(Real[Lag]) > FMath::Abs(Real[PeakLag]))
+			{
+				PeakLag = Lag;
+			}
+		}
+		const double Peak = FMath::Abs(Real[PeakLag]);
+		const double NoiseRms = FMath::Sqrt(FMath::Max(SumSquares - Peak * Peak, 0.0) / MaxLatencySamples);
+
+		FAkMLatencyResult& Result = PendingResults[c];
+		Result.Channel = CaptureChannels[c];
+		Result.PeakToNoiseDb = float(20.0 * FMath::LogX(10.0, FMath::Max(Peak, 1e-20) / FMath::Max(NoiseRms, 1e-20)));
+		Result.LatencySamples = Result.PeakToNoiseDb >= DetectionThresholdDb ? PeakLag : INDEX_NONE;
+	});
+}
@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMLevelHistory.h"
+
+namespace
+{
+	// Levels stop once they would hold fewer entries than this
+	constexpr int32 MinLevelCapacity = 64;
+
+	FAkMLevelRange Merge(FAkMLevelRange A, FAkMLevelRange B)
+	{
+		return { FMath::Min(A.Min, B.Min), FMath::Max(A.Max, B.Max) };
+	}
+}
+
+void FAkMLevelHistory::Configure(int32 InNumChannels, double InBlockSeconds, double HistorySeconds, SIZE_T MaxBytes)
+{
+	if (InNumChannels == NumChannels && InBlockSeconds == BlockSeconds && HistorySeconds == ConfiguredSeconds && MaxBytes == ConfiguredMaxBytes)
+	{
+		return;
+	}
+	NumChannels = FMath::Max(0, InNumChannels);
+	BlockSeconds = InBlockSeconds;
+	ConfiguredSeconds = HistorySeconds;
+	ConfiguredMaxBytes = MaxBytes;
+	NumBlocks = 0;
+	SpanSeconds = 0.0;
+
+	// The old buffers are freed on the task too; a superseded pending allocation simply goes unused
+	TArray<FLevel> OldLevels = MoveTemp(Levels);
+	PendingLevels = {};
+	if (NumChannels == 0 || BlockSeconds <= 0.0 || HistorySeconds <= 0.0)
+	{
+		return;
+	}
+
+	// The pyramid adds a third to the base level
+	const double BytesPerBaseEntry = NumChannels * sizeof(FAkMLevelRange) * 4.0 / 3.0;
+	const double MaxBaseEntries = FMath::Min(double(MAX_int32) / NumChannels, MaxBytes / BytesPerBaseEntry);
+	const int32 BaseCapacity = FMath::Max(MinLevelCapacity, int32(FMath::Min(FMath::CeilToDouble(HistorySeconds / BlockSeconds), MaxBaseEntries)));
+	SpanSeconds = BaseCapacity * BlockSeconds;
+	PendingLevels = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Channels = NumChannels, BaseCapacity, OldLevels = MoveTemp(OldLevels)]() mutable
+	{
+		OldLevels.Empty();
+		return AllocateLevels(Channels, BaseCapacity);
+	});
+}
+
+TArray<FAkMLevelHistory::FLevel> FAkMLevelHistory::AllocateLevels(int32 InNumChannels, int32 BaseCapacity)
+{
+	TArray<FLevel> NewLevels;
+	for (int32 Shift = 0; Shift == 0 || (BaseCapacity >> Shift) >= MinLevelCapacity; Shift += 2)
+	{
+		// Two spare entries so a level spans its oldest partial group as well
+		FLevel& Level = NewLevels.AddDefaulted_GetRef();
+		Level.Capacity = Shift == 0 ? BaseCapacity : (BaseCapacity >> Shift) + 2;
+		Level.Entries.SetNumZeroed(InNumChannels * Level.Capacity);
+	}
+	return NewLevels;
+}
+
+void FAkMLevelHistory::AddBlock(const FAkMLevelRange* Ranges)
+{
+	if (PendingLevels.IsValid() && PendingLevels.IsCompleted())
+	{
+		Levels = MoveTemp(PendingLevels.GetResult());
+		PendingLevels = {};
+	}
+	if (Levels.IsEmpty())
+	{
+		return;
+	}
+
+	FLevel& Base = Levels[0];
+	const int32 BaseSlot = int32(Base.NumEntries % Base.Capacity);
+	for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+	{
+		Base.Entries[Channel * Base.Capacity + BaseSlot] = Ranges[Channel];
+	}
+	++Base.NumEntries;
+	++NumBlocks;
+
+	// Each completed group of four entries becomes one entry of the next level
+	for (int32 k = 1; k < Levels.Num() && Levels[k - 1].NumEntries % 4 == 0; ++k)
+	{
+		const FLevel& Finer = Levels[k - 1];
+		FLevel& Coarser = Levels[k];
+		const int64 First = Finer.NumEntries - 4;
+		const int32 Slot = int32(Coarser.NumEntries % Coarser.Capacity);
+		for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+		{
+			const FAkMLevelRange* Source = Finer.Entries.GetData() + Channel * Finer.Capacity;
+			FAkMLevelRange Range = Source[First % Finer.Capacity];
+			for (int64 i = First + 1; i < Finer.NumEntries; ++i)
+			{
+				Range = Merge(Range, Source[i % Finer.Capacity]);
+			}
+			Coarser.Entries[Channel * Coarser.Capacity + Slot] = Range;
+		}
+		++Coarser.NumEntries;
+	}
+}
+
+double FAkMLevelHistory::GetDurationSeconds() const
+{
+	return Levels.IsEmpty() ? 0.0 : FMath::Min<int64>(NumBlocks, Levels[0].Capacity) * BlockSeconds;
+}
+
+int32 FAkMLevelHistory::Query(int32 Channel, double StartSeconds, double EndSeconds, int32 NumPoints, float* OutSeconds, float* OutMinDb, float* OutMaxDb) const
+{
+	if (Levels.IsEmpty() || NumBlocks == 0 || NumPoints <= 0 || Channel < 0 || Channel >= NumChannels)
+	{
+		return 0;
+	}
+
+	const double OldestBlock = double(FMath::Max<int64>(0, NumBlocks - Levels[0].Capacity));
+	const double StartBlock = FMath::Max(OldestBlock, NumBlocks + StartSeconds / BlockSeconds);
+	const double EndBlock = FMath::Min(double(NumBlocks), NumBlocks + EndSeconds / BlockSeconds);
+	if (EndBlock <= StartBlock)
+	{
+		return 0;
+	}
+
+	// Coarsest level whose entries are no wider than one point
+	const double BlocksPerPoint = (EndBlock - StartBlock) / NumPoints;
+	int32 k = 0;
+	while (k + 1 < Levels.Num() && double(int64(1) << (2 * (k + 1))) <= BlocksPerPoint)
+	{
+		++k;
+	}
+	const FLevel& Level = Levels[k];
+	const double BlocksPerEntry = double(int64(1) << (2 * k));
+	const int64 FirstEntry = FMath::Max<int64>(0, Level.NumEntries - Level.Capacity);
+	const FAkMLevelRange* Entries = Level.Entries.GetData() + Channel * Level.Capacity;
+
+	int32 NumWritten = 0;
+	for (int32 Point = 0; Point < NumPoints; ++Point)
+	{
+		const double PointStart = StartBlock + Point * BlocksPerPoint;
+		const double PointEnd = PointStart + BlocksPerPoint;
+		const int64 EntryStart = FMath::Max(FirstEntry, int64(FMath::FloorToDouble(PointStart / BlocksPerEntry)));
+		const int64 EntryEnd = FMath::Min(Level.NumEntries, FMath::Max(EntryStart + 1, int64(FMath::CeilToDouble(PointEnd / BlocksPerEntry))));
+		if (EntryStart >= EntryEnd)
+		{
+			continue;
+		}
+		FAkMLevelRange Range = Entries[EntryStart % Level.Capacity];
+		for (int64 i = EntryStart + 1; i < EntryEnd; ++i)
+		{
+			Range = Merge(Range, Entries[i % Level.Capacity]);
+		}
+		OutSeconds[NumWritten] = float((0.5 * (PointStart + PointEnd) - NumBlocks) * BlockSeconds);
+		OutMinDb[NumWritten] = FAkMLevelRange::DecodeDb(Range.Min);
+		OutMaxDb[NumWritten] = FAkMLevelRange::DecodeDb(Range.Max);
+		++NumWritten;
+	}
+	return NumWritten;
+}
+
+SIZE_T FAkMLevelHistory::GetAllocatedSize() const
+{
+	SIZE_T Size = Levels.GetAllocatedSize();
+	for (const FLevel& Level : Levels)
+	{
+		Size += Level.Entries.GetAllocatedSize();
+	}
+	return Size;
+}
@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMLevelKernel.h"
+#include "Math/VectorRegister.h"
+
+#if PLATFORM_ALWAYS_HAS_AVX
+#include <immintrin.h>
+#define AKM_LEVEL_KERNEL_AVX 1
+#else
+#define AKM_LEVEL_KERNEL_AVX 0
+#endif
+
+namespace
+{
+	FORCEINLINE void AnalyzeStridedScalar(const float* Samples, int32 Stride, int32 NumFrames, float ClipThreshold, float& OutSumSq, float& OutPeak, uint32& OutClips)
+	{
+		float SumSq = 0.0f;
+		float Peak = 0.0f;
+		uint32 Clips = 0;
+		for (int32 i = 0; i < NumFrames; ++i)
+		{
+			const float Sample = Samples[i * Stride];
+			const float Magnitude = FMath::Abs(Sample);
+			SumSq += Sample * Sample;
+			Peak = FMath::Max(Peak, Magnitude);
+			Clips += Magnitude >= ClipThreshold ? 1u : 0u;
+		}
+		OutSumSq = SumSq;
+		OutPeak = Peak;
+		OutClips = Clips;
+	}
+
+	FORCEINLINE float HorizontalSum(const VectorRegister4Float& Vec)
+	{
+		alignas(16) float Lanes[4];
+		VectorStoreAligned(Vec, Lanes);
+		return (Lanes[0] + Lanes[1]) + (Lanes[2] + Lanes[3]);
+	}
+
+	FORCEINLINE float HorizontalMax(const VectorRegister4Float& Vec)
+	{
+		alignas(16) float Lanes[4];
+		VectorStoreAligned(Vec, Lanes);
+		return FMath::Max(FMath::Max(Lanes[0], Lanes[1]), FMath::Max(Lanes[2], Lanes[3]));
+	}
+
+	// One contiguous channel. Two independent accumulator sets hide the add latency; clips are counted as 1.0f lanes
+	// (exact up to 2^24 samples per block).
+	void AnalyzeChannelVector(const float* Samples, int32 NumFrames, float ClipThreshold, float& OutSumSq, float& OutPeak, uint32& OutClips)
+	{
+		int32 i = 0;
+		float SumSq = 0.0f;
+		float Peak = 0.0f;
+		float Clips = 0.0f;
+
+#if AKM_LEVEL_KERNEL_AVX
+		{
+			const __m256 SignMask = _mm256_set1_ps(-0.0f);
+			const __m256 Threshold = _mm256_set1_ps(ClipThreshold);
+			const __m256 One = _mm256_set1_ps(1.0f);
+			__m256 Sum0 = _mm256_setzero_ps(), Sum1 = _mm256_setzero_ps();
+			__m256 Peak0 = _mm256_setzero_ps(), Peak1 = _mm256_setzero_ps();
+			__m256 ClipAcc = _mm256_setzero_ps();
+			for (; i + 16 <= NumFrames; i += 16)
+			{
+				const __m256 A = _mm256_loadu_ps(Samples + i);
+				const __m256 B = _mm256_loadu_ps(Samples + i + 8);
+				Sum0 = _mm256_add_ps(Sum0, _mm256_mul_ps(A, A));
+				Sum1 = _mm256_add_ps(Sum1, _mm256_mul_ps(B, B));
+				const __m256 AbsA = _mm256_andnot_ps(SignMask, A);
+				const __m256 AbsB = _mm256_andnot_ps(SignMask, B);
+				Peak0 = _mm256_max_ps(Peak0, AbsA);
+				Peak1 = _mm256_max_ps(Peak1, AbsB);
+				ClipAcc = _mm256_add_ps(ClipAcc, _mm256_add_ps(
+					_mm256_and_ps(_mm256_cmp_ps(AbsA, Threshold, _CMP_GE_OQ), One),
+					_mm256_and_ps(_mm256_cmp_ps(AbsB, Threshold, _CMP_GE_OQ), One)));
+			}
+			alignas(32) float Lanes[3][8];
+			_mm256_store_ps(Lanes[0], _mm256_add_ps(Sum0, Sum1));
+			_mm256_store_ps(Lanes[1], _mm256_max_ps(Peak0, Peak1));
+			_mm256_store_ps(Lanes[2], ClipAcc);
+			for (int32 Lane = 0; Lane < 8; ++Lane)
+			{
+				SumSq += Lanes[0][Lane];
+				Peak = FMath::Max(Peak, Lanes[1][Lane]);
+				Clips += Lanes[2][Lane];
+			}
+		}
+#endif
+
+		{
+			const VectorRegister4Float Threshold = VectorSetFloat1(ClipThreshold);
+			const VectorRegister4Float One = VectorOneFloat();
+			VectorRegister4Float Sum0 = VectorZeroFloat(), Sum1 = VectorZeroFloat();
+			VectorRegister4Float Peak0 = VectorZeroFloat(), Peak1 = VectorZeroFloat();
+			VectorRegister4Float ClipAcc = VectorZeroFloat();
+			for (; i + 8 <= NumFrames; i += 8)
+			{
+				const VectorRegister4Float A = VectorLoad(Samples + i);
+				const VectorRegister4Float B = VectorLoad(Samples + i + 4);
+				Sum0 = VectorMultiplyAdd(A, A, Sum0);
+				Sum1 = VectorMultiplyAdd(B, B, Sum1);
+				const VectorRegister4Float AbsA = VectorAbs(A);
+				const VectorRegister4Float AbsB = VectorAbs(B);
+				Peak0 = VectorMax(Peak0, AbsA);
+				Peak1 = VectorMax(Peak1, AbsB);
+				ClipAcc = VectorAdd(ClipAcc, VectorAdd(
+					VectorBitwiseAnd(VectorCompareGE(AbsA, Threshold), One),
+					VectorBitwiseAnd(VectorCompareGE(AbsB, Threshold), One)));
+			}
+			SumSq += HorizontalSum(VectorAdd(Sum0, Sum1));
+			Peak = FMath::Max(Peak, HorizontalMax(VectorMax(Peak0, Peak1)));
+			Clips += HorizontalSum(ClipAcc);
+		}
+
+		float TailSumSq, TailPeak;
+		uint32 TailClips;
+		AnalyzeStridedScalar(Samples + i, 1, NumFrames - i, ClipThreshold, TailSumSq, TailPeak, TailClips);
+		OutSumSq = SumSq + TailSumSq;
+		OutPeak = FMath::Max(Peak, TailPeak);
+		OutClips = uint32(Clips) + TailClips;
+	}
+}
+
+void FAkMLevelKernel::AnalyzePlanar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, float ClipThreshold,
+	float* OutSumSquares, float* OutPeaks, uint32* OutClips)
+{
+	for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+	{
+		if (ChannelData[Channel])
+		{
+			AnalyzeChannelVector(ChannelData[Channel], NumFrames, ClipThreshold, OutSumSquares[Channel], OutPeaks[Channel], OutClips[Channel]);
+		}
+		else
+		{
+			OutSumSquares[Channel] = 0.0f;
+			OutPeaks[Channel] = 0.0f;
+			OutClips[Channel] = 0;
+		}
+	}
+}
+
+void FAkMLevelKernel::AnalyzeInterleaved(const float* Samples, int32 NumChannels, int32 NumFrames, float ClipThreshold,
+	float* OutSumSquares, float* OutPeaks, uint32* OutClips)
+{
+	// Four adjacent channels per register, walking the frames with a stride of NumChannels
+	const VectorRegister4Float Threshold = VectorSetFloat1(ClipThreshold);
+	const VectorRegister4Float One = VectorOneFloat();
+	int32 Channel = 0;
+	for (; Channel + 4 <= NumChannels; Channel += 4)
+	{
+		VectorRegister4Float Sum = VectorZeroFloat();
+		VectorRegister4Float Peak = VectorZeroFloat();
+		VectorRegister4Float ClipAcc = VectorZeroFloat();
+		const float* Frame = Samples + Channel;
+		for (int32 i = 0; i < NumFrames; ++i, Frame += NumChannels)
+		{
+			const VectorRegister4Float Value = VectorLoad(Frame);
+			const VectorRegister4Float Abs = VectorAbs(Value);
+			Sum = VectorMultiplyAdd(Value, Value, Sum);
+			Peak = VectorMax(Peak, Abs);
+			ClipAcc = VectorAdd(ClipAcc, VectorBitwiseAnd(VectorCompareGE(Abs, Threshold), One));
+		}
+		alignas(16) float Clips[4];
+		VectorStore(Sum, OutSumSquares + Channel);
+		VectorStore(Peak, OutPeaks + Channel);
+		VectorStoreAligned(ClipAcc, Clips);
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+		{
+			OutClips[Channel + Lane] = uint32(Clips[Lane]);
+		}
+	}
+	for (; Channel < NumChannels; ++Channel)
+	{
+		AnalyzeStridedScalar(Samples + Channel, NumChannels, NumFrames, ClipThreshold, OutSumSquares[Channel], OutPeaks[Channel], OutClips[Channel]);
+	}
+}
+
+void FAkMLevelKernel::AnalyzePlanarScalar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, float ClipThreshold,
+	float* OutSumSquares, float* OutPeaks, uint32* OutClips)
+{
+	for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+	{
+		if (ChannelData[Channel])
+		{
+			AnalyzeStridedScalar(ChannelData[Channel], 1, NumFrames, ClipThreshold, OutSumSquares[Channel], OutPeaks[Channel], OutClips[Channel]);
+		}
+		else
+		{
+			OutSumSquares[Channel] = 0.0f;
+			OutPeaks[Channel] = 0.0f;
+			OutClips[Channel] = 0;
+		}
+	}
+}
+
+void FAkMLevelKernel::AnalyzeInterleavedScalar(const float* Samples, int32 NumChannels, int32 NumFrames, float ClipThreshold,
+	float* OutSumSquares, float* OutPeaks, uint32* OutClips)
+{
+	for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+	{
+		AnalyzeStridedScalar(Samples + Channel, NumChannels, NumFrames, ClipThreshold, OutSumSquares[Channel], OutPeaks[Channel], OutClips[Channel]);
+	}
+}
+
+const TCHAR* FAkMLevelKernel::GetVectorPathName()
+{
+#if AKM_LEVEL_KERNEL_AVX
+	return TEXT("AVX");
+#elif PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+	return TEXT("NEON");
+#elif PLATFORM_ENABLE_VECTORINTRINSICS
+	return TEXT("SSE");
+#else
+	return TEXT("scalar");
+#endif
+}
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "akMLevelKernel.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+#if PLATFORM_WINDOWS
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// akM.Audio.BenchmarkLevelKernel [Channels] [Frames] [Iterations]: cost of FAkMLevelKernel per sample and channel,
+// vector against scalar, planar and interleaved. Cycles are TSC ticks on x86; other CPUs report nanoseconds only.
+
+namespace
+{
+	uint64 ReadCycleCounter()
+	{
+#if PLATFORM_CPU_X86_FAMILY
+		return __rdtsc();
+#else
+		return 0;
+#endif
+	}
+
+	template<typename FuncType>
+	void MeasureKernel(const TCHAR* Label, int32 NumChannels, int32 NumFrames, int32 NumIterations, FOutputDevice& Ar, FuncType&& Kernel)
+	{
+		Kernel();	// Warm caches
+		const double StartTime = FPlatformTime::Seconds();
+		const uint64 StartCycles = ReadCycleCounter();
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			Kernel();
+		}
+		const uint64 Cycles = ReadCycleCounter() - StartCycles;
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+		const double NumSamples = double(NumChannels) * NumFrames * NumIterations;
+		Ar.Logf(TEXT("  %-22s %7.3f ns  %6.3f cycles per sample per channel  (%.2f us per block)"),
+			Label, Seconds * 1e9 / NumSamples, Cycles / NumSamples, Seconds * 1e6 / NumIterations);
+	}
+
+	void BenchmarkLevelKernelCommand(const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		const int32 NumChannels = FMath::Clamp(Args.IsValidIndex(0) ? FCString::Atoi(*Args[0]) : 256, 1, 4096);
+		const int32 NumFrames = FMath::Clamp(Args.IsValidIndex(1) ? FCString::Atoi(*Args[1]) : 128, 1, 8192);
+		const int32 NumIterations = FMath::Clamp(Args.IsValidIndex(2) ? FCString::Atoi(*Args[2]) : 2000, 1, 1000000);
+
+		// Noise with occasional full-scale samples so the clip path is exercised
+		FRandomStream Random(1234);
+		TArray<float> Interleaved;
+		Interleaved.SetNumUninitialized(NumChannels * NumFrames);
+		for (float& Sample : Interleaved)
+		{
+			Sample = Random.FRand() < 0.001f ? 1.0f : Random.FRandRange(-0.5f, 0.5f);
+		}
+		TArray<float> Planar;
+		Planar.SetNumUninitialized(NumChannels * NumFrames);
+		TArray<const float*> ChannelData;
+		for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+		{
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				Planar[Channel * NumFrames + Frame] = Interleaved[Frame * NumChannels + Channel];
+			}
+			ChannelData.Add(Planar.GetData() + Channel * NumFrames);
+		}
+
+		TArray<float> SumSquares, Peaks, ReferenceSumSquares, ReferencePeaks;
+		TArray<uint32> Clips, ReferenceClips;
+		SumSquares.SetNumZeroed(NumChannels);
+		Peaks.SetNumZeroed(NumChannels);
+		Clips.SetNumZeroed(NumChannels);
+		ReferenceSumSquares.SetNumZeroed(NumChannels);
+		ReferencePeaks.SetNumZeroed(NumChannels);
+		ReferenceClips.SetNumZeroed(NumChannels);
+		const float Threshold = 0.999f;
+
+		// Both vector paths must agree with the scalar reference before timing means anything
+		FAkMLevelKernel::AnalyzePlanarScalar(ChannelData.GetData(), NumChannels, NumFrames, Threshold, ReferenceSumSquares.GetData(), ReferencePeaks.GetData(), ReferenceClips.GetData());
+		const auto CheckAgainstReference = [&](const TCHAR* Label)
+		{
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				if (!FMath::IsNearlyEqual(SumSquares[Channel], ReferenceSumSquares[Channel], 1e-3f * FMath::Max(1.0f, ReferenceSumSquares[Channel]))
+					|| Peaks[Channel] != ReferencePeaks[Channel] || Clips[Channel] != ReferenceClips[Channel])
+				{
+					Ar.Logf(ELogVerbosity::Error, TEXT("%s differs from the scalar kernel on channel %d."), Label, Channel);
+					return;
+				}
+			}
+		};
+		FAkMLevelKernel::AnalyzePlanar(ChannelData.GetData(), NumChannels, NumFrames, Threshold, SumSquares.GetData(), Peaks.GetData(), Clips.GetData());
+		CheckAgainstReference(TEXT("Planar vector path"));
+		FAkMLevelKernel::AnalyzeInterleaved(Interleaved.GetData(), NumChannels, NumFrames, Threshold, SumSquares.GetData(), Peaks.GetData(), Clips.GetData());
+		CheckAgainstReference(TEXT("Interleaved vector path"));
+
+		Ar.Logf(TEXT("Level kernel: %d channels x %d frames, %d iterations, vector path %s"), NumChannels, NumFrames, NumIterations, FAkMLevelKernel::GetVectorPathName());
+		MeasureKernel(TEXT("planar scalar"), NumChannels, NumFrames, NumIterations, Ar, [&]()
+		{
+			FAkMLevelKernel::AnalyzePlanarScalar(ChannelData.GetData(), NumChannels, NumFrames, Threshold, SumSquares.GetData(), Peaks.GetData(), Clips.GetData());
+		});
+		MeasureKernel(TEXT("planar vector"), NumChannels, NumFrames, NumIterations, Ar, [&]()
+		{
+			FAkMLevelKernel::AnalyzePlanar(ChannelData.GetData(), NumChannels, NumFrames, Threshold, SumSquares.GetData(), Peaks.GetData(), Clips.GetData());
+		});
+		MeasureKernel(TEXT("interleaved scalar"), NumChannels, NumFrames, NumIterations, Ar, [&]()
+		{
+			FAkMLevelKernel::AnalyzeInterleavedScalar(Interleaved.GetData(), NumChannels, NumFrames, Threshold, SumSquares.GetData(), Peaks.GetData(), Clips.GetData());
+		});
+		MeasureKernel(TEXT("interleaved vector"), NumChannels, NumFrames, NumIterations, Ar, [&]()
+		{
+			FAkMLevelKernel::AnalyzeInterleaved(Interleaved.GetData(), NumChannels, NumFrames, Threshold, SumSquares.GetData(), Peaks.GetData(), Clips.GetData());
+		});
+	}
+
+	FAutoConsoleCommandWithArgsAndOutputDevice BenchmarkLevelKernelCmd(
+		TEXT("akM.Audio.BenchmarkLevelKernel"),
+		TEXT("Time the level meter kernel (vector vs scalar). Args: [Channels=256] [Frames=128] [Iterations=2000]"),
+		FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateStatic(&BenchmarkLevelKernelCommand));
+}
@@ -0,0 +1,300 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMLoudnessMeter.h"
+
+namespace
+{
+	float EnergyToLufs(double Energy)
+	{
+		return Energy > 0.0 ? FMath::Max(FAkMLoudness::MinLufs, float(-0.691 + 10.0 * FMath::LogX(10.0, Energy))) : FAkMLoudness::MinLufs;
+	}
+}
+
+void FAkMLoudnessMeter::FGroupState::Reset(bool bIntegratedOnly)
+{
+	FMemory::Memzero(BinCounts.GetData(), BinCounts.Num() * sizeof(uint32));
+	FMemory::Memzero(BinEnergy.GetData(), BinEnergy.Num() * sizeof(double));
+	Loudness.IntegratedLufs = FAkMLoudness::MinLufs;
+	if (!bIntegratedOnly)
+	{
+		FMemory::Memzero(StepEnergy, sizeof(StepEnergy));
+		NumSteps = 0;
+		Loudness = FAkMLoudness();
+	}
+}
+
+void FAkMLoudnessMeter::FGroupState::CloseStep(double Energy)
+{
+	StepEnergy[NumSteps % StepsPerShortTerm] = Energy;
+	++NumSteps;
+
+	const auto AverageOfLastSteps = [this](int32 Count)
+	{
+		double Sum = 0.0;
+		for (int32 i = 1; i <= Count; ++i)
+		{
+			Sum += StepEnergy[(NumSteps - i) % StepsPerShortTerm];
+		}
+		return Sum / Count;
+	};
+	Loudness.ShortTermLufs = EnergyToLufs(AverageOfLastSteps(FMath::Min(NumSteps, StepsPerShortTerm)));
+	if (NumSteps < StepsPerMomentary)
+	{
+		return;
+	}
+
+	// Every step closes a 400 ms gating block (75 % overlap)
+	const double BlockEnergy = AverageOfLastSteps(StepsPerMomentary);
+	Loudness.MomentaryLufs = EnergyToLufs(BlockEnergy);
+	if (BlockEnergy <= 0.0)
+	{
+		return;
+	}
+	const double BlockLufs = -0.691 + 10.0 * FMath::LogX(10.0, BlockEnergy);
+	if (BlockLufs <= FAkMLoudness::MinLufs)
+	{
+		return;
+	}
+	const int32 Bin = FMath::Clamp(int32((BlockLufs - FAkMLoudness::MinLufs) * 10.0), 0, NumHistogramBins - 1);
+	++BinCounts[Bin];
+	BinEnergy[Bin] += BlockEnergy;
+
+	// Relative gate 10 LU below the loudness of the blocks above the absolute gate, at bin resolution
+	uint64 TotalCount = 0;
+	double TotalEnergy = 0.0;
+	for (int32 i = 0; i < NumHistogramBins; ++i)
+	{
+		TotalCount += BinCounts[i];
+		TotalEnergy += BinEnergy[i];
+	}
+	const double RelativeGate = -0.691 + 10.0 * FMath::LogX(10.0, TotalEnergy / TotalCount) - 10.0;
+	const int32 FirstBin = FMath::Clamp(int32((RelativeGate - FAkMLoudness::MinLufs) * 10.0), 0, NumHistogramBins - 1);
+	uint64 GatedCount = 0;
+	double GatedEnergy = 0.0;
+	for (int32 i = FirstBin; i < NumHistogramBins; ++i)
+	{
+		GatedCount += BinCounts[i];
+		GatedEnergy += BinEnergy[i];
+	}
+	Loudness.IntegratedLufs = GatedCount > 0 ? EnergyToLufs(GatedEnergy / GatedCount) : FAkMLoudness::MinLufs;
+}
+
+FAkMLoudnessMeter::FAkMLoudnessMeter()
+{
+	Channels.SetNum(MaxChannels);
+	Groups.SetNum(MaxGroups);
+	for (FGroupState& Group : Groups)
+	{
+		Group.BinCounts.SetNumZeroed(NumHistogramBins);
+		Group.BinEnergy.SetNumZeroed(NumHistogramBins);
+	}
+	Master.BinCounts.SetNumZeroed(NumHistogramBins);
+	Master.BinEnergy.SetNumZeroed(NumHistogramBins);
+	GroupStepEnergy.SetNumZeroed(MaxGroups);
+
+	// Writers refill these in place, so neither thread allocates after this
+	Layouts.ForEachBuffer([](FAkMLoudnessLayout& Layout)
+	{
+		Layout.GroupOfChannel.Init(INDEX_NONE, MaxChannels);
+		Layout.GroupInMaster.Init(false, MaxGroups);
+	});
+}
+
+void FAkMLoudnessMeter::SetLayout(const TArray<TArray<int32>>& ChannelsByGroup, const TArray<bool>& GroupInMaster)
+{
+	FAkMLoudnessLayout& Layout = Layouts.GetWriteBuffer();
+	Layout.GroupOfChannel.Init(INDEX_NONE, MaxChannels);
+	Layout.GroupInMaster.Init(false, MaxGroups);
+	Layout.NumGroups = FMath::Min(ChannelsByGroup.Num(), MaxGroups);
+	for (int32 Group = 0; Group < Layout.NumGroups; ++Group)
+	{
+		for (const int32 Channel : ChannelsByGroup[Group])
+		{
+			if (Layout.GroupOfChannel.IsValidIndex(Channel))
+			{
+				Layout.GroupOfChannel[Channel] = Group;
+			}
+		}
+		Layout.GroupInMaster[Group] = GroupInMaster.IsValidIndex(Group) ? GroupInMaster[Group] : true;
+	}
+	Layout.Version = NextLayoutVersion++;
+	Layouts.Publish();
+}
+
+void FAkMLoudnessMeter::ProcessPlanar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, int32 SampleRate)
+{
+	Process(NumChannels, NumFrames, SampleRate, [ChannelData](int32 Channel, int32 Offset, int32& OutStride) -> const float*
+	{
+		OutStride = 1;
+		return ChannelData[Channel] ? ChannelData[Channel] + Offset : nullptr;
+	});
+}
+
+void FAkMLoudnessMeter::ProcessInterleaved(const float* Samples, int32 NumChannels, int32 NumFrames, int32 SampleRate)
+{
+	Process(NumChannels, NumFrames, SampleRate, [Samples, NumChannels](int32 Channel, int32 Offset, int32& OutStride) -> const float*
+	{
+		OutStride = NumChannels;
+		return Samples + Offset * NumChannels + Channel;
+	});
+}
+
+template<typename SampleAccessorType>
+void FAkMLoudnessMeter::Process(int32 NumChannels, int32 NumFrames, int32 SampleRate, SampleAccessorType&& GetChannel)
+{
+	if (Layouts.Update())
+	{
+		FilterSampleRate = 0;	// New grouping: start every measurement over
+	}
+	const FAkMLoudnessLayout& Layout = Layouts.Read();
+	if (Layout.NumGroups == 0 || SampleRate <= 0 || NumFrames <= 0)
+	{
+		return;
+	}
+	if (SampleRate != FilterSampleRate)
+	{
+		UpdateFilters(SampleRate);
+	}
+	if (bResetRequested.exchange(false, std::memory_order_relaxed))
+	{
+		for (int32 Group = 0; Group < Layout.NumGroups; ++Group)
+		{
+			Groups[Group].Reset(true);
+		}
+		Master.Reset(true);
+	}
+
+	NumChannels = FMath::Min(NumChannels, MaxChannels);
+	const FBiquad S = Shelf;
+	const FBiquad H = HighPass;
+	int32 Offset = 0;
+	while (Offset < NumFrames)
+	{
+		// Split the block at 100 ms step boundaries
+		const int32 Count = FMath::Min(NumFrames - Offset, StepFrames - StepPosition);
+		for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+		{
+			if (Layout.GroupOfChannel[Channel] == INDEX_NONE)
+			{
+				continue;
+			}
+			int32 Stride = 1;
+			const float* Samples = GetChannel(Channel, Offset, Stride);
+			if (!Samples)
+			{
+				continue;
+			}
+
+			FChannelState& State = Channels[Channel];
+			double Z0 = State.Z[0], Z1 = State.Z[1], Z2 = State.Z[2], Z3 = State.Z[3];
+			double Sum = 0.0;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				const double X = Samples[i * Stride];
+				const double Y1 = S.B0 * X + Z0;
+				Z0 = S.B1 * X - S.A1 * Y1 + Z1;
+				Z1 = S.B2 * X - S.A2 * Y1;
+				const double Y2 = H.B0 * Y1 + Z2;
+				Z2 = H.B1 * Y1 - H.A1 * Y2 + Z3;
+				Z3 = H.B2 * Y1 - H.A2 * Y2;
+				Sum += Y2 * Y2;
+			}
+			// Flush decaying state before it turns denormal on silence
+			State.Z[0] = FMath::Abs(Z0) < 1e-30 ? 0.0 : Z0;
+			State.Z[1] = FMath::Abs(Z1) < 1e-30 ? 0.0 : Z1;
+			State.Z[2] = FMath::Abs(Z2) < 1e-30 ? 0.0 : Z2;
+			State.Z[3] = FMath::Abs(Z3) < 1e-30 ? 0.0 : Z3;
+			State.SumSquares += Sum;
+		}
+
+		Offset += Count;
+		StepPosition += Count;
+		if (StepPosition >= StepFrames)
+		{
+			CloseStep();
+			StepPosition = 0;
+		}
+	}
+}
+
+void FAkMLoudnessMeter::UpdateFilters(int32 SampleRate)
+{
+	// BS.1770 pre-filter for any sample rate (stage 1 high shelf, stage 2 RLB high-pass); matches the 48 kHz table
+	{
+		const double F0 = 1681.974450955533;
+		const double GainDb = 3.999843853973347;
+		const double Q = 0.7071752369554196;
+		const double K = FMath::Tan(PI * F0 / SampleRate);
+		const double Vh = FMath::Pow(10.0, GainDb / 20.0);
+		const double Vb = FMath::Pow(Vh, 0.4996667741545416);
+		const double A0 = 1.0 + K / Q + K * K;
+		Shelf.B0 = (Vh + Vb * K / Q + K * K) / A0;
+		Shelf.B1 = 2.0 * (K * K - Vh) / A0;
+		Shelf.B2 = (Vh - Vb * K / Q + K * K) / A0;
+		Shelf.A1 = 2.0 * (K * K - 1.0) / A0;
+		Shelf.A2 = (1.0 - K / Q + K * K) / A0;
+	}
+	{
+		const double F0 = 38.13547087602444;
+		const double Q = 0.5003270373238773;
+		const double K = FMath::Tan(PI * F0 / SampleRate);
+		const double A0 = 1.0 + K / Q + K * K;
+		HighPass.B0 = 1.0;
+		HighPass.B1 = -2.0;
+		HighPass.B2 = 1.0;
+		HighPass.A1 = 2.0 * (K * K - 1.0) / A0;
+		HighPass.A2 = (1.0 - K / Q + K * K) / A0;
+	}
+
+	FilterSampleRate = SampleRate;
+	StepFrames = FMath::Max(1, SampleRate / 10);
+	StepPosition = 0;
+	for (FChannelState& Channel : Channels)
+	{
+		Channel = FChannelState();
+	}
+	for (FGroupState& Group : Groups)
+	{
+		Group.Reset(false);
+	}
+	Master.Reset(false);
+}
+
+void FAkMLoudnessMeter::CloseStep()
+{
+	const FAkMLoudnessLayout& Layout = Layouts.Read();
+	FMemory::Memzero(GroupStepEnergy.GetData(), Layout.NumGroups * sizeof(double));
+	double MasterEnergy = 0.0;
+	const double InvStepFrames = 1.0 / StepFrames;
+	for (int32 Channel = 0; Channel < MaxChannels; ++Channel)
+	{
+		const int32 Group = Layout.GroupOfChannel[Channel];
+		if (Group == INDEX_NONE)
+		{
+			continue;
+		}
+		const double MeanSquare = Channels[Channel].SumSquares * InvStepFrames;
+		Channels[Channel].SumSquares = 0.0;
+		GroupStepEnergy[Group] += MeanSquare;
+		if (Layout.GroupInMaster[Group])
+		{
+			MasterEnergy += MeanSquare;
+		}
+	}
+	for (int32 Group = 0; Group < Layout.NumGroups; ++Group)
+	{
+		Groups[Group].CloseStep(GroupStepEnergy[Group]);
+	}
+	Master.CloseStep(MasterEnergy);
+}
+
+int32 FAkMLoudnessMeter::GetResults(FAkMLoudness* OutGroups, FAkMLoudness& OutMaster) const
+{
+	const FAkMLoudnessLayout& Layout = Layouts.Read();
+	for (int32 Group = 0; Group < Layout.NumGroups; ++Group)
+	{
+		OutGroups[Group] = Groups[Group].Loudness;
+	}
+	OutMaster = Master.Loudness;
+	return Layout.NumGroups;
+}
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMMeterBallistics.h"
+
+FAkMMeterBallistics FAkMMeterBallistics::FromPreset(EAkMMeterBallistics Preset)
+{
+	FAkMMeterBallistics Ballistics;
+	switch (Preset)
+	{
+	case EAkMMeterBallistics::VU:
+		// First-order fit of "99 % in 300 ms": 1 - exp(-0.3 / Tau) = 0.99
+		Ballistics.IntegrationSeconds = 0.065f;
+		break;
+	case EAkMMeterBallistics::PPMTypeI:
+		Ballistics.bPeakDetector = true;
+		Ballistics.IntegrationSeconds = 0.005f;
+		Ballistics.ReleaseDbPerSecond = 20.0f / 1.5f;
+		break;
+	case EAkMMeterBallistics::PPMTypeII:
+		Ballistics.bPeakDetector = true;
+		Ballistics.IntegrationSeconds = 0.010f;
+		Ballistics.ReleaseDbPerSecond = 24.0f / 2.8f;
+		break;
+	case EAkMMeterBallistics::DigitalPeak:
+	default:
+		Ballistics.bPeakDetector = true;
+		Ballistics.ReleaseDbPerSecond = 20.0f / 1.7f;
+		break;
+	}
+	return Ballistics;
+}
+
+const TCHAR* FAkMMeterBallistics::GetPresetName(EAkMMeterBallistics Preset)
+{
+	switch (Preset)
+	{
+	case EAkMMeterBallistics::VU:			return TEXT("VU");
+	case EAkMMeterBallistics::PPMTypeI:		return TEXT("PPM Type I");
+	case EAkMMeterBallistics::PPMTypeII:	return TEXT("PPM Type II");
+	case EAkMMeterBallistics::DigitalPeak:	return TEXT("Digital peak");
+	default:								return TEXT("?");
+	}
+}
+
+FAkMMeterBallistics::FStepCoefficients FAkMMeterBallistics::GetStepCoefficients(float Seconds) const
+{
+	FStepCoefficients Coefficients;
+	Coefficients.Seconds = FMath::Max(0.0f, Seconds);
+	Coefficients.Smoothing = IntegrationSeconds > 0.0f ? FMath::Exp(-Coefficients.Seconds / IntegrationSeconds) : 0.0f;
+	Coefficients.ReleaseGain = FMath::Pow(10.0f, -ReleaseDbPerSecond * Coefficients.Seconds / 20.0f);
+	Coefficients.PeakReleaseGain = FMath::Pow(10.0f, -PeakReleaseDbPerSecond * Coefficients.Seconds / 20.0f);
+	return Coefficients;
+}
+
+void FAkMMeterBallistics::Step(FAkMMeterState& State, float Rms, float Peak, const FStepCoefficients& Coefficients) const
+{
+	if (Coefficients.Seconds <= 0.0f)
+	{
+		return;
+	}
+
+	// Level: exponential attack, then either the same integrator (VU) or a constant fall in dB/s (PPM)
+	const float Input = bPeakDetector ? Peak : Rms;
+	if (Input >= State.Level || ReleaseDbPerSecond <= 0.0f)
+	{
+		State.Level = Input + (State.Level - Input) * Coefficients.Smoothing;
+	}
+	else
+	{
+		State.Level = FMath::Max(Input, State.Level * Coefficients.ReleaseGain);
+	}
+
+	// Sample-peak hold, then fall in dB/s
+	if (Peak >= State.HoldPeak)
+	{
+		State.HoldPeak = Peak;
+		State.HoldSecondsLeft = PeakHoldSeconds;
+	}
+	else if (State.HoldSecondsLeft > 0.0f)
+	{
+		State.HoldSecondsLeft -= Coefficients.Seconds;
+	}
+	else
+	{
+		State.HoldPeak = FMath::Max(Peak, State.HoldPeak * Coefficients.PeakReleaseGain);
+	}
+}
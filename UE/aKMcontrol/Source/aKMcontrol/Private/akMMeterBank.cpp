@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMMeterBank.h"
+
+namespace
+{
+	const ImU32 BackgroundColor = IM_COL32(30, 30, 30, 255);
+	const ImU32 GreenColor = IM_COL32(0, 200, 0, 255);
+	const ImU32 YellowColor = IM_COL32(255, 255, 0, 255);
+	const ImU32 RedColor = IM_COL32(255, 0, 0, 255);
+	const ImU32 PeakColor = IM_COL32(255, 255, 255, 180);
+	constexpr float YellowFraction = 0.75f;
+	constexpr float RedFraction = 0.90f;
+
+	// The table is indexed by the float's exponent and top 8 mantissa bits (about 0.02 dB per entry) from 2^-11
+	// (-66 dBFS, below the meter floor) to 2^1 (+6 dBFS, the top)
+	constexpr int32 LutMantissaBits = 8;
+	constexpr int32 LutShift = 23 - LutMantissaBits;
+	constexpr uint32 LutFirstBits = uint32(127 - 11) << 23;
+	constexpr uint32 LutEndBits = uint32(127 + 1) << 23;
+	constexpr int32 LutSize = int32((LutEndBits - LutFirstBits) >> LutShift);
+
+	struct FFractionLut
+	{
+		float Fractions[LutSize];
+
+		FFractionLut()
+		{
+			for (int32 i = 0; i < LutSize; ++i)
+			{
+				// Centre of the entry's range of values
+				const uint32 Bits = LutFirstBits + (uint32(i) << LutShift) + (1u << (LutShift - 1));
+				float Linear;
+				FMemory::Memcpy(&Linear, &Bits, sizeof(float));
+				const float Db = 20.0f * FMath::LogX(10.0f, Linear);
+				Fractions[i] = FMath::Clamp((Db - FAkMMeterBank::MinDb) / (FAkMMeterBank::MaxDb - FAkMMeterBank::MinDb), 0.0f, 1.0f);
+			}
+		}
+	};
+
+	TArray<ANSICHAR> ToUtf8(const FString& String)
+	{
+		const FTCHARToUTF8 Converted(*String);
+		TArray<ANSICHAR> Result;
+		Result.Reserve(Converted.Length() + 1);
+		Result.Append(reinterpret_cast<const ANSICHAR*>(Converted.Get()), Converted.Length());
+		Result.Add('\0');
+		return Result;
+	}
+}
+
+float FAkMMeterBank::LevelToFraction(float Linear)
+{
+	static const FFractionLut Lut;
+	uint32 Bits;
+	FMemory::Memcpy(&Bits, &Linear, sizeof(float));
+	if (Bits < LutFirstBits || Bits >= 0x80000000u)	// Below the floor, zero or negative
+	{
+		return 0.0f;
+	}
+	if (Bits >= LutEndBits)
+	{
+		return 1.0f;
+	}
+	return Lut.Fractions[(Bits - LutFirstBits) >> LutShift];
+}
+
+void FAkMMeterBank::ResetLayout(uint64 Generation, int32 NumInputs)
+{
+	Groups.Reset();
+	bHasLayout = true;
+	LayoutGeneration = Generation;
+	LayoutNumInputs = NumInputs;
+}
+
+void FAkMMeterBank::AddGroup(const FString& Header, TConstArrayView<int32> Inputs1Based, TConstArrayView<int32> Labels)
+{
+	FGroup& Group = Groups.AddDefaulted_GetRef();
+	Group.Header = ToUtf8(Header);
+	Group.ColumnId = ToUtf8(FString::Printf(TEXT("##Col%d"), Groups.Num()));
+	Group.Channels.Reserve(Inputs1Based.Num());
+	for (const int32 Input : Inputs1Based)
+	{
+		Group.Channels.Add(Input - 1);
+	}
+	for (const int32 Label : Labels)
+	{
+		Group.Labels.Add(ToUtf8(FString::Printf(TEXT("%.2d"), Label)));
+	}
+	const int32 Count = Group.Channels.Num();
+	Group.Width = Count * MeterWidth + FMath::Max(0, Count - 1) * MeterSpacing + GroupPadding * 2.0f;
+}
+
+void FAkMMeterBank::MeterCell(int32 Group, float MeterHeight)
+{
+	CellPositions.SetNum(Groups.Num(), EAllowShrinking::No);
+	const ImVec2 CellPos = ImGui::GetCursorScreenPos();
+	CellPositions[Group] = ImVec2(CellPos.x + GroupPadding, CellPos.y);
+	ImGui::Dummy(ImVec2(Groups[Group].Width, MeterHeight));
+}
+
+void FAkMMeterBank::DrawMeters(ImDrawList* DrawList, const TArray<float>& Levels, const TArray<float>& Peaks, float MeterHeight)
+{
+	if (CellPositions.Num() != Groups.Num())
+	{
+		return;
+	}
+
+	// Pass 1: heights and the exact number of rectangles
+	int32 NumMeters = 0;
+	for (const FGroup& Group : Groups)
+	{
+		NumMeters += Group.Channels.Num();
+	}
+	LevelHeights.SetNumUninitialized(NumMeters, EAllowShrinking::No);
+	PeakHeights.SetNumUninitialized(NumMeters, EAllowShrinking::No);
+	const float YellowHeight = MeterHeight * YellowFraction;
+	const float RedHeight = MeterHeight * RedFraction;
+	int32 NumRects = 0;
+	int32 Meter = 0;
+	for (const FGroup& Group : Groups)
+	{
+		for (const int32 Channel : Group.Channels)
+		{
+			const bool bValid = Levels.IsValidIndex(Channel) && Peaks.IsValidIndex(Channel);
+			const float Level = bValid ? LevelToFraction(Levels[Channel]) * MeterHeight : 0.0f;
+			const float Peak = bValid ? LevelToFraction(Peaks[Channel]) * MeterHeight : 0.0f;
+			LevelHeights[Meter] = Level;
+			PeakHeights[Meter] = Peak;
+			NumRects += 1 + (Level > 0.0f) + (Level > YellowHeight) + (Level > RedHeight) + (Peak > 0.0f);
+			++Meter;
+		}
+	}
+
+	// Pass 2: one reservation, then plain quads
+	const ImVec2 WindowPos = ImGui::GetWindowPos();
+	const ImVec2 WindowSize = ImGui::GetWindowSize();
+	DrawList->PushClipRect(WindowPos, ImVec2(WindowPos.x + WindowSize.x, WindowPos.y + WindowSize.y), false);
+	DrawList->PrimReserve(NumRects * 6, NumRects * 4);
+	Meter = 0;
+	for (int32 g = 0; g < Groups.Num(); ++g)
+	{
+		float x = CellPositions[g].x;
+		const float Top = CellPositions[g].y;
+		const float Bottom = Top + MeterHeight;
+		for (int32 i = 0; i < Groups[g].Channels.Num(); ++i, ++Meter)
+		{
+			const float Right = x + MeterWidth;
+			const float Level = LevelHeights[Meter];
+			DrawList->PrimRect(ImVec2(x, Top), ImVec2(Right, Bottom), BackgroundColor);
+			if (Level > 0.0f)
+			{
+				DrawList->PrimRect(ImVec2(x, Bottom - FMath::Min(Level, YellowHeight)), ImVec2(Right, Bottom), GreenColor);
+			}
+			if (Level > YellowHeight)
+			{
+				DrawList->PrimRect(ImVec2(x, Bottom - FMath::Min(Level, RedHeight)), ImVec2(Right, Bottom - YellowHeight), YellowColor);
+			}
+			if (Level > RedHeight)
+			{
+				DrawList->PrimRect(ImVec2(x, Bottom - Level), ImVec2(Right, Bottom - RedHeight), RedColor);
+			}
+			if (PeakHeights[Meter] > 0.0f)
+			{
+				const float PeakY = Bottom - PeakHeights[Meter];
+				DrawList->PrimRect(ImVec2(x, PeakY - 0.5f), ImVec2(Right, PeakY + 0.5f), PeakColor);
+			}
+			x += MeterWidth + MeterSpacing;
+		}
+	}
+	DrawList->PopClipRect();
+}
+
+void FAkMMeterBank::LabelCell(int32 Group) const
+{
+	const FGroup& Cell = Groups[Group];
+	ImDrawList* DrawList = ImGui::GetWindowDrawList();
+	const ImVec2 CellPos = ImGui::GetCursorScreenPos();
+	const ImU32 TextColor = ImGui::GetColorU32(ImGuiCol_Text);
+	float x = CellPos.x + GroupPadding;
+	for (const TArray<ANSICHAR>& Label : Cell.Labels)
+	{
+		DrawList->AddText(ImVec2(x, CellPos.y), TextColor, Label.GetData());
+		x += MeterWidth + MeterSpacing;
+	}
+	ImGui::Dummy(ImVec2(Cell.Width, ImGui::GetTextLineHeight()));
+}
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMMockJackBackend.h"
+#include "HAL/PlatformTime.h"
+
+FAkMMockJackBackend::FAkMMockJackBackend(const FString& InOwnClientName)
+	: OwnClientName(InOwnClientName)
+{
+}
+
+void FAkMMockJackBackend::AddClient(const FString& ClientName, int32 NumInputPorts, int32 NumOutputPorts)
+{
+	RemoveClient(ClientName);
+
+	FMockClient& Client = Clients.Add(ClientName);
+	ClientOrder.Add(ClientName);
+	Client.InputPorts.Reserve(NumInputPorts);
+	Client.OutputPorts.Reserve(NumOutputPorts);
+	for (int32 i = 1; i <= NumInputPorts; ++i)
+	{
+		InputPortNames.Add(Client.InputPorts.Add_GetRef(FString::Printf(TEXT("%s:in_%d"), *ClientName, i)));
+	}
+	for (int32 i = 1; i <= NumOutputPorts; ++i)
+	{
+		OutputPortNames.Add(Client.OutputPorts.Add_GetRef(FString::Printf(TEXT("%s:out_%d"), *ClientName, i)));
+	}
+
+	OnClientConnected.Broadcast(ClientName, NumInputPorts, NumOutputPorts);
+}
+
+void FAkMMockJackBackend::RemoveClient(const FString& ClientName)
+{
+	FMockClient Client;
+	if (!Clients.RemoveAndCopyValue(ClientName, Client))
+	{
+		return;
+	}
+	ClientOrder.Remove(ClientName);
+	for (const FString& Port : Client.InputPorts)
+	{
+		InputPortNames.Remove(Port);
+	}
+	for (const FString& Port : Client.OutputPorts)
+	{
+		OutputPortNames.Remove(Port);
+	}
+	for (auto It = Connections.CreateIterator(); It; ++It)
+	{
+		if (FAkMJackGraph::GetClientOfPort(It->Source) == ClientName || FAkMJackGraph::GetClientOfPort(It->Destination) == ClientName)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	OnClientDisconnected.Broadcast(ClientName);
+}
+
+TArray<FString> FAkMMockJackBackend::GetConnectedClients() const
+{
+	SimulateLatency();
+	return ClientOrder;
+}
+
+void FAkMMockJackBackend::GetClientPorts(const FString& ClientName, TArray<FString>& OutInputPorts, TArray<FString>& OutOutputPorts) const
+{
+	SimulateLatency();
+	++NumPortQueries;
+	OutInputPorts.Reset();
+	OutOutputPorts.Reset();
+	if (const FMockClient* Client = Clients.Find(ClientName))
+	{
+		OutInputPorts = Client->InputPorts;
+		OutOutputPorts = Client->OutputPorts;
+	}
+}
+
+bool FAkMMockJackBackend::GetPortConnections(const FString& Port, TArray<FString>& OutConnectedPorts) const
+{
+	SimulateLatency();
+	++NumConnectionQueries;
+	OutConnectedPorts.Reset();
+	if (!OutputPortNames.Contains(Port) && !InputPortNames.Contains(Port))
+	{
+		return false;
+	}
+	for (const FAkMJackConnection& Connection : Connections)
+	{
+		if (Connection.Source.Equals(Port, ESearchCase::IgnoreCase))
+		{
+			OutConnectedPorts.Add(Connection.Destination);
+		}
+		else if (Connection.Destination.Equals(Port, ESearchCase::IgnoreCase))
+		{
+			OutConnectedPorts.Add(Connection.Source);
+		}
+	}
+	return true;
+}
+
+bool FAkMMockJackBackend::ConnectPorts(const FString& SourcePort, const FString& DestinationPort)
+{
+	SimulateLatency();
+	++NumConnectCalls;
+	// jack_connect fails on unknown ports, on input->output and with EEXIST on an existing connection
+	if (!OutputPortNames.Contains(SourcePort) || !InputPortNames.Contains(DestinationPort))
+	{
+		return false;
+	}
+	bool bAlreadyConnected = false;
+	Connections.Add(FAkMJackConnection(SourcePort, DestinationPort), &bAlreadyConnected);
+	return !bAlreadyConnected;
+}
+
+bool FAkMMockJackBackend::DisconnectPorts(const FString& SourcePort, const FString& DestinationPort)
+{
+	SimulateLatency();
+	++NumDisconnectCalls;
+	return Connections.Remove(FAkMJackConnection(SourcePort, DestinationPort)) > 0;
+}
+
+void FAkMMockJackBackend::SimulateLatency() const
+{
+	if (SimulatedCallLatencyUs <= 0.0f)
+	{
+		return;
+	}
+	// Busy-wait: sleeping has millisecond granularity on most schedulers
+	const double EndTime = FPlatformTime::Seconds() + SimulatedCallLatencyUs * 1e-6;
+	while (FPlatformTime::Seconds() < EndTime)
+	{
+	}
+}
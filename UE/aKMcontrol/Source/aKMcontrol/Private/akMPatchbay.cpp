@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMPatchbay.h"
+#include "JsonObjectConverter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+const FAkMPatchbayRule* FAkMPatchbayProfile::FindRule(const FString& ClientName) const
+{
+	return Rules.FindByPredicate([&ClientName](const FAkMPatchbayRule& Rule) { return Rule.Matches(ClientName); });
+}
+
+FString FAkMPatchbayProfiles::GetDefaultFilePath()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("akM"), TEXT("PatchbayProfiles.json"));
+}
+
+bool FAkMPatchbayProfiles::LoadFromFile(const FString& FilePath)
+{
+	FString Json;
+	if (!FFileHelper::LoadFileToString(Json, *FilePath))
+	{
+		return false;
+	}
+	return FJsonObjectConverter::JsonObjectStringToUStruct(Json, this);
+}
+
+bool FAkMPatchbayProfiles::SaveToFile(const FString& FilePath) const
+{
+	FString Json;
+	if (!FJsonObjectConverter::UStructToJsonObjectString(*this, Json))
+	{
+		return false;
+	}
+	return FFileHelper::SaveStringToFile(Json, *FilePath);
+}
+
+FAkMPatchbayProfile* FAkMPatchbayProfiles::FindProfile(const FString& ProfileName)
+{
+	return Profiles.FindByPredicate([&ProfileName](const FAkMPatchbayProfile& Profile) { return Profile.Name.Equals(ProfileName, ESearchCase::IgnoreCase); });
+}
@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMPortAllocator.h"
+
+void FAkMPortAllocator::SetNumPorts(int32 InNumPorts)
+{
+	InNumPorts = FMath::Max(0, InNumPorts);
+	const int32 OldNumPorts = Used.Num();
+	if (InNumPorts == OldNumPorts)
+	{
+		return;
+	}
+
+	if (InNumPorts < OldNumPorts)
+	{
+		for (TPair<FString, TArray<int32>>& Pair : Owners)
+		{
+			Pair.Value.RemoveAll([InNumPorts](int32 Index1Based) { return Index1Based > InNumPorts; });
+		}
+		for (TMap<FString, TArray<int32>>::TIterator It = Owners.CreateIterator(); It; ++It)
+		{
+			if (It.Value().IsEmpty())
+			{
+				It.RemoveCurrent();
+			}
+		}
+		NumUsed -= Used.CountSetBits(InNumPorts, OldNumPorts);
+		Used.SetNum(InNumPorts, false);
+		FirstFreeHint = FMath::Min(FirstFreeHint, InNumPorts);
+	}
+	else
+	{
+		Used.SetNum(InNumPorts, false);
+	}
+}
+
+void FAkMPortAllocator::Reset()
+{
+	Used.Init(false, Used.Num());
+	NumUsed = 0;
+	FirstFreeHint = 0;
+	Owners.Reset();
+}
+
+bool FAkMPortAllocator::Allocate(const FString& Owner, int32 Count, TArray<int32>& OutIndices, EAkMPortAllocation Policy)
+{
+	if (Count <= 0)
+	{
+		return true;
+	}
+	if (Count > GetNumFree())
+	{
+		return false;
+	}
+
+	TArray<int32>& OwnerPorts = Owners.FindOrAdd(Owner);
+
+	if (Policy != EAkMPortAllocation::Any)
+	{
+		const int32 Start = FindFreeRange(Count, FirstFreeHint);
+		if (Start != INDEX_NONE)
+		{
+			for (int32 Bit = Start; Bit < Start + Count; ++Bit)
+			{
+				SetUsed(Bit, true);
+				OwnerPorts.Add(Bit + 1);
+				OutIndices.Add(Bit + 1);
+			}
+			return true;
+		}
+		if (Policy == EAkMPortAllocation::Contiguous)
+		{
+			if (OwnerPorts.IsEmpty())
+			{
+				Owners.Remove(Owner);
+			}
+			return false;
+		}
+	}
+
+	// Enough free ports exist (checked above), so this always completes
+	for (int32 Allocated = 0; Allocated < Count; ++Allocated)
+	{
+		const int32 Bit = Used.FindFrom(false, FirstFreeHint);
+		check(Bit != INDEX_NONE);
+		SetUsed(Bit, true);
+		OwnerPorts.Add(Bit + 1);
+		OutIndices.Add(Bit + 1);
+	}
+	return true;
+}
+
+bool FAkMPortAllocator::Claim(const FString& Owner, int32 Index1Based)
+{
+	const int32 Bit = Index1Based - 1;
+	if (!Used.IsValidIndex(Bit))
+	{
+		return false;
+	}
+	if (Used[Bit])
+	{
+		const TArray<int32>* OwnerPorts = Owners.Find(Owner);
+		return OwnerPorts && OwnerPorts->Contains(Index1Based);
+	}
+	SetUsed(Bit, true);
+	Owners.FindOrAdd(Owner).Add(Index1Based);
+	return true;
+}
+
+void FAkMPortAllocator::Free(const FString& Owner, int32 Index1Based)
+{
+	TArray<int32>* OwnerPorts = Owners.Find(Owner);
+	if (OwnerPorts && OwnerPorts->RemoveSingle(Index1Based) > 0)
+	{
+		SetUsed(Index1Based - 1, false);
+		if (OwnerPorts->IsEmpty())
+		{
+			Owners.Remove(Owner);
+		}
+	}
+}
+
+int32 FAkMPortAllocator::FreeOwner(const FString& Owner)
+{
+	TArray<int32> OwnerPorts;
+	if (!Owners.RemoveAndCopyValue(Owner, OwnerPorts))
+	{
+		return 0;
+	}
+	for (const int32 Index1Based : OwnerPorts)
+	{
+		SetUsed(Index1Based - 1, false);
+	}
+	return OwnerPorts.Num();
+}
+
+void FAkMPortAllocator::GetFreeIndices(TArray<int32>& OutIndices) const
+{
+	OutIndices.Reserve(OutIndices.Num() + GetNumFree());
+	for (int32 Bit = Used.FindFrom(false, FirstFreeHint); Bit != INDEX_NONE; Bit = Used.FindFrom(false, Bit + 1))
+	{
+		OutIndices.Add(Bit + 1);
+	}
+}
+
+int32 FAkMPortAllocator::ReclaimLeaks(TFunctionRef<bool(const FString&)> IsOwnerAlive, TArray<FString>* OutLeakedOwners)
+{
+	TArray<FString> Leaked;
+	for (const TPair<FString, TArray<int32>>& Pair : Owners)
+	{
+		if (!IsOwnerAlive(Pair.Key))
+		{
+			Leaked.Add(Pair.Key);
+		}
+	}
+
+	int32 NumReclaimed = 0;
+	for (const FString& Owner : Leaked)
+	{
+		NumReclaimed += FreeOwner(Owner);
+	}
+	if (OutLeakedOwners)
+	{
+		*OutLeakedOwners = MoveTemp(Leaked);
+	}
+	return NumReclaimed;
+}
+
+int32 FAkMPortAllocator::FindFreeRange(int32 Count, int32 StartBit) const
+{
+	const int32 NumPorts = Used.Num();
+	int32 RunStart = Used.FindFrom(false, StartBit);
+	while (RunStart != INDEX_NONE && RunStart + Count <= NumPorts)
+	{
+		// Jump over the whole free run, then over the used run that ends it
+		const int32 RunEnd = Used.FindFrom(true, RunStart);
+		const int32 RunLength = (RunEnd == INDEX_NONE ? NumPorts : RunEnd) - RunStart;
+		if (RunLength >= Count)
+		{
+			return RunStart;
+		}
+		if (RunEnd == INDEX_NONE)
+		{
+			break;
+		}
+		RunStart = Used.FindFrom(false, RunEnd);
+	}
+	return INDEX_NONE;
+}
+
+void FAkMPortAllocator::SetUsed(int32 Bit, bool bInUsed)
+{
+	check(Used[Bit] != bInUsed);
+	Used[Bit] = bInUsed;
+	NumUsed += bInUsed ? 1 : -1;
+	if (!bInUsed)
+	{
+		FirstFreeHint = FMath::Min(FirstFreeHint, Bit);
+	}
+	else if (Bit == FirstFreeHint)
+	{
+		++FirstFreeHint;
+	}
+}
@@ -0,0 +1,344 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMProcessSampler.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <psapi.h>
+#include <tlhelp32.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#elif PLATFORM_MAC
+#include <libproc.h>
+#include <mach/mach_time.h>
+#elif PLATFORM_LINUX
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+FAkMProcessSampler::FAkMProcessSampler(float InIntervalSeconds, int32 InHistoryCapacity)
+	: IntervalSeconds(FMath::Max(0.05f, InIntervalSeconds))
+{
+	for (int32 i = 0; i < static_cast<int32>(ETarget::Num); ++i)
+	{
+		Targets.Emplace(InHistoryCapacity);
+	}
+}
+
+FAkMProcessSampler::~FAkMProcessSampler()
+{
+	StopAndWait();
+}
+
+void FAkMProcessSampler::Start()
+{
+	if (Thread)
+	{
+		return;
+	}
+	bStopRequested = false;
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("AkMProcessSampler"), 0, TPri_Lowest);
+}
+
+void FAkMProcessSampler::StopAndWait()
+{
+	if (!Thread)
+	{
+		return;
+	}
+	Stop();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+void FAkMProcessSampler::SetSclangProcessId(uint32 InProcessId)
+{
+	RequestedSclangProcessId.store(InProcessId);
+}
+
+uint32 FAkMProcessSampler::GetSnapshot(ETarget Target, TArray<FAkMProcessSample>& OutSamples) const
+{
+	FScopeLock Lock(&Mutex);
+	const FTargetState& State = Targets[static_cast<int32>(Target)];
+	OutSamples.SetNumUninitialized(State.History.Num(), EAllowShrinking::No);
+	for (int32 i = 0; i < State.History.Num(); ++i)
+	{
+		OutSamples[i] = State.History[i];
+	}
+	return State.ProcessId;
+}
+
+void FAkMProcessSampler::Stop()
+{
+	bStopRequested = true;
+	if (WakeEvent)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+uint32 FAkMProcessSampler::Run()
+{
+	while (!bStopRequested)
+	{
+		const double Now = FPlatformTime::Seconds();
+		FTargetState& Sclang = Targets[static_cast<int32>(ETarget::Sclang)];
+		FTargetState& Scsynth = Targets[static_cast<int32>(ETarget::Scsynth)];
+
+		// Follow the PID set by the owner (restart or failover); scsynth is looked up again under the new sclang
+		const uint32 SclangProcessId = RequestedSclangProcessId.load();
+		if (Sclang.ProcessId != SclangProcessId)
+		{
+			FScopeLock Lock(&Mutex);
+			Sclang.ProcessId = SclangProcessId;
+			Sclang.bHasPrevious = false;
+			Scsynth.ProcessId = 0;
+			Scsynth.bHasPrevious = false;
+		}
+		SampleTarget(Sclang, Now);
+
+		// scsynth is booted by the script some time after sclang starts, and may be rebooted by it
+		if (SclangProcessId != 0 && (Scsynth.ProcessId == 0 || !Scsynth.bHasPrevious))
+		{
+			const uint32 ScsynthProcessId = FindChildProcess(SclangProcessId, TEXT("scsynth"));
+			if (ScsynthProcessId != Scsynth.ProcessId)
+			{
+				FScopeLock Lock(&Mutex);
+				Scsynth.ProcessId = ScsynthProcessId;
+				Scsynth.bHasPrevious = false;
+			}
+		}
+		SampleTarget(Scsynth, Now);
+
+		WakeEvent->Wait(FTimespan::FromSeconds(IntervalSeconds));
+	}
+	return 0;
+}
+
+void FAkMProcessSampler::SampleTarget(FTargetState& State, double Now)
+{
+	if (State.ProcessId == 0)
+	{
+		return;
+	}
+
+	FRawCounters Counters;
+	if (!ReadCounters(State.ProcessId, Counters))
+	{
+		// Process is gone; forget it so the next lookup can find its replacement
+		FScopeLock Lock(&Mutex);
+		State.ProcessId = 0;
+		State.bHasPrevious = false;
+		return;
+	}
+
+	// Rates need two readings; the first one after a (re)start only primes the counters
+	if (State.bHasPrevious)
+	{
+		const double Elapsed = FMath::Max(Now - State.PreviousTime, 1e-3);
+
+		FAkMProcessSample Sample;
+		Sample.Time = Now;
+		Sample.CpuPercent = float(FMath::Max(0.0, Counters.CpuSeconds - State.Previous.CpuSeconds) / Elapsed * 100.0);
+		Sample.ResidentMB = float(Counters.ResidentMB);
+		Sample.NumThreads = float(Counters.NumThreads);
+		if (Counters.ContextSwitches >= 0 && State.Previous.ContextSwitches >= 0)
+		{
+			Sample.ContextSwitchesPerSec = float(FMath::Max<int64>(0, Counters.ContextSwitches - State.Previous.ContextSwitches) / Elapsed);
+		}
+
+		FScopeLock Lock(&Mutex);
+		State.History.Add(Sample);
+	}
+
+	State.Previous = Counters;
+	State.PreviousTime = Now;
+	State.bHasPrevious = true;
+}
+
+uint32 FAkMProcessSampler::FindChildProcess(uint32 ParentProcessId, const TCHAR* ExecutableName)
+{
+	// One pass over the process table; sclang may start scsynth through a shell, so walk up a few parents
+	TMap<uint32, uint32> ParentOf;
+	TArray<uint32> Candidates;
+	FPlatformProcess::FProcEnumerator ProcIter;
+	while (ProcIter.MoveNext())
+	{
+		const FPlatformProcess::FProcEnumInfo Info = ProcIter.GetCurrent();
+		ParentOf.Add(Info.GetPID(), Info.GetParentPID());
+		if (FPaths::GetBaseFilename(Info.GetName()).Equals(ExecutableName, ESearchCase::IgnoreCase))
+		{
+			Candidates.Add(Info.GetPID());
+		}
+	}
+
+	for (const uint32 Candidate : Candidates)
+	{
+		uint32 Ancestor = Candidate;
+		for (int32 Depth = 0; Depth < 3; ++Depth)
+		{
+			const uint32* Parent = ParentOf.Find(Ancestor);
+			if (!Parent || *Parent == 0)
+			{
+				break;
+			}
+			if (*Parent == ParentProcessId)
+			{
+				return Candidate;
+			}
+			Ancestor = *Parent;
+		}
+	}
+	return 0;
+}
+
+#if PLATFORM_WINDOWS
+
+bool FAkMProcessSampler::ReadCounters(uint32 ProcessId, FRawCounters& OutCounters)
+{
+	HANDLE Process = ::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, 0, ProcessId);
+	if (!Process)
+	{
+		return false;
+	}
+
+	DWORD ExitCode = 0;
+	FILETIME CreationTime, ExitTime, KernelTime, UserTime;
+	PROCESS_MEMORY_COUNTERS MemoryCounters;
+	const bool bOk = ::GetExitCodeProcess(Process, &ExitCode) && ExitCode == STILL_ACTIVE
+		&& ::GetProcessTimes(Process, &CreationTime, &ExitTime, &KernelTime, &UserTime)
+		&& ::K32GetProcessMemoryInfo(Process, &MemoryCounters, sizeof(MemoryCounters));
+	::CloseHandle(Process);
+	if (!bOk)
+	{
+		return false;
+	}
+
+	// FILETIME durations are in 100 ns units
+	const uint64 Kernel = (uint64(KernelTime.dwHighDateTime) << 32) | KernelTime.dwLowDateTime;
+	const uint64 User = (uint64(UserTime.dwHighDateTime) << 32) | UserTime.dwLowDateTime;
+	OutCounters.CpuSeconds = double(Kernel + User) * 1e-7;
+	OutCounters.ResidentMB = double(MemoryCounters.WorkingSetSize) / (1024.0 * 1024.0);
+
+	// Thread count from the process snapshot; per-process context switches are not exposed by a documented API
+	HANDLE Snapshot = ::CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+	if (Snapshot != INVALID_HANDLE_VALUE)
+	{
+		PROCESSENTRY32 Entry;
+		Entry.dwSize = sizeof(Entry);
+		for (BOOL bMore = ::Process32First(Snapshot, &Entry); bMore; bMore = ::Process32Next(Snapshot, &Entry))
+		{
+			if (Entry.th32ProcessID == ProcessId)
+			{
+				OutCounters.NumThreads = int32(Entry.cntThreads);
+				break;
+			}
+		}
+		::CloseHandle(Snapshot);
+	}
+	OutCounters.ContextSwitches = -1;
+	return true;
+}
+
+#elif PLATFORM_MAC
+
+bool FAkMProcessSampler::ReadCounters(uint32 ProcessId, FRawCounters& OutCounters)
+{
+	struct proc_taskinfo TaskInfo;
+	if (proc_pidinfo(int(ProcessId), PROC_PIDTASKINFO, 0, &TaskInfo, sizeof(TaskInfo)) != int(sizeof(TaskInfo)))
+	{
+		return false;
+	}
+
+	// Task times are in mach absolute time units
+	static mach_timebase_info_data_t Timebase = [] { mach_timebase_info_data_t Info; mach_timebase_info(&Info); return Info; }();
+	const double Nanoseconds = double(TaskInfo.pti_total_user + TaskInfo.pti_total_system) * Timebase.numer / Timebase.denom;
+	OutCounters.CpuSeconds = Nanoseconds * 1e-9;
+	OutCounters.ResidentMB = double(TaskInfo.pti_resident_size) / (1024.0 * 1024.0);
+	OutCounters.NumThreads = TaskInfo.pti_threadnum;
+	OutCounters.ContextSwitches = TaskInfo.pti_csw;
+	return true;
+}
+
+#elif PLATFORM_LINUX
+
+namespace
+{
+	// /proc files report a size of 0, so read them with stdio instead of the UE file layer
+	int32 ReadProcFile(const char* Path, char* Buffer, int32 BufferSize)
+	{
+		FILE* File = fopen(Path, "r");
+		if (!File)
+		{
+			return 0;
+		}
+		const size_t Read = fread(Buffer, 1, BufferSize - 1, File);
+		fclose(File);
+		Buffer[Read] = '\0';
+		return int32(Read);
+	}
+
+	int64 ParseStatusField(const char* Status, const char* Key)
+	{
+		const char* Field = strstr(Status, Key);
+		return Field ? strtoll(Field + strlen(Key), nullptr, 10) : -1;
+	}
+}
+
+bool FAkMProcessSampler::ReadCounters(uint32 ProcessId, FRawCounters& OutCounters)
+{
+	char Path[64];
+	char Buffer[4096];
+
+	// /proc/<pid>/stat: fields after the parenthesised command name, utime and stime in clock ticks
+	snprintf(Path, sizeof(Path), "/proc/%u/stat", ProcessId);
+	if (ReadProcFile(Path, Buffer, sizeof(Buffer)) <= 0)
+	{
+		return false;
+	}
+	const char* AfterName = strrchr(Buffer, ')');
+	if (!AfterName)
+	{
+		return false;
+	}
+	char State = 0;
+	unsigned long long UserTicks = 0, SystemTicks = 0;
+	long NumThreads = 0;
+	if (sscanf(AfterName + 1, " %c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %*d %*d %*d %*d %ld",
+		&State, &UserTicks, &SystemTicks, &NumThreads) != 4 || State == 'Z')
+	{
+		return false;
+	}
+	static const long TicksPerSecond = sysconf(_SC_CLK_TCK);
+	OutCounters.CpuSeconds = double(UserTicks + SystemTicks) / double(TicksPerSecond);
+	OutCounters.NumThreads = int32(NumThreads);
+
+	// /proc/<pid>/status: resident set and context switch counters
+	snprintf(Path, sizeof(Path), "/proc/%u/status", ProcessId);
+	if (ReadProcFile(Path, Buffer, sizeof(Buffer)) > 0)
+	{
+		const int64 ResidentKB = ParseStatusField(Buffer, "VmRSS:");
+		const int64 Voluntary = ParseStatusField(Buffer, "voluntary_ctxt_switches:");
+		const int64 Involuntary = ParseStatusField(Buffer, "nonvoluntary_ctxt_switches:");
+		OutCounters.ResidentMB = ResidentKB >= 0 ? double(ResidentKB) / 1024.0 : 0.0;
+		OutCounters.ContextSwitches = (Voluntary >= 0 && Involuntary >= 0) ? Voluntary + Involuntary : -1;
+	}
+	return true;
+}
+
+#else
+
+bool FAkMProcessSampler::ReadCounters(uint32 ProcessId, FRawCounters& OutCounters)
+{
+	return false;
+}
+
+#endif
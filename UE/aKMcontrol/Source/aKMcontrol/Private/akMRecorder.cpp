@@ -0,0 +1,363 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMRecorder.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	// Appends little-endian fields to a header buffer
+	struct FHeaderWriter
+	{
+		uint8* Data;
+		int32 Offset = 0;
+
+		void Tag(const char* Id) { FMemory::Memcpy(Data + Offset, Id, 4); Offset += 4; }
+		void U16(uint16 Value) { FMemory::Memcpy(Data + Offset, &Value, 2); Offset += 2; }
+		void U32(uint32 Value) { FMemory::Memcpy(Data + Offset, &Value, 4); Offset += 4; }
+		void U64(uint64 Value) { FMemory::Memcpy(Data + Offset, &Value, 8); Offset += 8; }
+	};
+
+	// KSDATAFORMAT_SUBTYPE_IEEE_FLOAT
+	const uint8 FloatSubFormat[16] = { 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 };
+
+	constexpr double StopAcknowledgeTimeoutSeconds = 0.5;
+}
+
+FAkMRecorder::FAkMRecorder()
+{
+	WriteBuffer = static_cast<uint8*>(FMemory::Malloc(WriteChunkBytes, DataOffset));
+}
+
+FAkMRecorder::~FAkMRecorder()
+{
+	StopRecording();
+	FMemory::Free(WriteBuffer);
+}
+
+bool FAkMRecorder::StartRecording(const FString& InFilePath, TConstArrayView<int32> Channels, int32 SampleRate, float RingSeconds)
+{
+	if (Thread || Channels.IsEmpty() || SampleRate <= 0)
+	{
+		return false;
+	}
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(InFilePath), true);
+	File = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*InFilePath);
+	if (!File)
+	{
+		return false;
+	}
+	FilePath = InFilePath;
+	NumRecordChannels = FMath::Min(Channels.Num(), MaxChannels);
+	FMemory::Memcpy(RecordChannels, Channels.GetData(), NumRecordChannels * sizeof(int32));
+
+	// Idle or Stopped: the audio thread does not touch the ring, so it can be replaced
+	const int32 RingSamples = FMath::Max(1, FMath::CeilToInt(RingSeconds * SampleRate)) * NumRecordChannels;
+	if (!Ring || Ring->GetCapacity() < RingSamples)
+	{
+		Ring = MakeUnique<TAkMSpscRing<float>>(RingSamples);
+	}
+	Ring->Skip(Ring->NumReadable());
+	FGap Gap;
+	while (Gaps.Read(&Gap, 1) > 0) {}
+	Staging.SetNumUninitialized(StagingFrames * NumRecordChannels);
+	SamplesPushed = 0;
+	PendingGapFrames = 0;
+
+	WriteBufferFill = 0;
+	SamplesConsumed = 0;
+	DataBytesWritten = 0;
+	PendingGaps.Reset();
+	FramesWritten.store(0);
+	NumXruns.store(0);
+	DroppedFrames.store(0);
+	StreamSampleRate.store(SampleRate);
+	WriteHeader(0);
+
+	bStopRequested = false;
+	State.store(EState::Recording, std::memory_order_release);
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("AkMRecorderWriter"), 0, TPri_AboveNormal);
+	if (!Thread)
+	{
+		State.store(EState::Idle);
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+		delete File;
+		File = nullptr;
+		return false;
+	}
+	return true;
+}
+
+void FAkMRecorder::StopRecording()
+{
+	if (!Thread)
+	{
+		return;
+	}
+	EState Expected = EState::Recording;
+	State.compare_exchange_strong(Expected, EState::Stopping);
+	Stop();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+void FAkMRecorder::Stop()
+{
+	bStopRequested = true;
+	if (WakeEvent)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+float FAkMRecorder::GetRingFill() const
+{
+	return Ring && IsRecording() ? float(Ring->NumReadable()) / Ring->GetCapacity() : 0.0f;
+}
+
+bool FAkMRecorder::BeginPush(int32 SampleRate)
+{
+	const EState Current = State.load(std::memory_order_acquire);
+	if (Current == EState::Stopping)
+	{
+		State.store(EState::Stopped, std::memory_order_release);
+	}
+	if (Current != EState::Recording)
+	{
+		return false;
+	}
+	if (SampleRate > 0)
+	{
+		StreamSampleRate.store(SampleRate, std::memory_order_relaxed);
+	}
+	return true;
+}
+
+void FAkMRecorder::WriteFrames(const float* Interleaved, int32 NumFrames)
+{
+	const int32 NumSamples = NumFrames * NumRecordChannels;
+	if (Ring->NumFree() < NumSamples || (PendingGapFrames > 0 && Gaps.NumFree() == 0))
+	{
+		// The writer is behind: drop the frames and have it put silence in their place
+		PendingGapFrames += NumFrames;
+		DroppedFrames.fetch_add(NumFrames, std::memory_order_relaxed);
+		return;
+	}
+	if (PendingGapFrames > 0)
+	{
+		const FGap Gap { SamplesPushed, PendingGapFrames };
+		Gaps.Write(&Gap, 1);
+		NumXruns.fetch_add(1, std::memory_order_relaxed);
+		PendingGapFrames = 0;
+	}
+	Ring->Write(Interleaved, NumSamples);
+	SamplesPushed += NumSamples;
+}
+
+void FAkMRecorder::PushPlanar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, int32 SampleRate)
+{
+	if (!BeginPush(SampleRate))
+	{
+		return;
+	}
+	for (int32 First = 0; First < NumFrames; First += StagingFrames)
+	{
+		const int32 Count = FMath::Min(StagingFrames, NumFrames - First);
+		for (int32 c = 0; c < NumRecordChannels; ++c)
+		{
+			const int32 Channel = RecordChannels[c];
+			const float* Source = Channel >= 0 && Channel < NumChannels ? ChannelData[Channel] : nullptr;
+			float* Dest = Staging.GetData() + c;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Dest[i * NumRecordChannels] = Source ? Source[First + i] : 0.0f;
+			}
+		}
+		WriteFrames(Staging.GetData(), Count);
+	}
+}
+
+void FAkMRecorder::PushInterleaved(const float* Samples, int32 NumChannels, int32 NumFrames, int32 SampleRate)
+{
+	if (!BeginPush(SampleRate))
+	{
+		return;
+	}
+	for (int32 First = 0; First < NumFrames; First += StagingFrames)
+	{
+		const int32 Count = FMath::Min(StagingFrames, NumFrames - First);
+		for (int32 c = 0; c < NumRecordChannels; ++c)
+		{
+			const int32 Channel = RecordChannels[c];
+			float* Dest = Staging.GetData() + c;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Dest[i * NumRecordChannels] = Channel >= 0 && Channel < NumChannels ? Samples[(First + i) * NumChannels + Channel] : 0.0f;
+			}
+		}
+		WriteFrames(Staging.GetData(), Count);
+	}
+}
+
+uint32 FAkMRecorder::Run()
+{
+	double StopRequestTime = -1.0;
+	while (true)
+	{
+		const bool bDrained = Drain();
+		if (bStopRequested)
+		{
+			const double Now = FPlatformTime::Seconds();
+			StopRequestTime = StopRequestTime < 0.0 ? Now : StopRequestTime;
+			// Once the audio thread has let go of the ring (or is not running), write what is left and finish
+			if ((State.load(std::memory_order_acquire) == EState::Stopped || Now - StopRequestTime > StopAcknowledgeTimeoutSeconds) && !bDrained)
+			{
+				break;
+			}
+		}
+		if (!bDrained)
+		{
+			WakeEvent->Wait(10);
+		}
+	}
+
+	Flush();
+	WriteHeader(DataBytesWritten);
+	delete File;
+	File = nullptr;
+	State.store(EState::Idle, std::memory_order_release);
+	return 0;
+}
+
+bool FAkMRecorder::Drain()
+{
+	// Samples first: gaps are queued before the samples that follow them, so every gap up to here is visible
+	int32 Available = Ring->NumReadable();
+	FGap Gap;
+	while (Gaps.Read(&Gap, 1) > 0)
+	{
+		PendingGaps.Add(Gap);
+	}
+
+	bool bAny = false;
+	while (true)
+	{
+		if (!PendingGaps.IsEmpty() && PendingGaps[0].Position <= SamplesConsumed)
+		{
+			AppendSilence(int64(PendingGaps[0].NumFrames) * NumRecordChannels);
+			PendingGaps.RemoveAt(0);
+			bAny = true;
+			continue;
+		}
+		const uint64 UntilGap = PendingGaps.IsEmpty() ? MAX_uint64 : PendingGaps[0].Position - SamplesConsumed;
+		const int32 Space = (WriteChunkBytes - WriteBufferFill) / int32(sizeof(float));
+		const int32 Count = int32(FMath::Min<uint64>(FMath::Min(Available, Space), UntilGap));
+		if (Count <= 0)
+		{
+			break;
+		}
+		Ring->Read(reinterpret_cast<float*>(WriteBuffer + WriteBufferFill), Count);
+		WriteBufferFill += Count * sizeof(float);
+		SamplesConsumed += Count;
+		Available -= Count;
+		bAny = true;
+		if (WriteBufferFill == WriteChunkBytes)
+		{
+			Flush();
+		}
+	}
+	return bAny;
+}
+
+void FAkMRecorder::AppendSilence(int64 NumSamples)
+{
+	while (NumSamples > 0)
+	{
+		const int32 Count = int32(FMath::Min<int64>(NumSamples, (WriteChunkBytes - WriteBufferFill) / int32(sizeof(float))));
+		FMemory::Memzero(WriteBuffer + WriteBufferFill, Count * sizeof(float));
+		WriteBufferFill += Count * sizeof(float);
+		NumSamples -= Count;
+		if (WriteBufferFill == WriteChunkBytes)
+		{
+			Flush();
+		}
+	}
+}
+
+void FAkMRecorder::Flush()
+{
+	if (WriteBufferFill > 0 && File)
+	{
+		File->Write(WriteBuffer, WriteBufferFill);
+		DataBytesWritten += WriteBufferFill;
+		WriteBufferFill = 0;
+		FramesWritten.store(int64(DataBytesWritten / (sizeof(float) * NumRecordChannels)), std::memory_order_relaxed);
+	}
+}
+
+void FAkMRecorder::WriteHeader(uint64 DataBytes)
+{
+	if (!File)
+	{
+		return;
+	}
+
+	// RIFF, ds64 (or JUNK while it fits 32 bits), WAVE_FORMAT_EXTENSIBLE float fmt, JUNK padding, data at DataOffset
+	uint8 Header[DataOffset] = {};
+	FHeaderWriter Writer { Header };
+	const uint64 RiffBytes = DataOffset - 8 + DataBytes;
+	const bool bRf64 = RiffBytes > MAX_uint32;
+	const int32 SampleRate = StreamSampleRate.load(std::memory_order_relaxed);
+	const int32 BlockAlign = NumRecordChannels * sizeof(float);
+
+	Writer.Tag(bRf64 ? "RF64" : "RIFF");
+	Writer.U32(bRf64 ? MAX_uint32 : uint32(RiffBytes));
+	Writer.Tag("WAVE");
+
+	Writer.Tag(bRf64 ? "ds64" : "JUNK");
+	Writer.U32(28);
+	Writer.U64(bRf64 ? RiffBytes : 0);
+	Writer.U64(bRf64 ? DataBytes : 0);
+	Writer.U64(bRf64 ? DataBytes / BlockAlign : 0);
+	Writer.U32(0);
+
+	Writer.Tag("fmt ");
+	Writer.U32(40);
+	Writer.U16(0xFFFE);
+	Writer.U16(uint16(NumRecordChannels));
+	Writer.U32(uint32(SampleRate));
+	Writer.U32(uint32(SampleRate * BlockAlign));
+	Writer.U16(uint16(BlockAlign));
+	Writer.U16(32);
+	Writer.U16(22);
+	Writer.U16(32);
+	Writer.U32(0);
+	FMemory::Memcpy(Header + Writer.Offset, FloatSubFormat, sizeof(FloatSubFormat));
+	Writer.Offset += sizeof(FloatSubFormat);
+
+	Writer.Tag("JUNK");
+	Writer.U32(uint32(DataOffset - 8 - Writer.Offset - 8));
+	Writer.Offset = DataOffset - 8;
+
+	Writer.Tag("data");
+	Writer.U32(bRf64 ? MAX_uint32 : uint32(DataBytes));
+
+	const int64 Position = File->Tell();
+	File->Seek(0);
+	File->Write(Header, DataOffset);
+	if (Position > DataOffset)
+	{
+		File->Seek(Position);
+	}
+}
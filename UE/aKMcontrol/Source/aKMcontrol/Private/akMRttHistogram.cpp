@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMRttHistogram.h"
+
+FAkMRttHistogram::FAkMRttHistogram(int32 InWindowSize)
+	: WindowSize(FMath::Max(1, InWindowSize))
+{
+	Window.Reserve(WindowSize);
+}
+
+void FAkMRttHistogram::AddSample(float RttMs)
+{
+	if (Window.Num() < WindowSize)
+	{
+		Window.Add(RttMs);
+	}
+	else
+	{
+		// Evict the oldest sample from its bucket before overwriting it
+		--BucketCounts[GetBucketIndex(Window[Head])];
+		Window[Head] = RttMs;
+		Head = (Head + 1) % WindowSize;
+	}
+	++BucketCounts[GetBucketIndex(RttMs)];
+}
+
+void FAkMRttHistogram::Reset()
+{
+	Window.Reset();
+	Head = 0;
+	FMemory::Memzero(BucketCounts);
+}
+
+float FAkMRttHistogram::GetMax() const
+{
+	float Max = 0.0f;
+	for (const float Rtt : Window)
+	{
+		Max = FMath::Max(Max, Rtt);
+	}
+	return Max;
+}
+
+float FAkMRttHistogram::GetPercentile(float Fraction) const
+{
+	const int32 Total = Window.Num();
+	if (Total == 0)
+	{
+		return 0.0f;
+	}
+
+	const float Target = FMath::Clamp(Fraction, 0.0f, 1.0f) * Total;
+	int32 Cumulative = 0;
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		const int32 Count = BucketCounts[Bucket];
+		if (Count > 0 && Cumulative + Count >= Target)
+		{
+			const float Alpha = FMath::Clamp((Target - Cumulative) / Count, 0.0f, 1.0f);
+			const float LogLow = FMath::Loge(GetBucketEdgeMs(Bucket));
+			const float LogHigh = FMath::Loge(GetBucketEdgeMs(Bucket + 1));
+			return FMath::Exp(FMath::Lerp(LogLow, LogHigh, Alpha));
+		}
+		Cumulative += Count;
+	}
+	return GetBucketEdgeMs(NumBuckets);
+}
+
+float FAkMRttHistogram::GetBucketEdgeMs(int32 Index)
+{
+	const float Ratio = MaxRttMs / MinRttMs;
+	return MinRttMs * FMath::Pow(Ratio, float(Index) / NumBuckets);
+}
+
+int32 FAkMRttHistogram::GetBucketIndex(float RttMs)
+{
+	if (RttMs <= MinRttMs)
+	{
+		return 0;
+	}
+	const float Position = FMath::Loge(RttMs / MinRttMs) / FMath::Loge(MaxRttMs / MinRttMs);
+	return FMath::Clamp(FMath::FloorToInt32(Position * NumBuckets), 0, NumBuckets - 1);
+}
@@ -0,0 +1,230 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMServerOutputParser.h"
+
+namespace
+{
+	// Keep 10 minutes of history at the usual 1 Hz status rate
+	constexpr int32 StatusHistoryCapacity = 600;
+
+	const TCHAR* const ErrorPrefixes[] = {
+		TEXT("ERROR"),
+		TEXT("*** ERROR"),
+		TEXT("FAILURE IN SERVER"),
+		TEXT("exception in real time"),
+		TEXT("Server failed to start"),
+		TEXT("could not initialize audio"),
+	};
+
+	const TCHAR* const WarningPrefixes[] = {
+		TEXT("WARNING"),
+		TEXT("*** WARNING"),
+		TEXT("late "),		// scsynth: bundle arrived late, usually a sign of overload
+	};
+
+	const TCHAR* const ReadyMarkers[] = {
+		TEXT("SuperCollider 3 server ready"),
+	};
+
+	const TCHAR* const BootMarkers[] = {
+		TEXT("Booting server"),
+		TEXT("compiling class library"),
+		TEXT("Welcome to SuperCollider"),
+		TEXT("JackDriver:"),
+		TEXT("Shared memory server interface initialized"),
+		TEXT("' online"),		// Server 'localhost' online
+	};
+
+	template<int32 N>
+	bool StartsWithAny(const FString& Line, const TCHAR* const (&Prefixes)[N])
+	{
+		for (const TCHAR* Prefix : Prefixes)
+		{
+			if (Line.StartsWith(Prefix, ESearchCase::IgnoreCase))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template<int32 N>
+	bool ContainsAny(const FString& Line, const TCHAR* const (&Markers)[N])
+	{
+		for (const TCHAR* Marker : Markers)
+		{
+			if (Line.Contains(Marker, ESearchCase::IgnoreCase))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Reads the number that follows Key (separated by optional spaces, ':' or '=')
+	bool FindNumberAfter(const FString& Line, const TCHAR* Key, double& OutValue)
+	{
+		const int32 KeyPos = Line.Find(Key, ESearchCase::IgnoreCase);
+		if (KeyPos == INDEX_NONE)
+		{
+			return false;
+		}
+		const TCHAR* Cursor = *Line + KeyPos + FCString::Strlen(Key);
+		while (*Cursor == TEXT(' ') || *Cursor == TEXT(':') || *Cursor == TEXT('=') || *Cursor == TEXT('\t'))
+		{
+			++Cursor;
+		}
+		if (!FChar::IsDigit(*Cursor) && !(*Cursor == TEXT('-') && FChar::IsDigit(Cursor[1])) && !(*Cursor == TEXT('.') && FChar::IsDigit(Cursor[1])))
+		{
+			return false;
+		}
+		OutValue = FCString::Atod(Cursor);
+		return true;
+	}
+}
+
+EAkMServerEventType FAkMServerOutputParser::ParseLine(const FString& Line, FAkMServerStatus& OutStatus)
+{
+	const FString Trimmed = Line.TrimStartAndEnd();
+	if (Trimmed.IsEmpty())
+	{
+		return EAkMServerEventType::None;
+	}
+
+	if (StartsWithAny(Trimmed, ErrorPrefixes))
+	{
+		return EAkMServerEventType::Error;
+	}
+	if (StartsWithAny(Trimmed, WarningPrefixes))
+	{
+		return EAkMServerEventType::Warning;
+	}
+	if (ParseStatusReplyDump(Trimmed, OutStatus) || ParseLabelledStatus(Trimmed, OutStatus))
+	{
+		return EAkMServerEventType::Status;
+	}
+	if (ContainsAny(Trimmed, ReadyMarkers))
+	{
+		return EAkMServerEventType::Ready;
+	}
+	if (ContainsAny(Trimmed, BootMarkers))
+	{
+		return EAkMServerEventType::Boot;
+	}
+	return EAkMServerEventType::None;
+}
+
+bool FAkMServerOutputParser::ParseStatusReplyDump(const FString& Line, FAkMServerStatus& OutStatus)
+{
+	const int32 AddressPos = Line.Find(TEXT("/status.reply"), ESearchCase::CaseSensitive);
+	if (AddressPos == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// [ "/status.reply", 1, ugens, synths, groups, synthdefs, avgCPU, peakCPU, nominalSR, actualSR ]
+	FString Args = Line.Mid(AddressPos + 13);
+	Args.ReplaceCharInline(TEXT('['), TEXT(' '));
+	Args.ReplaceCharInline(TEXT(']'), TEXT(' '));
+	Args.ReplaceCharInline(TEXT('"'), TEXT(' '));
+	TArray<FString> Values;
+	Args.ParseIntoArray(Values, TEXT(","), true);
+	for (FString& Value : Values)
+	{
+		Value.TrimStartAndEndInline();
+	}
+	Values.RemoveAll([](const FString& Value) { return Value.IsEmpty(); });
+	if (Values.Num() < 7)
+	{
+		return false;
+	}
+
+	OutStatus.NumUGens = FCString::Atoi(*Values[1]);
+	OutStatus.NumSynths = FCString::Atoi(*Values[2]);
+	OutStatus.NumGroups = FCString::Atoi(*Values[3]);
+	OutStatus.NumSynthDefs = FCString::Atoi(*Values[4]);
+	OutStatus.AvgCPU = FCString::Atof(*Values[5]);
+	OutStatus.PeakCPU = FCString::Atof(*Values[6]);
+	return true;
+}
+
+bool FAkMServerOutputParser::ParseLabelledStatus(const FString& Line, FAkMServerStatus& OutStatus)
+{
+	double AvgCPU = 0.0;
+	double PeakCPU = 0.0;
+	const bool bHasAvg = FindNumberAfter(Line, TEXT("avgCPU"), AvgCPU) || FindNumberAfter(Line, TEXT("avg CPU"), AvgCPU);
+	const bool bHasPeak = FindNumberAfter(Line, TEXT("peakCPU"), PeakCPU) || FindNumberAfter(Line, TEXT("peak CPU"), PeakCPU);
+	if (!bHasAvg && !bHasPeak)
+	{
+		return false;
+	}
+
+	double Value = 0.0;
+	OutStatus.NumUGens = FindNumberAfter(Line, TEXT("UGens"), Value) ? int32(Value) : 0;
+	OutStatus.NumSynths = FindNumberAfter(Line, TEXT("Synths"), Value) ? int32(Value) : 0;
+	OutStatus.NumGroups = FindNumberAfter(Line, TEXT("Groups"), Value) ? int32(Value) : 0;
+	OutStatus.NumSynthDefs = FindNumberAfter(Line, TEXT("SynthDefs"), Value) ? int32(Value) : 0;
+	OutStatus.AvgCPU = float(AvgCPU);
+	OutStatus.PeakCPU = float(PeakCPU);
+	return true;
+}
+
+FAkMServerOutputStats::FAkMServerOutputStats()
+	: StatusHistory(StatusHistoryCapacity)
+{
+}
+
+EAkMServerEventType FAkMServerOutputStats::Ingest(const FString& Line, uint64 LineNumber)
+{
+	FAkMServerStatus Status;
+	const EAkMServerEventType Type = FAkMServerOutputParser::ParseLine(Line, Status);
+	switch (Type)
+	{
+	case EAkMServerEventType::Error:
+		AddError(LineNumber);
+		break;
+	case EAkMServerEventType::Warning:
+		++NumWarnings;
+		break;
+	case EAkMServerEventType::Ready:
+		bServerReady = true;
+		ServerReadyTime = FPlatformTime::Seconds();
+		break;
+	case EAkMServerEventType::Status:
+		AddStatus(Status);
+		break;
+	default:
+		break;
+	}
+	return Type;
+}
+
+void FAkMServerOutputStats::AddError(uint64 LineNumber)
+{
+	++NumErrors;
+	ErrorLineNumbers.Add(LineNumber);
+	if (ErrorLineNumbers.Num() > MaxIndexedErrors)
+	{
+		ErrorLineNumbers.RemoveAt(0, ErrorLineNumbers.Num() - MaxIndexedErrors, EAllowShrinking::No);
+	}
+}
+
+void FAkMServerOutputStats::AddStatus(FAkMServerStatus Status)
+{
+	Status.Time = FPlatformTime::Seconds();
+	LastStatus = Status;
+	StatusHistory.Add(Status);
+	++NumStatusReplies;
+}
+
+void FAkMServerOutputStats::Reset()
+{
+	NumErrors = 0;
+	NumWarnings = 0;
+	NumStatusReplies = 0;
+	bServerReady = false;
+	ServerReadyTime = 0.0;
+	LastStatus = FAkMServerStatus();
+	StatusHistory.Reset();
+	ErrorLineNumbers.Reset();
+}
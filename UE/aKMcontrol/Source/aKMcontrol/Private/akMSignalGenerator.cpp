@@ -0,0 +1,235 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMSignalGenerator.h"
+
+namespace
+{
+	// Raised-cosine fade at both ends of a sweep
+	constexpr double SweepTaperSeconds = 0.005;
+
+	// Stateless integer hash (lowbias32): white noise from a counter, so the loop has no carried dependency
+	FORCEINLINE uint32 HashNoise(uint32 X)
+	{
+		X ^= X >> 16;
+		X *= 0x7feb352du;
+		X ^= X >> 15;
+		X *= 0x846ca68bu;
+		X ^= X >> 16;
+		return X;
+	}
+}
+
+FAkMSignalGenerator::FAkMSignalGenerator()
+{
+	const FAkMSweepSettings Defaults;
+	RequestedSweepStartHz.store(Defaults.StartHz);
+	RequestedSweepEndHz.store(Defaults.EndHz);
+	RequestedSweepSeconds.store(Defaults.Seconds);
+	RequestedSweepGapSeconds.store(Defaults.GapSeconds);
+
+	for (int32 k = 0; k < FadeFrames; ++k)
+	{
+		FadeIn[k] = FMath::Sin(HALF_PI * (k + 0.5f) / FadeFrames);
+	}
+}
+
+const TCHAR* FAkMSignalGenerator::GetSignalName(EAkMTestSignal Signal)
+{
+	switch (Signal)
+	{
+	case EAkMTestSignal::Off:		return TEXT("Off");
+	case EAkMTestSignal::PinkNoise:	return TEXT("Pink noise");
+	case EAkMTestSignal::Sweep:		return TEXT("Sine sweep");
+	case EAkMTestSignal::Pulse:		return TEXT("Pulse");
+	default:						return TEXT("?");
+	}
+}
+
+void FAkMSignalGenerator::SetSweep(const FAkMSweepSettings& Settings)
+{
+	const float StartHz = FMath::Max(Settings.StartHz, 1.0f);
+	RequestedSweepStartHz.store(StartHz, std::memory_order_relaxed);
+	RequestedSweepEndHz.store(FMath::Max(Settings.EndHz, StartHz * 1.01f), std::memory_order_relaxed);
+	RequestedSweepSeconds.store(FMath::Max(Settings.Seconds, 0.1f), std::memory_order_relaxed);
+	RequestedSweepGapSeconds.store(FMath::Max(Settings.GapSeconds, 0.0f), std::memory_order_relaxed);
+}
+
+bool FAkMSignalGenerator::IsSwitching() const
+{
+	return AppliedSignal.load(std::memory_order_acquire) != RequestedSignal.load(std::memory_order_relaxed)
+		|| AppliedChannel.load(std::memory_order_acquire) != RequestedChannel.load(std::memory_order_relaxed);
+}
+
+void FAkMSignalGenerator::RenderSweep(const FAkMSweepSettings& Settings, int32 SampleRate, int64 StartFrame, float* Out, int32 NumFrames)
+{
+	// Phase of an exponential sweep (Farina): 2 pi f1 T / L * (exp(t L / T) - 1), L = ln(f2 / f1)
+	const int64 SweepFrames = Settings.GetSweepFrames(SampleRate);
+	const double Seconds = double(SweepFrames) / SampleRate;
+	const double L = FMath::Loge(double(Settings.EndHz) / Settings.StartHz);
+	const double K = 2.0 * PI * Settings.StartHz * Seconds / L;
+	const double Rate = L / SweepFrames;
+	const int64 TaperFrames = FMath::Max<int64>(1, FMath::Min<int64>(SweepFrames / 2, int64(SweepTaperSeconds * SampleRate)));
+
+	const int32 First = int32(FMath::Clamp<int64>(-StartFrame, 0, NumFrames));
+	const int32 End = int32(FMath::Clamp<int64>(SweepFrames - StartFrame, 0, NumFrames));
+	FMemory::Memzero(Out, First * sizeof(float));
+	for (int32 i = First; i < End; ++i)
+	{
+		const int64 n = StartFrame + i;
+		const int64 Edge = FMath::Min(n, SweepFrames - 1 - n);
+		const double Taper = Edge < TaperFrames ? 0.5 - 0.5 * FMath::Cos(PI * double(Edge) / TaperFrames) : 1.0;
+		Out[i] = float(FMath::Sin(K * (FMath::Exp(n * Rate) - 1.0)) * Taper);
+	}
+	FMemory::Memzero(Out + FMath::Max(First, End), (NumFrames - FMath::Max(First, End)) * sizeof(float));
+}
+
+void FAkMSignalGenerator::Generate(EAkMTestSignal Signal, float* Out, int32 NumFrames, int32 SampleRate)
+{
+	switch (Signal)
+	{
+	case EAkMTestSignal::PinkNoise:
+	{
+		const uint32 Seed = Pink.Seed;
+		for (int32 i = 0; i < NumFrames; ++i)
+		{
+			Out[i] = int32(HashNoise(Seed + uint32(i))) * (1.0f / 2147483648.0f);
+		}
+		Pink.Seed = Seed + uint32(NumFrames);
+
+		// Paul Kellet's refined pink filter (+-0.05 dB above 9.2 Hz at 44.1 kHz), scaled to about unit peak
+		float* B = Pink.B;
+		for (int32 i = 0; i < NumFrames; ++i)
+		{
+			const float White = Out[i];
+			B[0] = 0.99886f * B[0] + White * 0.0555179f;
+			B[1] = 0.99332f * B[1] + White * 0.0750759f;
+			B[2] = 0.96900f * B[2] + White * 0.1538520f;
+			B[3] = 0.86650f * B[3] + White * 0.3104856f;
+			B[4] = 0.55000f * B[4] + White * 0.5329522f;
+			B[5] = -0.7616f * B[5] - White * 0.0168980f;
+			Out[i] = (B[0] + B[1] + B[2] + B[3] + B[4] + B[5] + B[6] + White * 0.5362f) * 0.11f;
+			B[6] = White * 0.115926f;
+		}
+		break;
+	}
+
+	case EAkMTestSignal::Sweep:
+		for (int32 Done = 0; Done < NumFrames;)
+		{
+			if (SweepPosition == 0)
+			{
+				Sweep.StartHz = RequestedSweepStartHz.load(std::memory_order_relaxed);
+				Sweep.EndHz = RequestedSweepEndHz.load(std::memory_order_relaxed);
+				Sweep.Seconds = RequestedSweepSeconds.load(std::memory_order_relaxed);
+				Sweep.GapSeconds = RequestedSweepGapSeconds.load(std::memory_order_relaxed);
+			}
+			const int64 Period = FMath::Max<int64>(Sweep.GetPeriodFrames(SampleRate), 1);
+			const int32 Count = int32(FMath::Min<int64>(NumFrames - Done, Period - SweepPosition));
+			RenderSweep(Sweep, SampleRate, SweepPosition, Out + Done, Count);
+			SweepPosition = (SweepPosition + Count) % Period;
+			Done += Count;
+		}
+		break;
+
+	case EAkMTestSignal::Pulse:
+	{
+		const int64 Period = FMath::Max<int64>(int64(PulsePeriodSeconds * SampleRate), 1);
+		FMemory::Memzero(Out, NumFrames * sizeof(float));
+		for (int64 i = (Period - PulsePosition) % Period; i < NumFrames; i += Period)
+		{
+			Out[i] = 1.0f;
+		}
+		PulsePosition = (PulsePosition + NumFrames) % Period;
+		break;
+	}
+
+	default:
+		FMemory::Memzero(Out, NumFrames * sizeof(float));
+		break;
+	}
+}
+
+void FAkMSignalGenerator::Render(float* const* OutputData, int32 NumChannels, int32 NumFrames, int32 SampleRate)
+{
+	if (FadePosition == INDEX_NONE)
+	{
+		const EAkMTestSignal Signal = RequestedSignal.load(std::memory_order_relaxed);
+		const int32 Channel = RequestedChannel.load(std::memory_order_relaxed);
+		if (Signal != CurrentSignal || Channel != CurrentChannel)
+		{
+			NextSignal = Signal;
+			NextChannel = Channel;
+			FadePosition = 0;
+		}
+	}
+
+	const float TargetGain = RequestedGain.load(std::memory_order_relaxed);
+	if (CurrentSignal == EAkMTestSignal::Off && FadePosition == INDEX_NONE)
+	{
+		Gain = TargetGain;
+		return;
+	}
+	auto ChannelBuffer = [OutputData, NumChannels](EAkMTestSignal Signal, int32 Channel, int32 First) -> float*
+	{
+		return Signal != EAkMTestSignal::Off && Channel >= 0 && Channel < NumChannels && OutputData[Channel] ? OutputData[Channel] + First : nullptr;
+	};
+
+	const float GainStep = (TargetGain - Gain) / NumFrames;
+	for (int32 First = 0; First < NumFrames; First += ChunkFrames)
+	{
+		const int32 Count = FMath::Min(ChunkFrames, NumFrames - First);
+		if (CurrentSignal != EAkMTestSignal::Off)
+		{
+			Generate(CurrentSignal, CurrentBuffer, Count, SampleRate);
+		}
+		float* Out = ChannelBuffer(CurrentSignal, CurrentChannel, First);
+		const float* Source = CurrentBuffer;
+		int32 i = 0;
+
+		if (FadePosition != INDEX_NONE)
+		{
+			// The same signal moving channel keeps its stream; a new signal runs alongside the old one
+			const float* Incoming = CurrentBuffer;
+			if (NextSignal != CurrentSignal && NextSignal != EAkMTestSignal::Off)
+			{
+				Generate(NextSignal, NextBuffer, Count, SampleRate);
+				Incoming = NextBuffer;
+			}
+			float* NextOut = ChannelBuffer(NextSignal, NextChannel, First);
+			const int32 FadeCount = FMath::Min(Count, FadeFrames - FadePosition);
+			for (; i < FadeCount; ++i)
+			{
+				const float Level = Gain + GainStep * (First + i);
+				const int32 k = FadePosition + i;
+				if (Out)
+				{
+					Out[i] += Source[i] * Level * FadeIn[FadeFrames - 1 - k];
+				}
+				if (NextOut)
+				{
+					NextOut[i] += Incoming[i] * Level * FadeIn[k];
+				}
+			}
+			FadePosition += FadeCount;
+			if (FadePosition >= FadeFrames)
+			{
+				CurrentSignal = NextSignal;
+				CurrentChannel = NextChannel;
+				FadePosition = INDEX_NONE;
+				AppliedSignal.store(CurrentSignal, std::memory_order_release);
+				AppliedChannel.store(CurrentChannel, std::memory_order_release);
+				Out = NextOut;
+				Source = Incoming;
+			}
+		}
+
+		if (Out)
+		{
+			for (; i < Count; ++i)
+			{
+				Out[i] += Source[i] * (Gain + GainStep * (First + i));
+			}
+		}
+	}
+	Gain = TargetGain;
+}
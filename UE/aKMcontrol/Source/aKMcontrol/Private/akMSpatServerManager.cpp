@@ -7,6 +7,12 @@
 #include "HAL/PlatformProcess.h"
 #include "Engine/Engine.h"
 #include "UEJackAudioLinkSubsystem.h"
+#include "akMJackGraphSubsystem.h"
+#include "akMAudioTap.h"
+#include "Algo/Count.h"
+#include "OSCClient.h"
+#include "OSCManager.h"
+#include "OSCServer.h"
 
 DEFINE_LOG_CATEGORY(LogSpatServer);
 DEFINE_LOG_CATEGORY(LogAkMOSC);
@@ -29,85 +35,897 @@ void AakMSpatServerManager::BeginPlay()
 {
 	Super::BeginPlay();
 
+	// MaxConsoleLines may have been changed after construction
+	ImGuiConsoleBuffer.SetMaxLines(MaxConsoleLines);
+
+	if (bEnablePatchbay)
+	{
+		LoadPatchbayProfiles();
+	}
+
+	// A manager on an override graph shares the process with the real one; it must not touch JACK, OSC or the tap.
+	// Every per-frame step (output pumps, heartbeat, status poll, probe, player, generator, alignment) does one of
+	// those, so it does not tick at all
+	if (JackGraphOverride)
+	{
+		UnrealJackClientName = JackGraphOverride->GetUnrealClientName();
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	ProcessSampler = MakeUnique<FAkMProcessSampler>(ProcessSampleIntervalSeconds, ProcessHistoryCapacity);
+	ProcessSampler->Start();
+
 	// Bind to UEJackAudioLink events
 	if (GEngine)
 	{
-		if (UUEJackAudioLinkSubsystem* Subsystem = GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>())
+		if (UUEJackAudioLinkSubsystem* Subsystem = GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>())
+		{
+			Subsystem->OnNewJackClientConnected.AddDynamic(this, &AakMSpatServerManager::HandleNewJackClientConnected);
+			Subsystem->OnJackClientDisconnected.AddDynamic(this, &AakMSpatServerManager::HandleJackClientDisconnected);
+		}
+	}
+	if (UakMJackGraphSubsystem* JackGraph = GetJackGraph())
+	{
+		UnrealJackClientName = JackGraph->GetUnrealClientName();
+	}
+
+	if (bSendOSCFromManager)
+	{
+		ServerOSCClient = UOSCManager::CreateOSCClient(ServerOSCAddress, ActiveServerOSCPort, TEXT("akMServer"), this);
+	}
+	HeartbeatOSCServer = UOSCManager::CreateOSCServer(TEXT("127.0.0.1"), HeartbeatReplyPort, false, true, TEXT("akMHeartbeat"), this);
+	if (HeartbeatOSCServer)
+	{
+		HeartbeatOSCServer->OnOscMessageReceived.AddDynamic(this, &AakMSpatServerManager::HandleHeartbeatOSCMessage);
+	}
+	else
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Could not listen for heartbeat replies on port %d; stall detection is off."), HeartbeatReplyPort);
+	}
+}
+
+// Called every frame
+void AakMSpatServerManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (JackGraphOverride)
+	{
+		return;
+	}
+
+	PumpSpatServerOutput();
+	PumpStandbyOutput();
+	TickHeartbeat();
+	TickStatusPoll();
+	SyncLoudnessLayout();
+	TickLatencyProbe();
+	TickFilePlayer();
+	TickCalibration();
+	TickSpeakerAlignment();
+
+	// Heartbeat loss of a running server: fail over if a standby is waiting
+	if (bIsServerRunning && bWasServerAlive && !bIsServerAlive)
+	{
+		TryFailoverToStandby(TEXT("heartbeat lost"));
+	}
+	if (bAwaitingPromotedHeartbeat && bIsServerAlive)
+	{
+		bAwaitingPromotedHeartbeat = false;
+		LastFailoverRecoveryMs = float((FPlatformTime::Seconds() - FailoverStartTime) * 1000.0);
+		UE_LOG(LogSpatServer, Log, TEXT("Promoted server answered heartbeat %.1f ms after failover started."), LastFailoverRecoveryMs);
+	}
+	bWasServerAlive = bIsServerAlive;
+
+	// Keep a standby booted while the active server runs
+	if (bEnableHotStandby && bIsServerRunning && !bStandbyRunning)
+	{
+		StartStandbyProcess();
+	}
+}
+
+void AakMSpatServerManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (JackGraphOverride)
+	{
+		DisconnectAllConnectionsToUnreal();
+		Super::EndPlay(EndPlayReason);
+		return;
+	}
+
+	// Unbind UEJackAudioLink events
+	if (GEngine)
+	{
+		if (UUEJackAudioLinkSubsystem* Subsystem = GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>())
+		{
+			Subsystem->OnNewJackClientConnected.RemoveDynamic(this, &AakMSpatServerManager::HandleNewJackClientConnected);
+			Subsystem->OnJackClientDisconnected.RemoveDynamic(this, &AakMSpatServerManager::HandleJackClientDisconnected);
+		}
+	}
+
+	FAkMAudioTap::Get().GetLatencyProbe().Cancel();
+	FAkMAudioTap::Get().GetFilePlayer().StopPlayback();
+	FAkMAudioTap::Get().GetSignalGenerator().SetSignal(EAkMTestSignal::Off);
+	FAkMAudioTap::Get().GetSweepMeasurement().Cancel();
+
+	// Disconnect all connections involving our Unreal JACK client so next run starts clean
+	DisconnectAllConnectionsToUnreal();
+	bLatencyProbeWired = false;
+	FilePlayerConnections.Reset();
+	WiredCalibrationSpeaker = INDEX_NONE;
+	CalibrationReleaseOutput = INDEX_NONE;
+	CalibrationConnections[0] = CalibrationConnections[1] = FAkMJackConnection();
+	AlignmentSpeaker = INDEX_NONE;
+	bAlignmentAnalyzing = false;
+	AlignmentMicInput = INDEX_NONE;
+	AlignmentMicConnection = AlignmentSpeakerConnection = FAkMJackConnection();
+
+	StopSpatServerProcess();
+
+	if (ProcessSampler)
+	{
+		ProcessSampler->StopAndWait();
+		ProcessSampler.Reset();
+	}
+	if (HeartbeatOSCServer)
+	{
+		HeartbeatOSCServer->Stop();
+		HeartbeatOSCServer = nullptr;
+	}
+	ServerOSCClient = nullptr;
+	Super::EndPlay(EndPlayReason);
+}
+void AakMSpatServerManager::DisconnectAllConnectionsToUnreal()
+{
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (!JackGraph)
+	{
+		return;
+	}
+	const FString UnrealClient = JackGraph->GetUnrealClientName();
+	if (UnrealClient.IsEmpty())
+	{
+		return;
+	}
+
+	// Every live connection goes, including ones made outside the app, so the next run starts clean
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 NumRemoved = JackGraph->DisconnectClient(UnrealClient);
+	UE_LOG(LogSpatServer, Log, TEXT("Disconnected %d connections from Unreal JACK client in %.2f ms."), NumRemoved, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	// Clear our internal mappings
+	UnrealInputAllocator.Reset();
+	ScsynthInputsByClient.Reset();
+	ConnectedUnrealInputIndicesByClient.Reset();
+	ConnectedUnrealInputIndicesFromScsynth.Reset();
+}
+
+UakMJackGraphSubsystem* AakMSpatServerManager::GetJackGraph() const
+{
+	if (JackGraphOverride)
+	{
+		return JackGraphOverride;
+	}
+	return GEngine ? GEngine->GetEngineSubsystem<UakMJackGraphSubsystem>() : nullptr;
+}
+
+void AakMSpatServerManager::SyncUnrealInputAllocator()
+{
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	int32 NumInputs = 0;
+	int32 NumOutputs = 0;
+	if (JackGraph && JackGraph->GetPortCounts(UnrealJackClientName, NumInputs, NumOutputs))
+	{
+		UnrealInputAllocator.SetNumPorts(NumInputs);
+	}
+}
+
+void AakMSpatServerManager::SyncLoudnessLayout()
+{
+	if (LoudnessLayoutInputs == ConnectedUnrealInputIndicesFromScsynth)
+	{
+		return;
+	}
+	LoudnessLayoutInputs = ConnectedUnrealInputIndicesFromScsynth;
+
+	// Same grouping as the speaker meters in AImGuiActor; subs are excluded from the master as LFE is in BS.1770
+	const int32 NumGroups = FMath::DivideAndRoundUp(LoudnessLayoutInputs.Num(), 3);
+	TArray<TArray<int32>> ChannelsByGroup;
+	TArray<bool> GroupInMaster;
+	ChannelsByGroup.SetNum(NumGroups);
+	GroupInMaster.Init(true, NumGroups);
+	for (int32 i = 0; i < LoudnessLayoutInputs.Num(); ++i)
+	{
+		ChannelsByGroup[i / 3].Add(LoudnessLayoutInputs[i] - 1);
+	}
+	if (NumGroups > 1)
+	{
+		GroupInMaster.Last() = false;
+	}
+	FAkMAudioTap::Get().GetLoudnessMeter().SetLayout(ChannelsByGroup, GroupInMaster);
+}
+
+AakMSpatServerManager::EUnrealOutputUser AakMSpatServerManager::FindUnrealOutputUser(int32 Output1Based, EUnrealOutputUser Ignore) const
+{
+	FAkMAudioTap& Tap = FAkMAudioTap::Get();
+	auto Uses = [Ignore](EUnrealOutputUser User, bool bUsing)
+	{
+		return User != Ignore && bUsing;
+	};
+	if (Uses(EUnrealOutputUser::LatencyProbe, Tap.GetLatencyProbe().IsBusy() && Output1Based == LatencyProbeUnrealOutput))
+	{
+		return EUnrealOutputUser::LatencyProbe;
+	}
+	const int32 FileChannel = Output1Based - FilePlayerFirstUnrealOutput;
+	if (Uses(EUnrealOutputUser::FilePlayer, Tap.GetFilePlayer().IsPlaying() && FilePlayerSourceIds.IsValidIndex(FileChannel) && FilePlayerSourceIds[FileChannel] >= 1))
+	{
+		return EUnrealOutputUser::FilePlayer;
+	}
+	const bool bGeneratorOn = CalibrationSignal != EAkMTestSignal::Off || WiredCalibrationSpeaker != INDEX_NONE;
+	if (Uses(EUnrealOutputUser::CalibrationGenerator, bGeneratorOn && (Output1Based == CalibrationUnrealOutputA || Output1Based == CalibrationUnrealOutputB)))
+	{
+		return EUnrealOutputUser::CalibrationGenerator;
+	}
+	if (Uses(EUnrealOutputUser::SpeakerAlignment, IsSpeakerAlignmentRunning() && Output1Based == CalibrationUnrealOutputA))
+	{
+		return EUnrealOutputUser::SpeakerAlignment;
+	}
+	return EUnrealOutputUser::None;
+}
+
+const TCHAR* AakMSpatServerManager::GetUnrealOutputUserName(EUnrealOutputUser User)
+{
+	switch (User)
+	{
+	case EUnrealOutputUser::LatencyProbe:			return TEXT("the latency probe");
+	case EUnrealOutputUser::FilePlayer:				return TEXT("the file player");
+	case EUnrealOutputUser::CalibrationGenerator:	return TEXT("the calibration generator");
+	case EUnrealOutputUser::SpeakerAlignment:		return TEXT("the speaker alignment");
+	default:										return TEXT("nothing");
+	}
+}
+
+bool AakMSpatServerManager::StartLatencyMeasurement()
+{
+	FAkMLatencyProbe& Probe = FAkMAudioTap::Get().GetLatencyProbe();
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (!JackGraph || Probe.IsBusy() || ActiveServerJackClientName.IsEmpty() || UnrealJackClientName.IsEmpty() || ConnectedUnrealInputIndicesFromScsynth.IsEmpty())
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Latency measurement needs a running server wired to the Unreal inputs and no measurement in progress."));
+		return false;
+	}
+	const EUnrealOutputUser OutputUser = FindUnrealOutputUser(LatencyProbeUnrealOutput, EUnrealOutputUser::LatencyProbe);
+	if (OutputUser != EUnrealOutputUser::None)
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Unreal output #%d is in use by %s; latency measurement not started."), LatencyProbeUnrealOutput, GetUnrealOutputUserName(OutputUser));
+		return false;
+	}
+
+	// Wire the probe output to the scsynth input unless it already is (then it stays wired afterwards)
+	bLatencyProbeWired = false;
+	if (!JackGraph->IsConnectedByIndex(UnrealJackClientName, LatencyProbeUnrealOutput, ActiveServerJackClientName, LatencyProbeServerInput))
+	{
+		FAkMJackRoutingTransaction Transaction;
+		if (!JackGraph->AddConnectByIndex(Transaction, UnrealJackClientName, LatencyProbeUnrealOutput, ActiveServerJackClientName, LatencyProbeServerInput)
+			|| JackGraph->ApplyRouting(Transaction) > 0)
+		{
+			UE_LOG(LogSpatServer, Warning, TEXT("Could not connect Unreal output #%d to %s input #%d for the latency probe."), LatencyProbeUnrealOutput, *ActiveServerJackClientName, LatencyProbeServerInput);
+			return false;
+		}
+		LatencyProbeConnection = Transaction.Connects[0];
+		bLatencyProbeWired = true;
+	}
+
+	TArray<int32> Channels;
+	Channels.Reserve(ConnectedUnrealInputIndicesFromScsynth.Num());
+	for (const int32 Index1Based : ConnectedUnrealInputIndicesFromScsynth)
+	{
+		Channels.Add(Index1Based - 1);
+	}
+	if (!Probe.Start(LatencyProbeUnrealOutput - 1, Channels, LatencyProbeLevelDb))
+	{
+		DisconnectLatencyProbe();
+		return false;
+	}
+	return true;
+}
+
+void AakMSpatServerManager::ResetLatencyBaseline()
+{
+	LatencyBaselineSamples.Reset();
+	bLatencyDrift = false;
+}
+
+bool AakMSpatServerManager::IsLatencyMeasurementRunning() const
+{
+	return FAkMAudioTap::Get().GetLatencyProbe().IsBusy();
+}
+
+void AakMSpatServerManager::DisconnectLatencyProbe()
+{
+	if (!bLatencyProbeWired)
+	{
+		return;
+	}
+	bLatencyProbeWired = false;
+	if (UakMJackGraphSubsystem* JackGraph = GetJackGraph())
+	{
+		FAkMJackRoutingTransaction Transaction;
+		Transaction.Disconnect(LatencyProbeConnection.Source, LatencyProbeConnection.Destination);
+		JackGraph->ApplyRouting(Transaction);
+	}
+}
+
+void AakMSpatServerManager::TickLatencyProbe()
+{
+	FAkMLatencyProbe& Probe = FAkMAudioTap::Get().GetLatencyProbe();
+	const bool bHaveResults = Probe.Tick();
+
+	// The marker has been captured (or timed out) once the probe no longer plays
+	if (bLatencyProbeWired && Probe.GetState() != EAkMLatencyProbeState::Armed && Probe.GetState() != EAkMLatencyProbeState::Running)
+	{
+		DisconnectLatencyProbe();
+	}
+
+	if (bHaveResults)
+	{
+		LatencyResults = Probe.GetResults();
+		LatencySampleRate = Probe.GetResultSampleRate();
+		LastLatencyMeasurementTime = FPlatformTime::Seconds();
+
+		if (LatencyBaselineSamples.Num() != LatencyResults.Num())
+		{
+			LatencyBaselineSamples.Reset();
+			for (const FAkMLatencyResult& Result : LatencyResults)
+			{
+				LatencyBaselineSamples.Add(Result.LatencySamples);
+			}
+		}
+
+		int32 NumDetected = 0;
+		int32 NumDrifted = 0;
+		for (int32 i = 0; i < LatencyResults.Num(); ++i)
+		{
+			const int32 Latency = LatencyResults[i].LatencySamples;
+			if (Latency == INDEX_NONE)
+			{
+				continue;
+			}
+			++NumDetected;
+			if (LatencyBaselineSamples[i] == INDEX_NONE)
+			{
+				LatencyBaselineSamples[i] = Latency;
+			}
+			else if (FMath::Abs(Latency - LatencyBaselineSamples[i]) > LatencyDriftToleranceSamples)
+			{
+				++NumDrifted;
+				UE_LOG(LogSpatServer, Warning, TEXT("Latency drift on Unreal input #%d: %d samples (baseline %d)."), LatencyResults[i].Channel + 1, Latency, LatencyBaselineSamples[i]);
+			}
+		}
+		bLatencyDrift = NumDrifted > 0;
+		LatencyDriftAlarmCount += NumDrifted > 0 ? 1 : 0;
+		UE_LOG(LogSpatServer, Log, TEXT("Latency measured on %d of %d speaker feeds at %d Hz."), NumDetected, LatencyResults.Num(), LatencySampleRate);
+	}
+
+	// Background measurements, only while the server feeds the Unreal inputs
+	const double Now = FPlatformTime::Seconds();
+	if (bEnablePeriodicLatencyProbe && bIsServerRunning && bAKMserverAudioOutputPortsConnected && !Probe.IsBusy() && Now >= NextPeriodicLatencyProbeTime)
+	{
+		NextPeriodicLatencyProbeTime = Now + FMath::Max(LatencyProbeIntervalSeconds, 5.0f);
+		StartLatencyMeasurement();
+	}
+}
+
+bool AakMSpatServerManager::StartFilePlayback(const FString& FilePath, const TArray<int32>& SourceIds, bool bLoop)
+{
+	FAkMFilePlayer& Player = FAkMAudioTap::Get().GetFilePlayer();
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (!JackGraph || Player.IsPlaying() || ActiveServerJackClientName.IsEmpty() || UnrealJackClientName.IsEmpty())
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("File playback needs a running server and no file already playing."));
+		return false;
+	}
+
+	// Every output the file needs must be clear of the probe, the generator and the alignment
+	for (int32 c = 0; c < SourceIds.Num(); ++c)
+	{
+		const EUnrealOutputUser OutputUser = SourceIds[c] >= 1 ? FindUnrealOutputUser(FilePlayerFirstUnrealOutput + c, EUnrealOutputUser::FilePlayer) : EUnrealOutputUser::None;
+		if (OutputUser != EUnrealOutputUser::None)
+		{
+			UE_LOG(LogSpatServer, Warning, TEXT("Unreal output #%d (file channel %d) is in use by %s; file playback not started."), FilePlayerFirstUnrealOutput + c, c + 1, GetUnrealOutputUserName(OutputUser));
+			return false;
+		}
+	}
+
+	TArray<int32> OutputChannels;
+	FAkMJackRoutingTransaction Transaction;
+	if (!AddFilePlayerRoutes(SourceIds, Transaction, OutputChannels))
+	{
+		return false;
+	}
+	const int32 NumFailed = JackGraph->ApplyRouting(Transaction);
+	FilePlayerConnections = Transaction.Connects;
+	if (NumFailed > 0)
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("%d file player connections failed."), NumFailed);
+		DisconnectFilePlayer();
+		return false;
+	}
+
+	if (!Player.StartPlayback(FilePath, OutputChannels, bLoop))
+	{
+		UE_LOG(LogSpatServer, Error, TEXT("Could not play '%s' (16/24/32-bit PCM or 32-bit float WAVE/RF64 expected)."), *FilePath);
+		DisconnectFilePlayer();
+		return false;
+	}
+	FilePlayerSourceIds = SourceIds;
+
+	const FAkMWaveFormat& Format = Player.GetFormat();
+	UE_LOG(LogSpatServer, Log, TEXT("Playing '%s': %d channels, %d Hz, %.1f s%s."), *FilePath, Format.NumChannels, Format.SampleRate,
+		Format.SampleRate > 0 ? double(Format.GetNumFrames()) / Format.SampleRate : 0.0, bLoop ? TEXT(", looping") : TEXT(""));
+	if (Format.NumChannels > SourceIds.Num())
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("File has %d channels but only %d are assigned to sources."), Format.NumChannels, SourceIds.Num());
+	}
+	return true;
+}
+
+bool AakMSpatServerManager::AddFilePlayerRoutes(const TArray<int32>& SourceIds, FAkMJackRoutingTransaction& Transaction, TArray<int32>& OutOutputChannels)
+{
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (!JackGraph)
+	{
+		return false;
+	}
+
+	// Unreal output FilePlayerFirstUnrealOutput + N to the source's scsynth input, in one transaction
+	OutOutputChannels.Reset(SourceIds.Num());
+	for (int32 c = 0; c < SourceIds.Num(); ++c)
+	{
+		const int32 UnrealOutput = FilePlayerFirstUnrealOutput + c;
+		if (SourceIds[c] < 1)
+		{
+			OutOutputChannels.Add(INDEX_NONE);
+			continue;
+		}
+		OutOutputChannels.Add(UnrealOutput - 1);
+		if (!JackGraph->IsConnectedByIndex(UnrealJackClientName, UnrealOutput, ActiveServerJackClientName, SourceIds[c])
+			&& !JackGraph->AddConnectByIndex(Transaction, UnrealJackClientName, UnrealOutput, ActiveServerJackClientName, SourceIds[c]))
+		{
+			UE_LOG(LogSpatServer, Warning, TEXT("Could not route Unreal output #%d to %s input #%d for file channel %d."), UnrealOutput, *ActiveServerJackClientName, SourceIds[c], c + 1);
+			return false;
+		}
+	}
+	return true;
+}
+
+void AakMSpatServerManager::RerouteFilePlayer()
+{
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (!JackGraph || !IsFilePlaying())
+	{
+		return;
+	}
+
+	// The old server's connections go with it; the file keeps playing into the same inputs of the new one
+	FAkMJackRoutingTransaction Transaction;
+	for (const FAkMJackConnection& Connection : FilePlayerConnections)
+	{
+		Transaction.Disconnect(Connection.Source, Connection.Destination);
+	}
+	TArray<int32> OutputChannels;
+	if (!AddFilePlayerRoutes(FilePlayerSourceIds, Transaction, OutputChannels))
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("File player could not follow the server to '%s'; stopping playback."), *ActiveServerJackClientName);
+		StopFilePlayback();
+		return;
+	}
+	const int32 NumFailed = JackGraph->ApplyRouting(Transaction);
+	FilePlayerConnections = Transaction.Connects;
+	UE_LOG(LogSpatServer, Log, TEXT("File player rerouted to '%s' (%d of %d connections failed)."), *ActiveServerJackClientName, NumFailed, Transaction.Num());
+}
+
+void AakMSpatServerManager::StopFilePlayback()
+{
+	FAkMAudioTap::Get().GetFilePlayer().StopPlayback();
+	DisconnectFilePlayer();
+	FilePlayerSourceIds.Reset();
+}
+
+bool AakMSpatServerManager::IsFilePlaying() const
+{
+	return FAkMAudioTap::Get().GetFilePlayer().IsPlaying();
+}
+
+void AakMSpatServerManager::DisconnectFilePlayer()
+{
+	if (FilePlayerConnections.IsEmpty())
+	{
+		return;
+	}
+	if (UakMJackGraphSubsystem* JackGraph = GetJackGraph())
+	{
+		FAkMJackRoutingTransaction Transaction;
+		for (const FAkMJackConnection& Connection : FilePlayerConnections)
+		{
+			Transaction.Disconnect(Connection.Source, Connection.Destination);
+		}
+		JackGraph->ApplyRouting(Transaction);
+	}
+	FilePlayerConnections.Reset();
+}
+
+void AakMSpatServerManager::TickFilePlayer()
+{
+	const FAkMFilePlayer& Player = FAkMAudioTap::Get().GetFilePlayer();
+	if (Player.IsPlaying() && Player.IsFinished())
+	{
+		UE_LOG(LogSpatServer, Log, TEXT("Finished playing '%s'."), *Player.GetFilePath());
+		StopFilePlayback();
+	}
+}
+
+void AakMSpatServerManager::ReleaseCalibrationOutput(int32 Output)
+{
+	FAkMJackConnection& Connection = CalibrationConnections[Output];
+	if (Connection.Source.IsEmpty())
+	{
+		return;
+	}
+	if (UakMJackGraphSubsystem* JackGraph = GetJackGraph())
+	{
+		FAkMJackRoutingTransaction Transaction;
+		Transaction.Disconnect(Connection.Source, Connection.Destination);
+		JackGraph->ApplyRouting(Transaction);
+	}
+	Connection = FAkMJackConnection();
+}
+
+void AakMSpatServerManager::TickCalibration()
+{
+	FAkMSignalGenerator& Generator = FAkMAudioTap::Get().GetSignalGenerator();
+	Generator.SetSignal(CalibrationSignal);
+	Generator.SetLevelDb(CalibrationLevelDb);
+	Generator.SetSweep(CalibrationSweep);
+
+	// Rewire only outputs the generator is not playing on
+	if (Generator.IsSwitching())
+	{
+		return;
+	}
+	if (CalibrationReleaseOutput != INDEX_NONE)
+	{
+		ReleaseCalibrationOutput(CalibrationReleaseOutput);
+		CalibrationReleaseOutput = INDEX_NONE;
+	}
+
+	const int32 Target = (CalibrationSignal != EAkMTestSignal::Off && CalibrationSpeakerPorts.IsValidIndex(CalibrationSpeaker)) ? CalibrationSpeaker : INDEX_NONE;
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (Target == WiredCalibrationSpeaker || !JackGraph)
+	{
+		return;
+	}
+
+	const int32 Output = WiredCalibrationSpeaker == INDEX_NONE ? CalibrationActiveOutput : 1 - CalibrationActiveOutput;
+	const int32 UnrealOutput = Output == 0 ? CalibrationUnrealOutputA : CalibrationUnrealOutputB;
+	if (Target != INDEX_NONE)
+	{
+		// Never play a test signal over the probe or a file; the request is dropped rather than retried every tick
+		const EUnrealOutputUser OutputUser = FindUnrealOutputUser(UnrealOutput, EUnrealOutputUser::CalibrationGenerator);
+		if (OutputUser != EUnrealOutputUser::None)
+		{
+			UE_LOG(LogSpatServer, Warning, TEXT("Unreal output #%d is in use by %s; calibration signal not routed."), UnrealOutput, GetUnrealOutputUserName(OutputUser));
+			CalibrationSpeaker = WiredCalibrationSpeaker;
+			return;
+		}
+		const FAkMJackGraph::FClient* Unreal = JackGraph->GetClient(UnrealJackClientName);
+		FAkMJackRoutingTransaction Transaction;
+		if (Unreal && Unreal->OutputPorts.IsValidIndex(UnrealOutput - 1))
+		{
+			Transaction.Connect(Unreal->OutputPorts[UnrealOutput - 1], CalibrationSpeakerPorts[Target]);
+		}
+		if (Transaction.IsEmpty() || JackGraph->ApplyRouting(Transaction) > 0)
+		{
+			UE_LOG(LogSpatServer, Warning, TEXT("Could not connect Unreal output #%d to '%s' for calibration."), UnrealOutput, *CalibrationSpeakerPorts[Target]);
+			CalibrationSpeaker = WiredCalibrationSpeaker;
+			return;
+		}
+		CalibrationConnections[Output] = Transaction.Connects[0];
+	}
+
+	// The audio thread crossfades to the new output; the old one is released once that is done
+	Generator.SetOutputChannel(Target != INDEX_NONE ? UnrealOutput - 1 : INDEX_NONE);
+	if (WiredCalibrationSpeaker != INDEX_NONE)
+	{
+		CalibrationReleaseOutput = CalibrationActiveOutput;
+	}
+	CalibrationActiveOutput = Output;
+	WiredCalibrationSpeaker = Target;
+}
+
+bool AakMSpatServerManager::StartSpeakerAlignment()
+{
+	FAkMSweepMeasurement& Measurement = FAkMAudioTap::Get().GetSweepMeasurement();
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	const int32 SampleRate = FAkMAudioTap::Get().GetSampleRate();
+	if (!JackGraph || IsSpeakerAlignmentRunning() || Measurement.IsBusy() || SampleRate <= 0 || UnrealJackClientName.IsEmpty())
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Speaker alignment needs running audio and no measurement in progress."));
+		return false;
+	}
+	if (CalibrationSignal != EAkMTestSignal::Off || WiredCalibrationSpeaker != INDEX_NONE)
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Turn the calibration generator off before aligning the speakers."));
+		return false;
+	}
+	const EUnrealOutputUser OutputUser = FindUnrealOutputUser(CalibrationUnrealOutputA, EUnrealOutputUser::SpeakerAlignment);
+	if (OutputUser != EUnrealOutputUser::None)
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Unreal output #%d is in use by %s; speaker alignment not started."), CalibrationUnrealOutputA, GetUnrealOutputUserName(OutputUser));
+		return false;
+	}
+	const int32 NumSpeakers = FMath::Min(CalibrationSpeakerPorts.Num(), FAkMSweepMeasurement::MaxSpeakers);
+	if (!Measurement.Begin(CalibrationSweep, SampleRate, NumSpeakers, CalibrationLevelDb))
+	{
+		return false;
+	}
+
+	// The microphone gets an Unreal input of its own for the duration
+	const FAkMJackGraph::FClient* Unreal = JackGraph->GetClient(UnrealJackClientName);
+	TArray<int32> Inputs;
+	if (!Unreal || !UnrealInputAllocator.Allocate(AlignmentMicOwner, 1, Inputs) || !Unreal->InputPorts.IsValidIndex(Inputs[0] - 1))
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("No free Unreal input for the measurement microphone."));
+		UnrealInputAllocator.FreeOwner(AlignmentMicOwner);
+		return false;
+	}
+	FAkMJackRoutingTransaction Transaction;
+	Transaction.Connect(CalibrationMicPort, Unreal->InputPorts[Inputs[0] - 1]);
+	if (JackGraph->ApplyRouting(Transaction) > 0)
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Could not connect the measurement microphone '%s'."), *CalibrationMicPort);
+		UnrealInputAllocator.FreeOwner(AlignmentMicOwner);
+		return false;
+	}
+	AlignmentMicInput = Inputs[0];
+	AlignmentMicConnection = Transaction.Connects[0];
+
+	UE_LOG(LogSpatServer, Log, TEXT("Aligning %d speakers with %.1f s sweeps, microphone '%s' on Unreal input #%d."), NumSpeakers, CalibrationSweep.Seconds, *CalibrationMicPort, AlignmentMicInput);
+	// Advances to the first speaker
+	AlignmentSpeaker = -1;
+	MeasureNextAlignmentSpeaker();
+	return true;
+}
+
+void AakMSpatServerManager::CancelSpeakerAlignment()
+{
+	if (!IsSpeakerAlignmentRunning())
+	{
+		return;
+	}
+	FAkMAudioTap::Get().GetSweepMeasurement().Cancel();
+	UE_LOG(LogSpatServer, Log, TEXT("Speaker alignment cancelled."));
+	EndSpeakerAlignment();
+}
+
+void AakMSpatServerManager::EndSpeakerAlignment()
+{
+	FAkMJackRoutingTransaction Transaction;
+	for (FAkMJackConnection* Connection : { &AlignmentSpeakerConnection, &AlignmentMicConnection })
+	{
+		if (!Connection->Source.IsEmpty())
 		{
-			Subsystem->OnNewJackClientConnected.AddDynamic(this, &AakMSpatServerManager::HandleNewJackClientConnected);
-			Subsystem->OnJackClientDisconnected.AddDynamic(this, &AakMSpatServerManager::HandleJackClientDisconnected);
-			UnrealJackClientName = Subsystem->GetJackClientName();
+			Transaction.Disconnect(Connection->Source, Connection->Destination);
+			*Connection = FAkMJackConnection();
 		}
 	}
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (JackGraph && !Transaction.IsEmpty())
+	{
+		JackGraph->ApplyRouting(Transaction);
+	}
+	UnrealInputAllocator.FreeOwner(AlignmentMicOwner);
+	AlignmentMicInput = INDEX_NONE;
+	AlignmentSpeaker = INDEX_NONE;
+	bAlignmentAnalyzing = false;
 }
 
-// Called every frame
-void AakMSpatServerManager::Tick(float DeltaTime)
+void AakMSpatServerManager::MeasureNextAlignmentSpeaker()
 {
-	Super::Tick(DeltaTime);
+	FAkMSweepMeasurement& Measurement = FAkMAudioTap::Get().GetSweepMeasurement();
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	const FAkMJackGraph::FClient* Unreal = JackGraph ? JackGraph->GetClient(UnrealJackClientName) : nullptr;
+	if (!Unreal || !Unreal->OutputPorts.IsValidIndex(CalibrationUnrealOutputA - 1))
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Unreal output #%d is not available for the speaker alignment."), CalibrationUnrealOutputA);
+		EndSpeakerAlignment();
+		return;
+	}
 
-	PumpSpatServerOutput();
+	// Release the previous speaker before the next one is wired
+	FAkMJackRoutingTransaction Transaction;
+	if (!AlignmentSpeakerConnection.Source.IsEmpty())
+	{
+		Transaction.Disconnect(AlignmentSpeakerConnection.Source, AlignmentSpeakerConnection.Destination);
+		AlignmentSpeakerConnection = FAkMJackConnection();
+	}
+
+	const int32 NumSpeakers = FMath::Min(CalibrationSpeakerPorts.Num(), FAkMSweepMeasurement::MaxSpeakers);
+	++AlignmentSpeaker;
+	if (AlignmentSpeaker >= NumSpeakers)
+	{
+		JackGraph->ApplyRouting(Transaction);
+		AlignmentSpeaker = INDEX_NONE;
+		bAlignmentAnalyzing = Measurement.Analyze();
+		if (!bAlignmentAnalyzing)
+		{
+			EndSpeakerAlignment();
+		}
+		return;
+	}
+
+	const FString& OutputPort = Unreal->OutputPorts[CalibrationUnrealOutputA - 1];
+	Transaction.Connect(OutputPort, CalibrationSpeakerPorts[AlignmentSpeaker]);
+	if (JackGraph->ApplyRouting(Transaction) > 0 || !Measurement.MeasureSpeaker(AlignmentSpeaker, CalibrationUnrealOutputA - 1, AlignmentMicInput - 1))
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Could not measure speaker %d ('%s'); aborting the alignment."), AlignmentSpeaker + 1, *CalibrationSpeakerPorts[AlignmentSpeaker]);
+		AlignmentSpeakerConnection = FAkMJackConnection(OutputPort, CalibrationSpeakerPorts[AlignmentSpeaker]);
+		EndSpeakerAlignment();
+		return;
+	}
+	AlignmentSpeakerConnection = FAkMJackConnection(OutputPort, CalibrationSpeakerPorts[AlignmentSpeaker]);
 }
 
-void AakMSpatServerManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+void AakMSpatServerManager::TickSpeakerAlignment()
 {
-	// Unbind UEJackAudioLink events
-	if (GEngine)
+	if (!IsSpeakerAlignmentRunning())
 	{
-		if (UUEJackAudioLinkSubsystem* Subsystem = GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>())
+		return;
+	}
+	FAkMSweepMeasurement& Measurement = FAkMAudioTap::Get().GetSweepMeasurement();
+	const bool bHaveResults = Measurement.Tick();
+	if (bAlignmentAnalyzing)
+	{
+		if (bHaveResults)
 		{
-			Subsystem->OnNewJackClientConnected.RemoveDynamic(this, &AakMSpatServerManager::HandleNewJackClientConnected);
-			Subsystem->OnJackClientDisconnected.RemoveDynamic(this, &AakMSpatServerManager::HandleJackClientDisconnected);
+			ApplySpeakerAlignment();
+			EndSpeakerAlignment();
 		}
+		return;
 	}
 
-	// Disconnect all connections involving our Unreal JACK client so next run starts clean
-	DisconnectAllConnectionsToUnreal();
-
-	StopSpatServerProcess();
-	Super::EndPlay(EndPlayReason);
+	switch (Measurement.GetState())
+	{
+	case EAkMSweepMeasurementState::Captured:
+		MeasureNextAlignmentSpeaker();
+		break;
+	case EAkMSweepMeasurementState::Idle:
+		UE_LOG(LogSpatServer, Warning, TEXT("Speaker %d capture timed out (is audio running?); aborting the alignment."), AlignmentSpeaker + 1);
+		EndSpeakerAlignment();
+		break;
+	default:
+		break;
+	}
 }
-void AakMSpatServerManager::DisconnectAllConnectionsToUnreal()
+
+void AakMSpatServerManager::ApplySpeakerAlignment()
 {
-	UUEJackAudioLinkSubsystem* Subsystem = (GEngine ? GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>() : nullptr);
-	if (!Subsystem)
+	const FAkMSweepMeasurement& Measurement = FAkMAudioTap::Get().GetSweepMeasurement();
+	AlignmentResults = Measurement.GetResults();
+	AlignmentSampleRate = Measurement.GetSampleRate();
+
+	// Speakers are the satellites followed by the subs; delays line every arrival up with the latest one
+	const int32 NumSats = satsGains.Num();
+	int32 MaxDelay = INDEX_NONE;
+	for (const FAkMSpeakerMeasurement& Result : AlignmentResults)
 	{
-		return;
+		MaxDelay = FMath::Max(MaxDelay, Result.DelaySamples);
 	}
-	const FString UnrealClient = Subsystem->GetJackClientName();
-	if (UnrealClient.IsEmpty())
+	if (MaxDelay == INDEX_NONE)
 	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Speaker alignment found no speaker on '%s'; nothing changed."), *CalibrationMicPort);
 		return;
 	}
-	TArray<FString> UnrealInputs, UnrealOutputs;
-	Subsystem->GetClientPorts(UnrealClient, UnrealInputs, UnrealOutputs);
 
-	// To discover connections, iterate all other clients and try disconnect both directions
-	TArray<FString> Clients = Subsystem->GetConnectedClients();
-	for (const FString& Client : Clients)
+	// Levels: each group is brought down to its quietest speaker. The sweep goes straight to the speaker port, past
+	// scsynth and its gains, so the measured level is the raw one and the correction is the gain itself.
+	float MinSatsDb = TNumericLimits<float>::Max();
+	float MinSubsDb = TNumericLimits<float>::Max();
+	for (int32 s = 0; s < AlignmentResults.Num(); ++s)
 	{
-		if (Client.Equals(UnrealClient, ESearchCase::IgnoreCase)) { continue; }
-		TArray<FString> OtherInputs, OtherOutputs;
-		Subsystem->GetClientPorts(Client, OtherInputs, OtherOutputs);
-		for (const FString& UnrealOut : UnrealOutputs)
+		if (AlignmentResults[s].IsValid())
 		{
-			for (const FString& OtherIn : OtherInputs)
-			{
-				Subsystem->DisconnectPorts(UnrealOut, OtherIn);
-			}
+			float& MinDb = s < NumSats ? MinSatsDb : MinSubsDb;
+			MinDb = FMath::Min(MinDb, AlignmentResults[s].LevelDb);
+		}
+	}
+
+	int32 NumAligned = 0;
+	for (int32 s = 0; s < AlignmentResults.Num(); ++s)
+	{
+		const FAkMSpeakerMeasurement& Result = AlignmentResults[s];
+		const bool bSat = s < NumSats;
+		TArray<float>& Gains = bSat ? satsGains : subsGains;
+		TArray<float>& Delays = bSat ? satsDelaysMs : subsDelaysMs;
+		const int32 Index = bSat ? s : s - NumSats;
+		if (!Result.IsValid() || !Gains.IsValidIndex(Index) || !Delays.IsValidIndex(Index))
+		{
+			UE_LOG(LogSpatServer, Warning, TEXT("Speaker %d: no response (%.0f dB peak to noise); left unchanged."), s + 1, Result.PeakToNoiseDb);
+			continue;
+		}
+		const TCHAR* Prefix = bSat ? TEXT("sat") : TEXT("sub");
+		Delays[Index] = (MaxDelay - Result.DelaySamples) * 1000.0f / AlignmentSampleRate;
+		Gains[Index] = FMath::Clamp((bSat ? MinSatsDb : MinSubsDb) - Result.LevelDb, -90.0f, 30.0f);
+		SendOSCFloat(FString::Printf(TEXT("/%s%d/delay"), Prefix, Index + 1), Delays[Index]);
+		SendOSCFloat(FString::Printf(TEXT("/%s%d/gain"), Prefix, Index + 1), Gains[Index]);
+		UE_LOG(LogSpatServer, Log, TEXT("Speaker %d: arrival %.2f ms, level %.1f dB -> delay %.2f ms, gain %.1f dB."),
+			s + 1, Result.DelaySamples * 1000.0f / AlignmentSampleRate, Result.LevelDb, Delays[Index], Gains[Index]);
+		++NumAligned;
+	}
+	UE_LOG(LogSpatServer, Log, TEXT("Speaker alignment applied to %d of %d speakers."), NumAligned, AlignmentResults.Num());
+}
+
+void AakMSpatServerManager::GetUnrealInputsBySource(TArray<int32>& OutInputs, int32 NumSources) const
+{
+	OutInputs.Init(INDEX_NONE, NumSources);
+	// Both maps hold a client's connected channels in the same order
+	for (const TPair<FString, TArray<int32>>& Pair : ScsynthInputsByClient)
+	{
+		const TArray<int32>* UnrealInputs = ConnectedUnrealInputIndicesByClient.Find(Pair.Key);
+		if (!UnrealInputs)
+		{
+			continue;
 		}
-		for (const FString& OtherOut : OtherOutputs)
+		for (int32 c = 0; c < FMath::Min(Pair.Value.Num(), UnrealInputs->Num()); ++c)
 		{
-			for (const FString& UnrealIn : UnrealInputs)
+			if (OutInputs.IsValidIndex(Pair.Value[c] - 1))
 			{
-				Subsystem->DisconnectPorts(OtherOut, UnrealIn);
+				OutInputs[Pair.Value[c] - 1] = (*UnrealInputs)[c];
 			}
 		}
 	}
+}
 
-	// Clear our internal mappings
-	ConnectedUnrealInputIndicesByClient.Reset();
-	ConnectedUnrealInputIndicesFromScsynth.Reset();
+void AakMSpatServerManager::ReclaimLeakedUnrealInputs()
+{
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (!JackGraph)
+	{
+		return;
+	}
+
+	TArray<FString> LeakedOwners;
+	const int32 NumReclaimed = UnrealInputAllocator.ReclaimLeaks([this, JackGraph](const FString& Owner)
+	{
+		if (Owner == AlignmentMicOwner)
+		{
+			return AlignmentMicInput != INDEX_NONE;
+		}
+		if (Owner == ExternalPortOwner)
+		{
+			return true;
+		}
+		return Owner == ServerPortOwner ? bIsServerRunning : JackGraph->GetGraph().FindClient(Owner) != nullptr;
+	}, &LeakedOwners);
+
+	for (const FString& Owner : LeakedOwners)
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Unreal inputs held by '%s' leaked (owner is gone); reclaimed."), *Owner);
+		if (Owner == ServerPortOwner)
+		{
+			ConnectedUnrealInputIndicesFromScsynth.Reset();
+		}
+		else
+		{
+			ConnectedUnrealInputIndicesByClient.Remove(Owner);
+			ScsynthInputsByClient.Remove(Owner);
+		}
+	}
+	if (NumReclaimed > 0)
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Reclaimed %d leaked Unreal inputs."), NumReclaimed);
+	}
 }
 
 bool AakMSpatServerManager::StartSpatServer()
@@ -170,42 +988,404 @@ bool AakMSpatServerManager::StartSpatServerProcess()
 	}
 
 	bServerIsStarting = true;
+	ServerOutputStats.Reset();
+	ResetHeartbeat();
 
-	// Create pipes for capturing stdout
-	FPlatformProcess::CreatePipe(ReadPipe, WritePipe);
+	// A fresh server always boots with the script defaults; undo the name/port swap left by a previous failover
+	if (!ActiveServerJackClientName.Equals(TEXT("scsynth"), ESearchCase::IgnoreCase) && StandbyJackClientName.Equals(TEXT("scsynth"), ESearchCase::IgnoreCase))
+	{
+		Swap(ActiveServerJackClientName, StandbyJackClientName);
+		Swap(ActiveServerOSCPort, StandbyOSCPort);
+		HandleActiveServerChanged();
+	}
 
 	UE_LOG(LogSpatServer, Log, TEXT("Starting spat server. SC Dir: %s Script: %s"), *SuperColliderInstallDir, *SpatServerScriptPath);
 
-	const FString ScDir = SuperColliderInstallDir;
-	const FString ScExe = FPaths::Combine(ScDir, TEXT("sclang.exe"));
-	const FString Script = SpatServerScriptPath;
-	const FString Args = FString::Printf(TEXT("\"%s\""), *Script);
+	const FString Args = FString::Printf(TEXT("\"%s\""), *SpatServerScriptPath);
+	SpatServerProcessHandle = LaunchSclang(Args, ReadPipe, WritePipe, SpatServerProcessId);
+
+	if (!SpatServerProcessHandle.IsValid())
+	{
+		UE_LOG(LogSpatServer, Error, TEXT("Failed to start sclang process."));
+		bServerIsStarting = false;
+		return false;
+	}
+
+	if (ProcessSampler)
+	{
+		ProcessSampler->SetSclangProcessId(SpatServerProcessId);
+	}
+
+	bIsServerRunning = true;
+	return true;
+}
+
+FProcHandle AakMSpatServerManager::LaunchSclang(const FString& Args, void*& OutReadPipe, void*& OutWritePipe, uint32& OutProcessId) const
+{
+	// Create pipes for capturing stdout
+	FPlatformProcess::CreatePipe(OutReadPipe, OutWritePipe);
+
+	const FString ScExe = FPaths::Combine(SuperColliderInstallDir, TEXT("sclang.exe"));
 
 	// Spawn process
-	SpatServerProcessHandle = FPlatformProcess::CreateProc(
+	FProcHandle Handle = FPlatformProcess::CreateProc(
 	*ScExe, *Args,
 		true,
 		false,
 		false,
-		nullptr,
+		&OutProcessId,
 		0,
 		*SuperColliderInstallDir,
-		WritePipe,
-		ReadPipe
+		OutWritePipe,
+		OutReadPipe
 	);
 
-	if (!SpatServerProcessHandle.IsValid())
+	if (!Handle.IsValid())
+	{
+		FPlatformProcess::ClosePipe(OutReadPipe, OutWritePipe);
+		OutReadPipe = nullptr;
+		OutWritePipe = nullptr;
+		OutProcessId = 0;
+	}
+	return Handle;
+}
+
+bool AakMSpatServerManager::StartStandbyProcess()
+{
+	if (bStandbyRunning || SuperColliderInstallDir.IsEmpty() || SpatServerScriptPath.IsEmpty() || FPlatformTime::Seconds() < StandbyRetryTime)
+	{
+		return false;
+	}
+
+	const FString Args = FString::Printf(TEXT("\"%s\" %d %s"), *SpatServerScriptPath, StandbyOSCPort, *StandbyJackClientName);
+	StandbyProcessHandle = LaunchSclang(Args, StandbyReadPipe, StandbyWritePipe, StandbyProcessId);
+	if (!StandbyProcessHandle.IsValid())
+	{
+		UE_LOG(LogSpatServer, Error, TEXT("Failed to start standby sclang process; retrying in %.0f s."), StandbyRetrySeconds);
+		StandbyRetryTime = FPlatformTime::Seconds() + StandbyRetrySeconds;
+		return false;
+	}
+
+	UE_LOG(LogSpatServer, Log, TEXT("Booting standby server (OSC port %d, JACK client '%s')."), StandbyOSCPort, *StandbyJackClientName);
+	bStandbyRunning = true;
+	bStandbyReady = false;
+	return true;
+}
+
+void AakMSpatServerManager::HandleActiveServerChanged()
+{
+	if (ServerOSCClient)
+	{
+		ServerOSCClient->SetSendIPAddress(ServerOSCAddress, ActiveServerOSCPort);
+	}
+	RerouteFilePlayer();
+	OnActiveServerChanged.Broadcast(ActiveServerOSCPort);
+}
+
+void AakMSpatServerManager::StopStandbyProcess()
+{
+	if (!bStandbyRunning)
+	{
+		return;
+	}
+
+	if (StandbyProcessHandle.IsValid())
+	{
+		FPlatformProcess::TerminateProc(StandbyProcessHandle, true);
+		FPlatformProcess::CloseProc(StandbyProcessHandle);
+	}
+	StandbyProcessHandle.Reset();
+	StandbyProcessId = 0;
+
+	FPlatformProcess::ClosePipe(StandbyReadPipe, StandbyWritePipe);
+	StandbyReadPipe = nullptr;
+	StandbyWritePipe = nullptr;
+
+	bStandbyRunning = false;
+	bStandbyReady = false;
+}
+
+void AakMSpatServerManager::PumpStandbyOutput()
+{
+	if (!bStandbyRunning || StandbyReadPipe == nullptr)
+	{
+		return;
+	}
+
+	// Drain the pipe so the standby never blocks on a full stdout; its output is kept for diagnosis but not parsed
+	const FString Output = FPlatformProcess::ReadPipe(StandbyReadPipe);
+	if (!Output.IsEmpty())
+	{
+		TArray<FString> Lines;
+		Output.ParseIntoArray(Lines, TEXT("\n"), true);
+		for (const FString& Line : Lines)
+		{
+			ImGuiConsoleBuffer.AddLine(TEXT("[standby] ") + Line);
+		}
+	}
+
+	if (StandbyProcessHandle.IsValid() && !FPlatformProcess::IsProcRunning(StandbyProcessHandle))
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Standby sclang process exited; it will be restarted."));
+		StopStandbyProcess();
+	}
+}
+
+bool AakMSpatServerManager::TryFailoverToStandby(const TCHAR* Reason)
+{
+	if (!bEnableHotStandby || !bIsServerRunning || !bStandbyReady)
+	{
+		return false;
+	}
+
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (!JackGraph)
+	{
+		return false;
+	}
+
+	FailoverStartTime = FPlatformTime::Seconds();
+	UE_LOG(LogSpatServer, Warning, TEXT("Active server lost (%s); promoting standby '%s'."), Reason, *StandbyJackClientName);
+	ImGuiConsoleBuffer.AddLine(FString::Printf(TEXT("Active server lost (%s); switching to standby."), Reason), static_cast<uint8>(EAkMServerEventType::Error));
+
+	const FString OldServer = ActiveServerJackClientName;
+	const FString NewServer = StandbyJackClientName;
+
+	// Move scsynth outputs -> Unreal inputs onto the same Unreal inputs, and external client outputs -> the same
+	// scsynth inputs, in one batch
+	FAkMJackRoutingTransaction Transaction;
+	for (int32 i = 0; i < ConnectedUnrealInputIndicesFromScsynth.Num(); ++i)
+	{
+		JackGraph->AddConnectByIndex(Transaction, NewServer, i + 1, UnrealJackClientName, ConnectedUnrealInputIndicesFromScsynth[i]);
+	}
+	for (const TPair<FString, TArray<int32>>& Pair : ScsynthInputsByClient)
+	{
+		for (int32 ch = 1; ch <= Pair.Value.Num(); ++ch)
+		{
+			JackGraph->AddConnectByIndex(Transaction, Pair.Key, ch, NewServer, Pair.Value[ch - 1]);
+		}
+	}
+	const int32 NumRoutingFailed = JackGraph->ApplyRouting(Transaction);
+
+	// Retire the old process; its JACK client and connections go away with it
+	if (SpatServerProcessHandle.IsValid())
+	{
+		FPlatformProcess::TerminateProc(SpatServerProcessHandle, true);
+		FPlatformProcess::CloseProc(SpatServerProcessHandle);
+	}
+	FPlatformProcess::ClosePipe(ReadPipe, WritePipe);
+
+	// The standby becomes the active server; the old name and port are free for the next standby
+	SpatServerProcessHandle = StandbyProcessHandle;
+	SpatServerProcessId = StandbyProcessId;
+	ReadPipe = StandbyReadPipe;
+	WritePipe = StandbyWritePipe;
+	StandbyProcessHandle.Reset();
+	StandbyProcessId = 0;
+	StandbyReadPipe = nullptr;
+	StandbyWritePipe = nullptr;
+	bStandbyRunning = false;
+	bStandbyReady = false;
+
+	ActiveServerJackClientName = NewServer;
+	StandbyJackClientName = OldServer;
+	Swap(ActiveServerOSCPort, StandbyOSCPort);
+	bAKMserverAudioOutputPortsConnected = NumRoutingFailed == 0 && ConnectedUnrealInputIndicesFromScsynth.Num() > 0;
+	LastFailoverRoutingFailures = NumRoutingFailed;
+	if (ProcessSampler)
+	{
+		ProcessSampler->SetSclangProcessId(SpatServerProcessId);
+	}
+
+	HandleActiveServerChanged();
+	ResyncServerState();
+
+	// Pings sent to the old server will never be answered
+	LastPongSeq = NextPingSeq - 1;
+	bPongSeen = false;
+	bServerStalled = false;
+
+	if (NumRoutingFailed > 0)
+	{
+		// The standby is still the only server left, so keep it active, but its audio is not (fully) routed
+		UE_LOG(LogSpatServer, Error, TEXT("Failover to '%s': %d JACK connection(s) failed; the promoted server's outputs are not routed to Unreal."), *ActiveServerJackClientName, NumRoutingFailed);
+		ImGuiConsoleBuffer.AddLine(FString::Printf(TEXT("Switched to standby, but %d JACK connection(s) failed. Reconnect the server outputs."), NumRoutingFailed), static_cast<uint8>(EAkMServerEventType::Error));
+	}
+	else
+	{
+		++FailoverCount;
+		LastFailoverSwitchMs = float((FPlatformTime::Seconds() - FailoverStartTime) * 1000.0);
+		bAwaitingPromotedHeartbeat = true;
+		UE_LOG(LogSpatServer, Log, TEXT("Failover #%d to '%s' done in %.2f ms (JACK rewiring and state resync)."), FailoverCount, *ActiveServerJackClientName, LastFailoverSwitchMs);
+		ImGuiConsoleBuffer.AddLine(FString::Printf(TEXT("Switched to standby in %.2f ms."), LastFailoverSwitchMs));
+	}
+
+	// Boot the next standby in the background
+	StartStandbyProcess();
+	return true;
+}
+
+void AakMSpatServerManager::TickHeartbeat()
+{
+	if (!bIsServerRunning)
+	{
+		return;
+	}
+
+	// A game-thread hitch holds back the pongs as well as the pings: do not judge the server on that tick
+	const double Now = FPlatformTime::Seconds();
+	const bool bHitch = LastHeartbeatTickTime > 0.0 && Now - LastHeartbeatTickTime > 2.0 * PingIntervalSeconds;
+	LastHeartbeatTickTime = Now;
+	if (Now - LastPingTime >= PingIntervalSeconds)
+	{
+		LastPingTime = Now;
+		const int32 Seq = NextPingSeq++;
+		PingSendCycles[Seq % MaxPendingPings] = FPlatformTime::Cycles64();
+		SendOSCInt(TEXT("/akm/ping"), Seq);
+	}
+
+	// Watchdog only arms once the server has proven it answers pings
+	if (!bPongSeen)
+	{
+		return;
+	}
+
+	const float PendingAgeMs = GetOldestPendingPingAgeMs();
+	const float ThresholdMs = GetStallThresholdMs();
+	const int32 MissedPings = NextPingSeq - 1 - LastPongSeq;
+	if (!bServerStalled && !bHitch && MissedPings >= StallMissedPings && PendingAgeMs > ThresholdMs)
+	{
+		bServerStalled = true;
+		bIsServerAlive = false;
+		UE_LOG(LogSpatServer, Warning, TEXT("Server stalled: ping #%d unanswered for %.1f ms (threshold %.1f ms, p99 %.2f ms)."),
+			LastPongSeq + 1, PendingAgeMs, ThresholdMs, RttHistogram.GetPercentile(0.99f));
+	}
+}
+
+void AakMSpatServerManager::ResetHeartbeat()
+{
+	RttHistogram.Reset();
+	LastPongSeq = NextPingSeq - 1;
+	LastPingTime = 0.0;
+	LastHeartbeatTickTime = 0.0;
+	bPongSeen = false;
+	bServerStalled = false;
+}
+
+void AakMSpatServerManager::TickStatusPoll()
+{
+	const double Now = FPlatformTime::Seconds();
+	if (!bIsServerRunning || StatusPollIntervalSeconds <= 0.0f || Now - LastStatusPollTime < StatusPollIntervalSeconds)
+	{
+		return;
+	}
+	LastStatusPollTime = Now;
+	SendOSCInt(TEXT("/akm/status"), HeartbeatReplyPort);
+}
+
+void AakMSpatServerManager::HandleHeartbeatOSCMessage(const FOSCMessage& Message, const FString& IPAddress, int32 Port)
+{
+	// Replies are tagged with the answering server's OSC port; untagged ones are only trusted without a standby around
+	auto IsFromActive = [this, &Message](int32 TagIndex)
+	{
+		int32 ServerPort = 0;
+		return UOSCManager::GetInt32(Message, TagIndex, ServerPort) ? ServerPort == ActiveServerOSCPort : !bStandbyRunning;
+	};
+
+	const FString Address = UOSCManager::GetOSCAddressFullPath(UOSCManager::GetOSCMessageAddress(Message));
+	if (Address == TEXT("/akm/pong"))
+	{
+		int32 Seq = 0;
+		if (UOSCManager::GetInt32(Message, 0, Seq) && IsFromActive(1))
+		{
+			HandleServerPong(Seq);
+		}
+	}
+	else if (Address == TEXT("/akm/status.reply") && IsFromActive(6))
+	{
+		FAkMServerStatus Status;
+		if (UOSCManager::GetInt32(Message, 0, Status.NumUGens) && UOSCManager::GetInt32(Message, 1, Status.NumSynths)
+			&& UOSCManager::GetInt32(Message, 2, Status.NumGroups) && UOSCManager::GetInt32(Message, 3, Status.NumSynthDefs)
+			&& UOSCManager::GetFloat(Message, 4, Status.AvgCPU) && UOSCManager::GetFloat(Message, 5, Status.PeakCPU))
+		{
+			ServerOutputStats.AddStatus(Status);
+		}
+	}
+}
+
+void AakMSpatServerManager::HandleServerPong(int32 Seq)
+{
+	// Ignore duplicates, replies from an old server, and replies whose send slot has been reused
+	if (Seq <= LastPongSeq || Seq >= NextPingSeq || NextPingSeq - Seq > MaxPendingPings)
+	{
+		return;
+	}
+
+	const uint64 ElapsedCycles = FPlatformTime::Cycles64() - PingSendCycles[Seq % MaxPendingPings];
+	const float RttMs = float(FPlatformTime::ToMilliseconds64(ElapsedCycles));
+	RttHistogram.AddSample(RttMs);
+	LastPongSeq = Seq;
+	bPongSeen = true;
+
+	if (bServerStalled)
+	{
+		bServerStalled = false;
+		UE_LOG(LogSpatServer, Log, TEXT("Server answered ping #%d again (RTT %.2f ms)."), Seq, RttMs);
+	}
+}
+
+float AakMSpatServerManager::GetStallThresholdMs() const
+{
+	const float P99 = RttHistogram.Num() > 0 ? RttHistogram.GetPercentile(0.99f) : MaxStallMs;
+	const float FloorMs = FMath::Max(MinStallMs, MinStallPingIntervals * PingIntervalSeconds * 1000.0f);
+	return FMath::Clamp(StallFactor * P99, FloorMs, FMath::Max(MaxStallMs, FloorMs));
+}
+
+float AakMSpatServerManager::GetOldestPendingPingAgeMs() const
+{
+	const int32 OldestPending = LastPongSeq + 1;
+	if (OldestPending >= NextPingSeq)
+	{
+		return 0.0f;
+	}
+	if (NextPingSeq - OldestPending > MaxPendingPings)
+	{
+		// Send slot already reused: at least MaxPendingPings intervals without an answer
+		return MaxPendingPings * PingIntervalSeconds * 1000.0f;
+	}
+	const uint64 ElapsedCycles = FPlatformTime::Cycles64() - PingSendCycles[OldestPending % MaxPendingPings];
+	return float(FPlatformTime::ToMilliseconds64(ElapsedCycles));
+}
+
+bool AakMSpatServerManager::IsServerJackClient(const FString& ClientName) const
+{
+	return ClientName.Equals(ActiveServerJackClientName, ESearchCase::IgnoreCase)
+		|| (bEnableHotStandby && ClientName.Equals(StandbyJackClientName, ESearchCase::IgnoreCase));
+}
+
+void AakMSpatServerManager::ResyncServerState()
+{
+	SendOSCFloat(TEXT("/system/gain"), systemGain);
+	SendOSCFloatArray(TEXT("/system/reverb"), { reverbDecay, reverbFeedback });
+	SendOSCFloatArray(TEXT("/system/filter/sats"), { satsFilterFrequency, satsFilterRq });
+	SendOSCFloatArray(TEXT("/system/filter/subs"), { subsFilterFrequency, subsFilterRq });
+	for (int32 i = 0; i < satsGains.Num(); ++i)
 	{
-		UE_LOG(LogSpatServer, Error, TEXT("Failed to start sclang process."));
-		FPlatformProcess::ClosePipe(ReadPipe, WritePipe);
-		ReadPipe = nullptr;
-		WritePipe = nullptr;
-		bServerIsStarting = false;
-		return false;
+		SendOSCFloat(FString::Printf(TEXT("/sat%d/gain"), i + 1), satsGains[i]);
 	}
-
-	bIsServerRunning = true;
-	return true;
+	for (int32 i = 0; i < subsGains.Num(); ++i)
+	{
+		SendOSCFloat(FString::Printf(TEXT("/sub%d/gain"), i + 1), subsGains[i]);
+	}
+	for (int32 i = 0; i < satsDelaysMs.Num(); ++i)
+	{
+		SendOSCFloat(FString::Printf(TEXT("/sat%d/delay"), i + 1), satsDelaysMs[i]);
+	}
+	for (int32 i = 0; i < subsDelaysMs.Num(); ++i)
+	{
+		SendOSCFloat(FString::Printf(TEXT("/sub%d/delay"), i + 1), subsDelaysMs[i]);
+	}
+	OnServerStateResyncRequested.Broadcast();
 }
 
 void AakMSpatServerManager::StopSpatServerProcess()
@@ -224,12 +1404,20 @@ void AakMSpatServerManager::StopSpatServerProcess()
 		FPlatformProcess::CloseProc(SpatServerProcessHandle);
 	}
 	SpatServerProcessHandle.Reset();
+	SpatServerProcessId = 0;
+	if (ProcessSampler)
+	{
+		ProcessSampler->SetSclangProcessId(0);
+	}
 
 	FPlatformProcess::ClosePipe(ReadPipe, WritePipe);
 	ReadPipe = nullptr;
 	WritePipe = nullptr;
 
 	bIsServerRunning = false;
+	bAwaitingPromotedHeartbeat = false;
+
+	StopStandbyProcess();
 }
 
 void AakMSpatServerManager::PumpSpatServerOutput()
@@ -250,14 +1438,9 @@ void AakMSpatServerManager::PumpSpatServerOutput()
 			{
 				//UE_LOG(LogSpatServer, Log, TEXT("sclang: %s"), *Line);
 
-				// Write to ImGui buffer
-				ImGuiConsoleBuffer.Add(Line);
-
-				// Limit size
-				if (ImGuiConsoleBuffer.Num() > MaxConsoleLines)
-				{
-					ImGuiConsoleBuffer.RemoveAt(0, ImGuiConsoleBuffer.Num() - MaxConsoleLines);
-				}
+				// Classify the line, then write it to the ImGui buffer tagged with its type (oldest lines are dropped past MaxConsoleLines)
+				const EAkMServerEventType EventType = ServerOutputStats.Ingest(Line, ImGuiConsoleBuffer.GetTotalLinesAdded());
+				ImGuiConsoleBuffer.AddLine(Line, static_cast<uint8>(EventType));
 			}
 		}
 	}
@@ -266,39 +1449,58 @@ void AakMSpatServerManager::PumpSpatServerOutput()
 	if (SpatServerProcessHandle.IsValid() && !FPlatformProcess::IsProcRunning(SpatServerProcessHandle))
 	{
 		UE_LOG(LogSpatServer, Warning, TEXT("sclang process exited."));
-		ImGuiConsoleBuffer.Add(TEXT("sclang process exited."));
-		StopSpatServerProcess();
+		ServerOutputStats.AddError(ImGuiConsoleBuffer.GetTotalLinesAdded());
+		ImGuiConsoleBuffer.AddLine(TEXT("sclang process exited."), static_cast<uint8>(EAkMServerEventType::Error));
+		if (!TryFailoverToStandby(TEXT("sclang exited")))
+		{
+			StopSpatServerProcess();
+		}
 	}
 }
 
 void AakMSpatServerManager::HandleNewJackClientConnected(const FString& ClientName, int32 NumInputPorts, int32 NumOutputPorts)
 {
-	// Only act when scsynth connects and we haven't connected yet
-	if (bAKMserverAudioOutputPortsConnected)
+	// The standby's scsynth stays isolated until it is promoted
+	if (bEnableHotStandby && ClientName.Equals(StandbyJackClientName, ESearchCase::IgnoreCase))
 	{
+		DisconnectServerFromSystem(ClientName);
+		bStandbyReady = true;
+		UE_LOG(LogSpatServer, Log, TEXT("Standby server '%s' is ready (%d in / %d out)."), *ClientName, NumInputPorts, NumOutputPorts);
 		return;
 	}
 
-	if (!ClientName.Equals(TEXT("scsynth"), ESearchCase::IgnoreCase))
+	if (!ClientName.Equals(ActiveServerJackClientName, ESearchCase::IgnoreCase))
 	{
 		// Ignore our own Unreal JACK client
 		if (!UnrealJackClientName.IsEmpty() && ClientName.Equals(UnrealJackClientName, ESearchCase::IgnoreCase))
 		{
 			return;
 		}
-		// UI handled in AImGuiActor
+
+		// Clients matching the patchbay profile are wired here once the server is up; others are prompted in AImGuiActor
+		ClientAppearTimes.Add(ClientName, FPlatformTime::Seconds());
+		if (bAKMserverAudioOutputPortsConnected && FindPatchbayRule(ClientName))
+		{
+			ApplyPatchbay({ ClientName });
+		}
+		return;
+	}
+
+	// Only act when scsynth connects and we haven't connected yet
+	if (bAKMserverAudioOutputPortsConnected)
+	{
 		return;
 	}
 
-	UUEJackAudioLinkSubsystem* Subsystem = (GEngine ? GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>() : nullptr);
-	if (!Subsystem)
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (!JackGraph)
 	{
 		UE_LOG(LogSpatServer, Error, TEXT("UEJackAudioLinkSubsystem not available; cannot auto-connect scsynth."));
 		return;
 	}
 
 	// Refresh our Unreal client name and input list
-	UnrealJackClientName = Subsystem->GetJackClientName();
+	UnrealJackClientName = JackGraph->GetUnrealClientName();
 	if (UnrealJackClientName.IsEmpty())
 	{
 		UE_LOG(LogSpatServer, Warning, TEXT("Unreal JACK client name is empty; is the UE JACK client connected?"));
@@ -306,224 +1508,561 @@ void AakMSpatServerManager::HandleNewJackClientConnected(const FString& ClientNa
 	}
 
 	// Proactively disconnect scsynth <-> system default connections (both directions)
+	DisconnectServerFromSystem(ClientName);
+
+	// Reserve Unreal inputs for scsynth outputs (1-based), as one contiguous block when possible
+	SyncUnrealInputAllocator();
+	UnrealInputAllocator.FreeOwner(ServerPortOwner);
+	TArray<int32> DestInputIndices;
+	if (!UnrealInputAllocator.Allocate(ServerPortOwner, NumOutputPorts, DestInputIndices, EAkMPortAllocation::PreferContiguous))
 	{
-		TArray<FString> ScIn, ScOut;
-		Subsystem->GetClientPorts(TEXT("scsynth"), ScIn, ScOut);
-		TArray<FString> SysIn, SysOut;
-		Subsystem->GetClientPorts(TEXT("system"), SysIn, SysOut);
-		int32 DisconnectAttempts = 0;
-		for (const FString& ScOutPort : ScOut)
-		{
-			for (const FString& SysInPort : SysIn)
-			{
-				if (!ScOutPort.IsEmpty() && !SysInPort.IsEmpty())
-				{
-					Subsystem->DisconnectPorts(ScOutPort, SysInPort);
-					++DisconnectAttempts;
-				}
-			}
-		}
-		for (const FString& SysOutPort : SysOut)
-		{
-			for (const FString& ScInPort : ScIn)
-			{
-				if (!SysOutPort.IsEmpty() && !ScInPort.IsEmpty())
-				{
-					Subsystem->DisconnectPorts(SysOutPort, ScInPort);
-					++DisconnectAttempts;
-				}
-			}
-		}
-		if (DisconnectAttempts > 0)
-		{
-			UE_LOG(LogSpatServer, Log, TEXT("Attempted to disconnect %d scsynth<->system port pairs."), DisconnectAttempts);
-		}
+		UE_LOG(LogSpatServer, Error, TEXT("Not enough available Unreal JACK input ports (%d) to connect scsynth outputs (%d). Increase input port count in UEJackAudioLink plugin settings."), UnrealInputAllocator.GetNumFree(), NumOutputPorts);
+		return;
 	}
 
-	// Compute available input indices on our Unreal client (1-based)
-	TArray<int32> AvailableInputIndices = GetAvailableUnrealInputPortIndices();
-	const int32 NumAvailable = AvailableInputIndices.Num();
-
-	if (NumAvailable < NumOutputPorts)
+	// Connect scsynth outputs [1..NumOutputPorts] to the reserved Unreal inputs, as one batch
+	FAkMJackRoutingTransaction Transaction;
+	for (int32 OutIndex1Based = 1; OutIndex1Based <= NumOutputPorts; ++OutIndex1Based)
 	{
-		UE_LOG(LogSpatServer, Error, TEXT("Not enough available Unreal JACK input ports (%d) to connect scsynth outputs (%d). Increase input port count in UEJackAudioLink plugin settings."), NumAvailable, NumOutputPorts);
-		return;
+		JackGraph->AddConnectByIndex(Transaction, ActiveServerJackClientName, OutIndex1Based, UnrealJackClientName, DestInputIndices[OutIndex1Based - 1]);
 	}
+	JackGraph->ApplyRouting(Transaction);
 
-	// Connect scsynth outputs [1..NumOutputPorts] to next available Unreal inputs ascending
-	bool bAllConnected = true;
 	ConnectedUnrealInputIndicesFromScsynth.Reset();
 	for (int32 OutIndex1Based = 1; OutIndex1Based <= NumOutputPorts; ++OutIndex1Based)
 	{
-		const int32 DestInputIndex1Based = AvailableInputIndices[OutIndex1Based - 1];
-		const bool bOK = Subsystem->ConnectPortsByIndex(EJackPortDirection::Output, TEXT("scsynth"), OutIndex1Based,
-			EJackPortDirection::Input, UnrealJackClientName, DestInputIndex1Based);
-		if (!bOK)
+		const int32 DestInputIndex1Based = DestInputIndices[OutIndex1Based - 1];
+		if (JackGraph->IsConnectedByIndex(ActiveServerJackClientName, OutIndex1Based, UnrealJackClientName, DestInputIndex1Based))
 		{
-			UE_LOG(LogSpatServer, Error, TEXT("Failed to connect scsynth output #%d to Unreal input #%d."), OutIndex1Based, DestInputIndex1Based);
-			bAllConnected = false;
+			ConnectedUnrealInputIndicesFromScsynth.Add(DestInputIndex1Based);
 		}
 		else
 		{
-			ConnectedUnrealInputIndicesFromScsynth.Add(DestInputIndex1Based);
+			UE_LOG(LogSpatServer, Error, TEXT("Failed to connect scsynth output #%d to Unreal input #%d."), OutIndex1Based, DestInputIndex1Based);
+			UnrealInputAllocator.Free(ServerPortOwner, DestInputIndex1Based);
 		}
 	}
 
-	bAKMserverAudioOutputPortsConnected = bAllConnected && ConnectedUnrealInputIndicesFromScsynth.Num() == NumOutputPorts;
+	bAKMserverAudioOutputPortsConnected = ConnectedUnrealInputIndicesFromScsynth.Num() == NumOutputPorts;
 	if (bAKMserverAudioOutputPortsConnected)
 	{
 		UE_LOG(LogSpatServer, Log, TEXT("Connected %d scsynth outputs to Unreal JACK inputs."), NumOutputPorts);
+		LastFailoverRoutingFailures = 0;
+
+		// Clients already on JACK that the patchbay knows are wired in one transaction
+		ServerConnectedTime = FPlatformTime::Seconds();
+		ApplyPatchbayToPresentClients();
 	}
 }
 
-void AakMSpatServerManager::HandleJackClientDisconnected(const FString& ClientName)
+void AakMSpatServerManager::DisconnectServerFromSystem(const FString& ServerClientName) const
 {
-	if (ClientName.Equals(TEXT("scsynth"), ESearchCase::IgnoreCase))
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	IAkMJackBackend* Backend = JackGraph ? JackGraph->GetBackend() : nullptr;
+	if (!Backend)
 	{
-		ConnectedUnrealInputIndicesFromScsynth.Reset();
-		bAKMserverAudioOutputPortsConnected = false;
-		UE_LOG(LogSpatServer, Log, TEXT("scsynth disconnected; cleared port mapping state."));
+		return;
 	}
-	else
+
+	// scsynth makes these connections itself while booting, outside the graph; ask JACK what each scsynth port is
+	// actually connected to and remove only the pairs with system ports
+	JackGraph->GetClient(ServerClientName);
+	JackGraph->GetClient(TEXT("system"));
+	const FAkMJackGraph::FClient* Server = JackGraph->GetGraph().FindClient(ServerClientName);
+	const FAkMJackGraph::FClient* System = JackGraph->GetGraph().FindClient(TEXT("system"));
+	if (!Server || !System)
 	{
-		if (ConnectedUnrealInputIndicesByClient.Remove(ClientName) > 0)
+		return;
+	}
+	TArray<FAkMJackConnection> SystemConnections;
+	TArray<FString> ConnectedPorts;
+	auto CollectSystemConnections = [&](const FString& ScPort, bool bScIsSource)
+	{
+		if (!Backend->GetPortConnections(ScPort, ConnectedPorts))
+		{
+			return false;
+		}
+		for (const FString& Port : ConnectedPorts)
 		{
-			UE_LOG(LogSpatServer, Log, TEXT("Client '%s' disconnected; cleared its Unreal input mapping."), *ClientName);
+			if (FAkMJackGraph::GetClientOfPort(Port).Equals(TEXT("system"), ESearchCase::IgnoreCase))
+			{
+				SystemConnections.Add(bScIsSource ? FAkMJackConnection(ScPort, Port) : FAkMJackConnection(Port, ScPort));
+			}
 		}
+		return true;
+	};
+	bool bListedConnections = true;
+	for (int32 i = 0; bListedConnections && i < Server->OutputPorts.Num(); ++i)
+	{
+		bListedConnections = CollectSystemConnections(Server->OutputPorts[i], true);
+	}
+	for (int32 i = 0; bListedConnections && i < Server->InputPorts.Num(); ++i)
+	{
+		bListedConnections = CollectSystemConnections(Server->InputPorts[i], false);
 	}
-}
 
-TArray<int32> AakMSpatServerManager::GetAvailableUnrealInputPortIndices() const
-{
-	TArray<int32> Result;
-	UUEJackAudioLinkSubsystem* Subsystem = (GEngine ? GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>() : nullptr);
-	if (!Subsystem)
+	if (bListedConnections)
 	{
-		return Result;
+		for (const FAkMJackConnection& Connection : SystemConnections)
+		{
+			Backend->DisconnectPorts(Connection.Source, Connection.Destination);
+		}
+		if (SystemConnections.Num() > 0)
+		{
+			UE_LOG(LogSpatServer, Log, TEXT("Disconnected %d %s<->system connections."), SystemConnections.Num(), *ServerClientName);
+		}
+		return;
 	}
-	TArray<FString> UnrealInputs, UnrealOutputs;
-	Subsystem->GetClientPorts(UnrealJackClientName, UnrealInputs, UnrealOutputs);
-	const int32 NumInputs = UnrealInputs.Num();
-	if (NumInputs <= 0)
+
+	// The backend cannot list connections: sweep the pairs, using the cached port lists
+	int32 DisconnectAttempts = 0;
+	for (const FString& ScOutPort : Server->OutputPorts)
 	{
-		return Result;
+		for (const FString& SysInPort : System->InputPorts)
+		{
+			if (!ScOutPort.IsEmpty() && !SysInPort.IsEmpty())
+			{
+				Backend->DisconnectPorts(ScOutPort, SysInPort);
+				++DisconnectAttempts;
+			}
+		}
 	}
-	// Build set of reserved/used indices from all known client mappings (1-based)
-	TSet<int32> Used;
-	for (const auto& Pair : ConnectedUnrealInputIndicesByClient)
+	for (const FString& SysOutPort : System->OutputPorts)
 	{
-		for (int32 Index1Based : Pair.Value)
+		for (const FString& ScInPort : Server->InputPorts)
 		{
-			Used.Add(Index1Based);
+			if (!SysOutPort.IsEmpty() && !ScInPort.IsEmpty())
+			{
+				Backend->DisconnectPorts(SysOutPort, ScInPort);
+				++DisconnectAttempts;
+			}
 		}
 	}
-	for (int32 Index1Based : ConnectedUnrealInputIndicesFromScsynth)
+	if (DisconnectAttempts > 0)
+	{
+		UE_LOG(LogSpatServer, Log, TEXT("Attempted to disconnect %d %s<->system port pairs."), DisconnectAttempts, *ServerClientName);
+	}
+}
+
+void AakMSpatServerManager::HandleJackClientDisconnected(const FString& ClientName)
+{
+	if (bEnableHotStandby && ClientName.Equals(StandbyJackClientName, ESearchCase::IgnoreCase))
+	{
+		bStandbyReady = false;
+		return;
+	}
+
+	if (ClientName.Equals(ActiveServerJackClientName, ESearchCase::IgnoreCase))
 	{
-		Used.Add(Index1Based);
+		// Losing the active scsynth on JACK is the earliest crash signal; keep the port mapping for the standby
+		if (TryFailoverToStandby(TEXT("scsynth left JACK")))
+		{
+			return;
+		}
+
+		UnrealInputAllocator.FreeOwner(ServerPortOwner);
+		ConnectedUnrealInputIndicesFromScsynth.Reset();
+		bAKMserverAudioOutputPortsConnected = false;
+		UE_LOG(LogSpatServer, Log, TEXT("scsynth disconnected; cleared port mapping state."));
 	}
-	for (int32 Index1Based = 1; Index1Based <= NumInputs; ++Index1Based)
+	else
 	{
-		if (!Used.Contains(Index1Based))
+		ClientAppearTimes.Remove(ClientName);
+		ScsynthInputsByClient.Remove(ClientName);
+		const int32 NumFreed = UnrealInputAllocator.FreeOwner(ClientName);
+		if (ConnectedUnrealInputIndicesByClient.Remove(ClientName) > 0 || NumFreed > 0)
 		{
-			Result.Add(Index1Based);
+			UE_LOG(LogSpatServer, Log, TEXT("Client '%s' disconnected; released %d Unreal inputs."), *ClientName, NumFreed);
 		}
 	}
+
+	// A missed disconnect event would otherwise keep ports reserved forever
+	ReclaimLeakedUnrealInputs();
+}
+
+TArray<int32> AakMSpatServerManager::GetAvailableUnrealInputPortIndices() const
+{
+	TArray<int32> Result;
+	UnrealInputAllocator.GetFreeIndices(Result);
 	return Result;
 }
 
 void AakMSpatServerManager::AcceptExternalClient(const FString& ClientName, int32 NumInputPorts, int32 NumOutputPorts)
 {
-	UUEJackAudioLinkSubsystem* Subsystem = (GEngine ? GEngine->GetEngineSubsystem<UUEJackAudioLinkSubsystem>() : nullptr);
-	if (!Subsystem)
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (!JackGraph)
 	{
 		UE_LOG(LogSpatServer, Error, TEXT("UEJackAudioLinkSubsystem not available; cannot accept client '%s'."), *ClientName);
 		return;
 	}
 
-	// Ensure scsynth inputs count
-	TArray<FString> ScIn, ScOut;
-	Subsystem->GetClientPorts(TEXT("scsynth"), ScIn, ScOut);
-	const int32 NumScInputs = ScIn.Num();
-	int32 NumToConnect = FMath::Min(NumScInputs, NumOutputPorts);
-	if (NumOutputPorts > NumScInputs)
+	const double StartTime = FPlatformTime::Seconds();
+
+	FClientRoutingPlan Plan;
+	FAkMJackRoutingTransaction Transaction;
+	if (!PlanExternalClient(ClientName, NumOutputPorts, nullptr, Transaction, Plan))
 	{
-		UE_LOG(LogSpatServer, Warning, TEXT("Client '%s' has %d outputs > scsynth inputs %d. Will connect first %d channels."), *ClientName, NumOutputPorts, NumScInputs, NumToConnect);
+		return;
 	}
+	JackGraph->ApplyRouting(Transaction);
+	CommitExternalClient(Plan);
 
-	// Build mapping of existing connections from this client's outputs to our Unreal inputs (1-based indices)
-	TMap<int32, int32> AlreadyConnectedMap;
-	TArray<FString> UnrealInputs, UnrealOutputs;
-	Subsystem->GetClientPorts(UnrealJackClientName, UnrealInputs, UnrealOutputs);
-	TArray<FString> ClientInputs, ClientOutputs;
-	Subsystem->GetClientPorts(ClientName, ClientInputs, ClientOutputs);
-	for (int32 ch = 1; ch <= NumToConnect && ch <= ClientOutputs.Num(); ++ch)
-	{
-		const FString& ClientOutName = ClientOutputs[ch - 1];
-		for (int32 idx = 0; idx < UnrealInputs.Num(); ++idx)
-		{
-			const FString& UnrealInName = UnrealInputs[idx];
-			// Probe: attempt a disconnect to see if connection exists; if so, reconnect and record mapping
-			const bool bWasConnected = Subsystem->DisconnectPorts(ClientOutName, UnrealInName);
-			if (bWasConnected)
+	UE_LOG(LogSpatServer, Log, TEXT("Accepted client '%s' and connected %d channels to scsynth and Unreal inputs (%d already connected, %.2f ms)."),
+		*ClientName, Plan.UnrealIndexByChannel.Num(), Plan.NumExisting, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+bool AakMSpatServerManager::PlanExternalClient(const FString& ClientName, int32 NumOutputPorts, const FAkMPatchbayRule* Rule, FAkMJackRoutingTransaction& Transaction, FClientRoutingPlan& OutPlan)
+{
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (!JackGraph)
+	{
+		return false;
+	}
+
+	// Read what JACK really has into the graph first: connections made in qjackctl or left by a previous session
+	// are not in it, and planning on the cache alone would reuse occupied Unreal inputs or duplicate existing ones
+	JackGraph->SyncConnections(ClientName, UnrealJackClientName);
+	if (IAkMJackBackend* Backend = JackGraph->GetBackend())
+	{
+		for (const FString& Other : Backend->GetConnectedClients())
+		{
+			if (!Other.Equals(ClientName, ESearchCase::IgnoreCase) && !Other.Equals(UnrealJackClientName, ESearchCase::IgnoreCase)
+				&& !Other.Equals(ActiveServerJackClientName, ESearchCase::IgnoreCase) && !Other.Equals(StandbyJackClientName, ESearchCase::IgnoreCase))
 			{
-				Subsystem->ConnectPorts(ClientOutName, UnrealInName);
-				AlreadyConnectedMap.Add(ch, idx + 1);
-				break;
+				JackGraph->SyncConnections(Other, UnrealJackClientName);
 			}
 		}
 	}
 
-	const int32 NumExisting = AlreadyConnectedMap.Num();
-	const int32 NumNeeded = FMath::Max(0, NumToConnect - NumExisting);
+	// Cache the three clients up front; pointers into the graph stay valid while no other client is added
+	JackGraph->GetClient(ActiveServerJackClientName);
+	JackGraph->GetClient(UnrealJackClientName);
+	JackGraph->GetClient(ClientName);
+	const FAkMJackGraph& Graph = JackGraph->GetGraph();
+	const FAkMJackGraph::FClient* Server = Graph.FindClient(ActiveServerJackClientName);
+	const FAkMJackGraph::FClient* Unreal = Graph.FindClient(UnrealJackClientName);
+	const FAkMJackGraph::FClient* Client = Graph.FindClient(ClientName);
+	if (!Client || !Unreal)
+	{
+		UE_LOG(LogSpatServer, Error, TEXT("Ports of '%s' or of the Unreal JACK client are unknown; cannot accept client."), *ClientName);
+		return false;
+	}
 
-	// Compute available Unreal input indices, excluding ones already used by existing connections for this client
-	TArray<int32> AvailableInputIndices = GetAvailableUnrealInputPortIndices();
-	if (NumNeeded > 0)
+	// Output N feeds scsynth input N unless the patchbay rule says otherwise; stop at the first channel scsynth cannot take
+	const int32 NumScInputs = Server ? Server->InputPorts.Num() : 0;
+	int32 NumToConnect = FMath::Min(NumOutputPorts, Client->OutputPorts.Num());
+	if (Rule && Rule->MaxChannels > 0)
+	{
+		NumToConnect = FMath::Min(NumToConnect, Rule->MaxChannels);
+	}
+	OutPlan.ClientName = ClientName;
+	OutPlan.ScsynthInputByChannel.Reset();
+	for (int32 ch = 1; ch <= NumToConnect; ++ch)
 	{
-		TSet<int32> UsedExisting;
-		for (const auto& Pair : AlreadyConnectedMap)
+		const int32 ScInput = (Rule && Rule->ScsynthInputs.IsValidIndex(ch - 1)) ? Rule->ScsynthInputs[ch - 1] : ch;
+		if (ScInput < 1 || ScInput > NumScInputs)
 		{
-			UsedExisting.Add(Pair.Value);
+			UE_LOG(LogSpatServer, Warning, TEXT("Client '%s' output #%d maps to scsynth input %d (scsynth has %d). Will connect first %d channels."), *ClientName, ch, ScInput, NumScInputs, ch - 1);
+			NumToConnect = ch - 1;
+			break;
 		}
-		AvailableInputIndices.RemoveAll([&UsedExisting](int32 Idx){ return UsedExisting.Contains(Idx); });
-		if (AvailableInputIndices.Num() < NumNeeded)
+		OutPlan.ScsynthInputByChannel.Add(ScInput);
+	}
+
+	// Existing connections from this client's outputs to our Unreal inputs (1-based indices), read from the synced
+	// graph so live connections are never interrupted
+	TMap<int32, int32> AlreadyConnectedMap;
+	TArray<FString> Destinations;
+	for (int32 ch = 1; ch <= NumToConnect; ++ch)
+	{
+		Destinations.Reset();
+		Graph.GetDestinations(Client->OutputPorts[ch - 1], Destinations);
+		for (const FString& Destination : Destinations)
 		{
-			UE_LOG(LogSpatServer, Error, TEXT("Not enough available Unreal JACK input ports (%d) for %d new connections from '%s' (reusing %d existing). Increase input ports in UEJackAudioLink settings."), AvailableInputIndices.Num(), NumNeeded, *ClientName, NumExisting);
-			return;
+			const int32 UnrealIndex = Unreal->InputPorts.IndexOfByKey(Destination);
+			if (UnrealIndex != INDEX_NONE)
+			{
+				AlreadyConnectedMap.Add(ch, UnrealIndex + 1);
+				break;
+			}
 		}
 	}
 
-	TArray<int32>& UnrealIndicesForClient = ConnectedUnrealInputIndicesByClient.FindOrAdd(ClientName);
-	int32 NextAvailIdx = 0;
+	// Inputs requested by the rule come first, then existing connections keep their Unreal input;
+	// an input held by another owner is not shared, including inputs another patchbay feeds from a client not routed here
+	SyncUnrealInputAllocator();
+	UnrealInputAllocator.FreeOwner(ExternalPortOwner);
+	TArray<FString> Sources;
+	for (int32 i = 0; i < Unreal->InputPorts.Num(); ++i)
+	{
+		if (UnrealInputAllocator.IsAllocated(i + 1))
+		{
+			continue;
+		}
+		Sources.Reset();
+		Graph.GetSources(Unreal->InputPorts[i], Sources);
+		const bool bFedExternally = Sources.ContainsByPredicate([this, &ClientName](const FString& Source)
+		{
+			const FString SourceClient = FAkMJackGraph::GetClientOfPort(Source);
+			return !SourceClient.Equals(ClientName, ESearchCase::IgnoreCase) && !SourceClient.Equals(ActiveServerJackClientName, ESearchCase::IgnoreCase)
+				&& !SourceClient.Equals(StandbyJackClientName, ESearchCase::IgnoreCase);
+		});
+		if (bFedExternally)
+		{
+			UnrealInputAllocator.Claim(ExternalPortOwner, i + 1);
+		}
+	}
+	OutPlan.PreviousPorts.Reset();
+	if (const TArray<int32>* OwnedPorts = UnrealInputAllocator.GetOwnerPorts(ClientName))
+	{
+		OutPlan.PreviousPorts = *OwnedPorts;
+	}
+	OutPlan.UnrealIndexByChannel.Init(0, NumToConnect);
+	OutPlan.NumExisting = 0;
 	for (int32 ch = 1; ch <= NumToConnect; ++ch)
 	{
-		int32 UnrealIndex = 0;
-		if (const int32* FoundIdx = AlreadyConnectedMap.Find(ch))
+		const int32 Requested = (Rule && Rule->UnrealInputs.IsValidIndex(ch - 1)) ? Rule->UnrealInputs[ch - 1] : 0;
+		const int32* Existing = AlreadyConnectedMap.Find(ch);
+		const int32 Wanted = Requested > 0 ? Requested : (Existing ? *Existing : 0);
+		if (Wanted <= 0)
 		{
-			UnrealIndex = *FoundIdx;
+			continue;
+		}
+		if (UnrealInputAllocator.Claim(ClientName, Wanted))
+		{
+			OutPlan.UnrealIndexByChannel[ch - 1] = Wanted;
+			OutPlan.NumExisting += (Existing && *Existing == Wanted) ? 1 : 0;
 		}
 		else
 		{
-			UnrealIndex = AvailableInputIndices[NextAvailIdx++];
+			UE_LOG(LogSpatServer, Warning, TEXT("'%s' output #%d wants Unreal input #%d, which is reserved by another client."), *ClientName, ch, Wanted);
+		}
+	}
+
+	// Remaining channels get one contiguous block of Unreal inputs when possible
+	const int32 NumNeeded = Algo::Count(OutPlan.UnrealIndexByChannel, 0);
+	TArray<int32> NewInputIndices;
+	if (!UnrealInputAllocator.Allocate(ClientName, NumNeeded, NewInputIndices, EAkMPortAllocation::PreferContiguous))
+	{
+		UE_LOG(LogSpatServer, Error, TEXT("Not enough available Unreal JACK input ports (%d) for %d new connections from '%s' (reusing %d existing). Increase input ports in UEJackAudioLink settings."), UnrealInputAllocator.GetNumFree(), NumNeeded, *ClientName, NumToConnect - NumNeeded);
+		for (const int32 Claimed : OutPlan.UnrealIndexByChannel)
+		{
+			if (Claimed > 0 && !OutPlan.PreviousPorts.Contains(Claimed))
+			{
+				UnrealInputAllocator.Free(ClientName, Claimed);
+			}
 		}
+		return false;
+	}
 
-		const bool b1 = Subsystem->ConnectPortsByIndex(EJackPortDirection::Output, ClientName, ch, EJackPortDirection::Input, TEXT("scsynth"), ch);
-		bool b2 = true;
-		if (!AlreadyConnectedMap.Contains(ch))
+	// Channel N feeds its scsynth input and its Unreal input
+	int32 NextNewIdx = 0;
+	for (int32 ch = 1; ch <= NumToConnect; ++ch)
+	{
+		int32& UnrealIndex = OutPlan.UnrealIndexByChannel[ch - 1];
+		if (UnrealIndex == 0)
 		{
-			b2 = Subsystem->ConnectPortsByIndex(EJackPortDirection::Output, ClientName, ch, EJackPortDirection::Input, UnrealJackClientName, UnrealIndex);
+			UnrealIndex = NewInputIndices[NextNewIdx++];
 		}
-		if (b1 && b2)
+		JackGraph->AddConnectByIndex(Transaction, ClientName, ch, ActiveServerJackClientName, OutPlan.ScsynthInputByChannel[ch - 1]);
+		JackGraph->AddConnectByIndex(Transaction, ClientName, ch, UnrealJackClientName, UnrealIndex);
+	}
+	return true;
+}
+
+void AakMSpatServerManager::CommitExternalClient(const FClientRoutingPlan& Plan)
+{
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (!JackGraph)
+	{
+		return;
+	}
+
+	const FString& ClientName = Plan.ClientName;
+	TArray<int32>& UnrealIndicesForClient = ConnectedUnrealInputIndicesByClient.FindOrAdd(ClientName);
+	TArray<int32>& ScsynthInputsForClient = ScsynthInputsByClient.FindOrAdd(ClientName);
+	UnrealIndicesForClient.Reset();
+	ScsynthInputsForClient.Reset();
+	for (int32 ch = 1; ch <= Plan.UnrealIndexByChannel.Num(); ++ch)
+	{
+		const int32 UnrealIndex = Plan.UnrealIndexByChannel[ch - 1];
+		const int32 ScInput = Plan.ScsynthInputByChannel[ch - 1];
+		if (JackGraph->IsConnectedByIndex(ClientName, ch, ActiveServerJackClientName, ScInput)
+			&& JackGraph->IsConnectedByIndex(ClientName, ch, UnrealJackClientName, UnrealIndex))
 		{
 			UnrealIndicesForClient.Add(UnrealIndex);
+			ScsynthInputsForClient.Add(ScInput);
 		}
 		else
 		{
 			UE_LOG(LogSpatServer, Error, TEXT("Failed to connect '%s' output #%d."), *ClientName, ch);
+			UnrealInputAllocator.Free(ClientName, UnrealIndex);
+		}
+	}
+
+	// Release inputs from an earlier accept of this client that are no longer used
+	for (const int32 Index1Based : Plan.PreviousPorts)
+	{
+		if (!UnrealIndicesForClient.Contains(Index1Based))
+		{
+			UnrealInputAllocator.Free(ClientName, Index1Based);
+		}
+	}
+	if (UnrealIndicesForClient.IsEmpty())
+	{
+		ConnectedUnrealInputIndicesByClient.Remove(ClientName);
+		ScsynthInputsByClient.Remove(ClientName);
+	}
+}
+
+void AakMSpatServerManager::LoadPatchbayProfiles()
+{
+	const FString FilePath = FAkMPatchbayProfiles::GetDefaultFilePath();
+	FAkMPatchbayProfiles Profiles;
+	if (!Profiles.LoadFromFile(FilePath))
+	{
+		if (!FPaths::FileExists(FilePath))
+		{
+			// Write an empty profile so the file and its format are there to edit
+			Profiles.ActiveProfile = TEXT("default");
+			Profiles.Profiles.AddDefaulted_GetRef().Name = TEXT("default");
+			Profiles.SaveToFile(FilePath);
+			UE_LOG(LogSpatServer, Log, TEXT("Created empty patchbay profiles file: %s"), *FilePath);
+		}
+		else
+		{
+			UE_LOG(LogSpatServer, Error, TEXT("Could not parse patchbay profiles: %s"), *FilePath);
+		}
+		return;
+	}
+
+	const FString& ProfileName = PatchbayProfileName.IsEmpty() ? Profiles.ActiveProfile : PatchbayProfileName;
+	if (const FAkMPatchbayProfile* Profile = Profiles.FindProfile(ProfileName))
+	{
+		ActivePatchbayProfile = *Profile;
+		UE_LOG(LogSpatServer, Log, TEXT("Patchbay profile '%s' loaded (%d rules)."), *ActivePatchbayProfile.Name, ActivePatchbayProfile.Rules.Num());
+	}
+	else
+	{
+		UE_LOG(LogSpatServer, Warning, TEXT("Patchbay profile '%s' not found in %s."), *ProfileName, *FilePath);
+	}
+}
+
+bool AakMSpatServerManager::SavePatchbayProfileFromCurrentRouting(const FString& ProfileName)
+{
+	const FString FilePath = FAkMPatchbayProfiles::GetDefaultFilePath();
+	FAkMPatchbayProfiles Profiles;
+	Profiles.LoadFromFile(FilePath);
+
+	FAkMPatchbayProfile* Profile = Profiles.FindProfile(ProfileName);
+	if (!Profile)
+	{
+		Profile = &Profiles.Profiles.AddDefaulted_GetRef();
+		Profile->Name = ProfileName;
+	}
+
+	// One exact-name rule per accepted client, with its current scsynth and Unreal inputs
+	Profile->Rules.Reset();
+	for (const TPair<FString, TArray<int32>>& Pair : ConnectedUnrealInputIndicesByClient)
+	{
+		FAkMPatchbayRule& Rule = Profile->Rules.AddDefaulted_GetRef();
+		Rule.ClientPattern = Pair.Key;
+		Rule.UnrealInputs = Pair.Value;
+		if (const TArray<int32>* ScInputs = ScsynthInputsByClient.Find(Pair.Key))
+		{
+			Rule.ScsynthInputs = *ScInputs;
+		}
+	}
+	Profiles.ActiveProfile = ProfileName;
+
+	if (!Profiles.SaveToFile(FilePath))
+	{
+		UE_LOG(LogSpatServer, Error, TEXT("Could not write patchbay profiles: %s"), *FilePath);
+		return false;
+	}
+	ActivePatchbayProfile = *Profile;
+	UE_LOG(LogSpatServer, Log, TEXT("Saved patchbay profile '%s' (%d rules)."), *ProfileName, Profile->Rules.Num());
+	return true;
+}
+
+const FAkMPatchbayRule* AakMSpatServerManager::FindPatchbayRule(const FString& ClientName) const
+{
+	if (!bEnablePatchbay || IsServerJackClient(ClientName) || ClientName.Equals(TEXT("system"), ESearchCase::IgnoreCase)
+		|| ClientName.Equals(UnrealJackClientName, ESearchCase::IgnoreCase))
+	{
+		return nullptr;
+	}
+	return ActivePatchbayProfile.FindRule(ClientName);
+}
+
+void AakMSpatServerManager::ApplyPatchbay(const TArray<FString>& ClientNames)
+{
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	if (!JackGraph || ClientNames.IsEmpty())
+	{
+		return;
+	}
+
+	// Plan every matching client, then wire them all in one transaction
+	const double StartTime = FPlatformTime::Seconds();
+	FAkMJackRoutingTransaction Transaction;
+	TArray<FClientRoutingPlan> Plans;
+	for (const FString& ClientName : ClientNames)
+	{
+		const FAkMPatchbayRule* Rule = FindPatchbayRule(ClientName);
+		int32 NumInputs = 0;
+		int32 NumOutputs = 0;
+		if (!Rule)
+		{
+			continue;
 		}
+		FClientRoutingPlan& Plan = Plans.AddDefaulted_GetRef();
+		if (!JackGraph->GetPortCounts(ClientName, NumInputs, NumOutputs) || !PlanExternalClient(ClientName, NumOutputs, Rule, Transaction, Plan))
+		{
+			Plans.Pop();
+			UE_LOG(LogSpatServer, Warning, TEXT("Patchbay '%s': could not wire '%s'; left for manual routing."), *ActivePatchbayProfile.Name, *ClientName);
+			OnPatchbayRuleNotApplied.Broadcast(ClientName, NumInputs, NumOutputs);
+		}
+	}
+	if (Plans.IsEmpty())
+	{
+		return;
+	}
+
+	JackGraph->ApplyRouting(Transaction);
+	const double Now = FPlatformTime::Seconds();
+	for (const FClientRoutingPlan& Plan : Plans)
+	{
+		CommitExternalClient(Plan);
+
+		// Bring-up time runs from the client's appearance (or server readiness, if later) to wired
+		const double* AppearTime = ClientAppearTimes.Find(Plan.ClientName);
+		const double ReadySince = FMath::Max(AppearTime ? *AppearTime : StartTime, ServerConnectedTime);
+		const TArray<int32>* Connected = ConnectedUnrealInputIndicesByClient.Find(Plan.ClientName);
+		UE_LOG(LogSpatServer, Log, TEXT("Patchbay '%s': wired '%s' (%d/%d channels), up %.2f ms after it appeared."),
+			*ActivePatchbayProfile.Name, *Plan.ClientName, Connected ? Connected->Num() : 0, Plan.UnrealIndexByChannel.Num(), (Now - ReadySince) * 1000.0);
+	}
+	UE_LOG(LogSpatServer, Log, TEXT("Patchbay transaction: %d clients, %d operations, %.2f ms."), Plans.Num(), Transaction.Num(), (Now - StartTime) * 1000.0);
+}
+
+void AakMSpatServerManager::ApplyPatchbayToPresentClients()
+{
+	UakMJackGraphSubsystem* JackGraph = GetJackGraph();
+	IAkMJackBackend* Backend = JackGraph ? JackGraph->GetBackend() : nullptr;
+	if (!Backend || ActivePatchbayProfile.Rules.IsEmpty())
+	{
+		return;
 	}
 
-	UE_LOG(LogSpatServer, Log, TEXT("Accepted client '%s' and connected %d channels to scsynth and Unreal inputs."), *ClientName, NumToConnect);
+	TArray<FString> Matching;
+	for (const FString& Client : Backend->GetConnectedClients())
+	{
+		if (FindPatchbayRule(Client) && !ConnectedUnrealInputIndicesByClient.Contains(Client))
+		{
+			Matching.Add(Client);
+		}
+	}
+	ApplyPatchbay(Matching);
 }
 
 void AakMSpatServerManager::PrintToInternalLogs_OSC(FString message)
@@ -533,21 +2072,45 @@ void AakMSpatServerManager::PrintToInternalLogs_OSC(FString message)
 
 void AakMSpatServerManager::SendOSCFloat(const FString& OSCAddress, float Value)
 {
+	if (ServerOSCClient)
+	{
+		FOSCMessage Message;
+		UOSCManager::SetOSCMessageAddress(Message, UOSCManager::ConvertStringToOSCAddress(OSCAddress));
+		UOSCManager::AddFloat(Message, Value);
+		ServerOSCClient->SendOSCMessage(Message);
+		return;
+	}
 	OnRequestedOSCSend_Float.Broadcast(OSCAddress, Value);
 	//UE_LOG(LogSpatServer, Log, TEXT("OSC Send: %s %f"), *OSCAddress, Value);
 }
 
 void AakMSpatServerManager::SendOSCInt(const FString& OSCAddress, int32 Value)
 {
+	if (ServerOSCClient)
+	{
+		FOSCMessage Message;
+		UOSCManager::SetOSCMessageAddress(Message, UOSCManager::ConvertStringToOSCAddress(OSCAddress));
+		UOSCManager::AddInt32(Message, Value);
+		ServerOSCClient->SendOSCMessage(Message);
+		return;
+	}
 	OnRequestedOSCSend_Int.Broadcast(OSCAddress, Value);
 	//UE_LOG(LogSpatServer, Log, TEXT("OSC Send: %s %d"), *OSCAddress, Value);
 }
 
 void AakMSpatServerManager::SendOSCFloatArray(const FString& OSCAddress, const TArray<float>& Value)
 {
+	if (ServerOSCClient)
+	{
+		FOSCMessage Message;
+		UOSCManager::SetOSCMessageAddress(Message, UOSCManager::ConvertStringToOSCAddress(OSCAddress));
+		for (const float Element : Value)
+		{
+			UOSCManager::AddFloat(Message, Element);
+		}
+		ServerOSCClient->SendOSCMessage(Message);
+		return;
+	}
 	OnRequestedOSCSend_FloatArray.Broadcast(OSCAddress, Value);
 	//UE_LOG(LogSpatServer, Log, TEXT("OSC Send Float Array to %s"), *OSCAddress);
 }
-
-
-
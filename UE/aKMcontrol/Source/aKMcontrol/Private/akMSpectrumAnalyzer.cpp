@@ -0,0 +1,298 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMSpectrumAnalyzer.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+
+static_assert(UE_ARRAY_COUNT(FAkMSpectrumFrame::Channels) == FAkMSpectrumAnalyzer::MaxSlots, "Spectrum frame slots");
+
+FAkMSpectrumAnalyzer::FAkMSpectrumAnalyzer()
+{
+	for (std::atomic<int32>& Channel : SlotChannels)
+	{
+		Channel.store(INDEX_NONE);
+	}
+	Spectra.ForEachBuffer([](FAkMSpectrumFrame& Frame)
+	{
+		Frame.FrequenciesHz.SetNumZeroed(NumDisplayBins);
+		Frame.MagnitudesDb.SetNumZeroed(MaxSlots * NumDisplayBins);
+	});
+}
+
+FAkMSpectrumAnalyzer::~FAkMSpectrumAnalyzer()
+{
+	StopAndWait();
+}
+
+void FAkMSpectrumAnalyzer::Start()
+{
+	if (Thread)
+	{
+		return;
+	}
+	bStopRequested = false;
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("AkMSpectrumAnalyzer"), 0, TPri_BelowNormal);
+	bRunning.store(Thread != nullptr);
+}
+
+void FAkMSpectrumAnalyzer::StopAndWait()
+{
+	if (!Thread)
+	{
+		return;
+	}
+	bRunning.store(false);
+	Stop();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+void FAkMSpectrumAnalyzer::Stop()
+{
+	bStopRequested = true;
+	if (WakeEvent)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+void FAkMSpectrumAnalyzer::SetChannel(int32 Slot, int32 Channel)
+{
+	if (Slot >= 0 && Slot < MaxSlots)
+	{
+		SlotChannels[Slot].store(Channel, std::memory_order_relaxed);
+	}
+}
+
+void FAkMSpectrumAnalyzer::PushPlanar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, int32 InSampleRate)
+{
+	if (!bRunning.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+	StreamSampleRate.store(InSampleRate, std::memory_order_relaxed);
+	for (int32 SlotIndex = 0; SlotIndex < MaxSlots; ++SlotIndex)
+	{
+		const int32 Channel = SlotChannels[SlotIndex].load(std::memory_order_relaxed);
+		if (Channel >= 0 && Channel < NumChannels && ChannelData[Channel])
+		{
+			const int32 NumWritten = Slots[SlotIndex].Ring.Write(ChannelData[Channel], NumFrames);
+			if (NumWritten < NumFrames)
+			{
+				NumOverflows.fetch_add(NumFrames - NumWritten, std::memory_order_relaxed);
+			}
+		}
+	}
+}
+
+void FAkMSpectrumAnalyzer::PushInterleaved(const float* Samples, int32 NumChannels, int32 NumFrames, int32 InSampleRate)
+{
+	if (!bRunning.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+	StreamSampleRate.store(InSampleRate, std::memory_order_relaxed);
+	for (int32 SlotIndex = 0; SlotIndex < MaxSlots; ++SlotIndex)
+	{
+		const int32 Channel = SlotChannels[SlotIndex].load(std::memory_order_relaxed);
+		if (Channel >= 0 && Channel < NumChannels)
+		{
+			const int32 NumWritten = Slots[SlotIndex].Ring.Write(Samples + Channel, NumFrames, NumChannels);
+			if (NumWritten < NumFrames)
+			{
+				NumOverflows.fetch_add(NumFrames - NumWritten, std::memory_order_relaxed);
+			}
+		}
+	}
+}
+
+void FAkMSpectrumAnalyzer::Configure(int32 InFFTSize, int32 InSampleRate)
+{
+	FFTSize = InFFTSize;
+	SampleRate = InSampleRate;
+	FFT = MakeUnique<FAkMFFT>(FFTSize);
+
+	HannWindow.SetNumUninitialized(FFTSize);
+	for (int32 i = 0; i < FFTSize; ++i)
+	{
+		HannWindow[i] = 0.5f - 0.5f * FMath::Cos(2.0f * PI * i / FFTSize);
+	}
+	Real.SetNumUninitialized(FFTSize);
+	Imag.SetNumUninitialized(FFTSize);
+
+	// Log-spaced display bins from MinFrequencyHz to Nyquist; a display bin narrower than one FFT bin shows the nearest
+	const float Nyquist = SampleRate * 0.5f;
+	const float BinHz = float(SampleRate) / FFTSize;
+	const float LogRatio = FMath::Loge(Nyquist / MinFrequencyHz);
+	BinStart.SetNumUninitialized(NumDisplayBins);
+	BinEnd.SetNumUninitialized(NumDisplayBins);
+	BinFrequencies.SetNumUninitialized(NumDisplayBins);
+	for (int32 d = 0; d < NumDisplayBins; ++d)
+	{
+		const float Low = MinFrequencyHz * FMath::Exp(LogRatio * d / NumDisplayBins);
+		const float High = MinFrequencyHz * FMath::Exp(LogRatio * (d + 1) / NumDisplayBins);
+		const float Centre = FMath::Sqrt(Low * High);
+		int32 Start = FMath::CeilToInt(Low / BinHz);
+		int32 End = FMath::FloorToInt(High / BinHz) + 1;
+		if (End <= Start)
+		{
+			Start = FMath::RoundToInt(Centre / BinHz);
+			End = Start + 1;
+		}
+		BinStart[d] = FMath::Clamp(Start, 0, FFTSize / 2);
+		BinEnd[d] = FMath::Clamp(End, BinStart[d] + 1, FFTSize / 2 + 1);
+		BinFrequencies[d] = Centre;
+	}
+
+	for (FSlotState& Slot : Slots)
+	{
+		Slot.Window.SetNumZeroed(FFTSize);
+		Slot.NumBuffered = 0;
+		Slot.SmoothedPower.Init(0.0f, NumDisplayBins);
+	}
+}
+
+void FAkMSpectrumAnalyzer::Analyze(FSlotState& Slot)
+{
+	for (int32 i = 0; i < FFTSize; ++i)
+	{
+		Real[i] = Slot.Window[i] * HannWindow[i];
+		Imag[i] = 0.0f;
+	}
+	FFT->Forward(Real.GetData(), Imag.GetData());
+
+	// A full-scale sine reads 0 dB: amplitude = |X| * 2 / (N * Hann coherent gain 0.5)
+	const float Scale = 4.0f / FFTSize;
+	const float Smoothing = 0.5f;
+	for (int32 d = 0; d < NumDisplayBins; ++d)
+	{
+		float Peak = 0.0f;
+		for (int32 k = BinStart[d]; k < BinEnd[d]; ++k)
+		{
+			Peak = FMath::Max(Peak, Real[k] * Real[k] + Imag[k] * Imag[k]);
+		}
+		const float Power = Peak * Scale * Scale;
+		Slot.SmoothedPower[d] = Power + (Slot.SmoothedPower[d] - Power) * Smoothing;
+	}
+	++NumAnalyzed;
+}
+
+void FAkMSpectrumAnalyzer::Publish(float CpuPercent)
+{
+	FAkMSpectrumFrame& Frame = Spectra.GetWriteBuffer();
+	for (int32 d = 0; d < NumDisplayBins; ++d)
+	{
+		Frame.FrequenciesHz[d] = BinFrequencies[d];
+	}
+	for (int32 SlotIndex = 0; SlotIndex < MaxSlots; ++SlotIndex)
+	{
+		const FSlotState& Slot = Slots[SlotIndex];
+		Frame.Channels[SlotIndex] = Slot.Channel;
+		float* Magnitudes = Frame.MagnitudesDb.GetData() + SlotIndex * NumDisplayBins;
+		for (int32 d = 0; d < NumDisplayBins; ++d)
+		{
+			Magnitudes[d] = 10.0f * FMath::LogX(10.0f, FMath::Max(Slot.SmoothedPower[d], 1e-14f));
+		}
+	}
+	Frame.NumBins = NumDisplayBins;
+	Frame.FFTSize = FFTSize;
+	Frame.SampleRate = SampleRate;
+	Frame.CpuPercent = CpuPercent;
+	Frame.NumAnalyzed = NumAnalyzed;
+	Frame.NumSkipped = NumSkipped;
+	Frame.NumOverflows = NumOverflows.load(std::memory_order_relaxed);
+	Spectra.Publish();
+}
+
+uint32 FAkMSpectrumAnalyzer::Run()
+{
+	double LastTime = FPlatformTime::Seconds();
+	double BudgetSeconds = 0.0;
+	double BusySeconds = 0.0;
+	double CpuWindowStart = LastTime;
+	float CpuPercent = 0.0f;
+
+	while (!bStopRequested)
+	{
+		const double Now = FPlatformTime::Seconds();
+		const double Budget = CpuBudgetPercent.load(std::memory_order_relaxed) / 100.0;
+		// Busy time allowed accrues at the budget rate; a short burst may borrow up to 50 ms of it
+		BudgetSeconds = FMath::Min(BudgetSeconds + (Now - LastTime) * Budget, 0.05);
+		LastTime = Now;
+		if (Now - CpuWindowStart >= 1.0)
+		{
+			CpuPercent = float(BusySeconds / (Now - CpuWindowStart) * 100.0);
+			BusySeconds = 0.0;
+			CpuWindowStart = Now;
+		}
+
+		const int32 WantedFFTSize = RequestedFFTSize.load(std::memory_order_relaxed);
+		const int32 WantedSampleRate = StreamSampleRate.load(std::memory_order_relaxed);
+		if (WantedSampleRate > 0 && (WantedFFTSize != FFTSize || WantedSampleRate != SampleRate))
+		{
+			Configure(WantedFFTSize, WantedSampleRate);
+		}
+
+		bool bAnalyzed = false;
+		if (FFT)
+		{
+			const int32 Hop = FFTSize / 2;
+			for (int32 SlotIndex = 0; SlotIndex < MaxSlots; ++SlotIndex)
+			{
+				FSlotState& Slot = Slots[SlotIndex];
+				const int32 Channel = SlotChannels[SlotIndex].load(std::memory_order_relaxed);
+				if (Channel != Slot.Channel)
+				{
+					// New channel: forget the old one's audio
+					Slot.Channel = Channel;
+					Slot.Ring.Skip(Slot.Ring.NumReadable());
+					Slot.NumBuffered = 0;
+					Slot.SmoothedPower.Init(0.0f, NumDisplayBins);
+					bAnalyzed = true;
+				}
+				if (Channel == INDEX_NONE)
+				{
+					continue;
+				}
+
+				while (Slot.Ring.NumReadable() >= Hop)
+				{
+					// Slide the window by one hop
+					FMemory::Memmove(Slot.Window.GetData(), Slot.Window.GetData() + Hop, (FFTSize - Hop) * sizeof(float));
+					Slot.Ring.Read(Slot.Window.GetData() + FFTSize - Hop, Hop);
+					Slot.NumBuffered = FMath::Min(Slot.NumBuffered + Hop, FFTSize);
+					if (Slot.NumBuffered < FFTSize)
+					{
+						continue;
+					}
+					if (BudgetSeconds <= 0.0)
+					{
+						++NumSkipped;
+						continue;
+					}
+					const double StartTime = FPlatformTime::Seconds();
+					Analyze(Slot);
+					const double Elapsed = FPlatformTime::Seconds() - StartTime;
+					BudgetSeconds -= Elapsed;
+					BusySeconds += Elapsed;
+					bAnalyzed = true;
+				}
+			}
+		}
+
+		if (bAnalyzed)
+		{
+			Publish(CpuPercent);
+		}
+		else
+		{
+			WakeEvent->Wait(5);
+		}
+	}
+	return 0;
+}
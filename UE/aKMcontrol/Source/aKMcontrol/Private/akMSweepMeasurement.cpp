@@ -0,0 +1,275 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "akMSweepMeasurement.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	// Regularization of the inverse: bins more than 60 dB below the sweep's strongest are not boosted
+	constexpr float InverseRegularization = 1e-6f;
+}
+
+FAkMSweepMeasurement::~FAkMSweepMeasurement()
+{
+	AnalysisTask.Wait();
+}
+
+bool FAkMSweepMeasurement::Begin(const FAkMSweepSettings& InSweep, int32 SampleRate, int32 NumSpeakers, float LevelDb)
+{
+	const EAkMSweepMeasurementState Current = GetState();
+	if ((Current != EAkMSweepMeasurementState::Idle && Current != EAkMSweepMeasurementState::Captured) || SampleRate <= 0 || NumSpeakers <= 0 || NumSpeakers > MaxSpeakers)
+	{
+		return false;
+	}
+	State.store(EAkMSweepMeasurementState::Idle, std::memory_order_release);
+
+	Sweep = InSweep;
+	MeasurementSampleRate = SampleRate;
+	NumSpeakerSlots = NumSpeakers;
+	SweepLength = int32(Sweep.GetSweepFrames(SampleRate));
+	CaptureLength = SweepLength + int32(TailSeconds * SampleRate);
+	SweepGain = FMath::Pow(10.0f, FMath::Min(LevelDb, 0.0f) / 20.0f);
+
+	SweepSamples.SetNumUninitialized(SweepLength);
+	FAkMSignalGenerator::RenderSweep(Sweep, SampleRate, 0, SweepSamples.GetData(), SweepLength);
+	Captures.SetNumZeroed(NumSpeakers * CaptureLength);
+
+	// Linear deconvolution of every lag of the capture without wrap-around
+	if (!FFT || FFT->GetSize() != FAkMFFT::GetSizeFor(CaptureLength + SweepLength))
+	{
+		FFT = MakeUnique<FAkMFFT>(CaptureLength + SweepLength);
+	}
+	const int32 FFTSize = FFT->GetSize();
+	InverseReal.SetNumZeroed(FFTSize);
+	InverseImag.SetNumZeroed(FFTSize);
+	FMemory::Memcpy(InverseReal.GetData(), SweepSamples.GetData(), SweepLength * sizeof(float));
+	FFT->Forward(InverseReal.GetData(), InverseImag.GetData());
+	float MaxPower = 0.0f;
+	for (int32 k = 0; k < FFTSize; ++k)
+	{
+		MaxPower = FMath::Max(MaxPower, InverseReal[k] * InverseReal[k] + InverseImag[k] * InverseImag[k]);
+	}
+	// conj(X) / (|X|^2 + eps), also undoing the playback gain
+	const float Epsilon = MaxPower * InverseRegularization;
+	for (int32 k = 0; k < FFTSize; ++k)
+	{
+		const float Power = InverseReal[k] * InverseReal[k] + InverseImag[k] * InverseImag[k];
+		const float Scale = 1.0f / ((Power + Epsilon) * SweepGain);
+		InverseReal[k] *= Scale;
+		InverseImag[k] *= -Scale;
+	}
+
+	Results.Reset();
+	Results.SetNum(NumSpeakers);
+	return true;
+}
+
+bool FAkMSweepMeasurement::MeasureSpeaker(int32 Speaker, int32 InOutputChannel, int32 InInputChannel)
+{
+	const EAkMSweepMeasurementState Current = GetState();
+	if ((Current != EAkMSweepMeasurementState::Idle && Current != EAkMSweepMeasurementState::Captured) || Speaker < 0 || Speaker >= NumSpeakerSlots
+		|| InOutputChannel < 0 || InInputChannel < 0)
+	{
+		return false;
+	}
+	CurrentSpeaker = Speaker;
+	OutputChannel = InOutputChannel;
+	InputChannel = InInputChannel;
+	FMemory::Memzero(Captures.GetData() + Speaker * CaptureLength, CaptureLength * sizeof(float));
+	StartTime = FPlatformTime::Seconds();
+	State.store(EAkMSweepMeasurementState::Armed, std::memory_order_release);
+	return true;
+}
+
+bool FAkMSweepMeasurement::Analyze()
+{
+	const EAkMSweepMeasurementState Current = GetState();
+	if ((Current != EAkMSweepMeasurementState::Idle && Current != EAkMSweepMeasurementState::Captured) || NumSpeakerSlots == 0)
+	{
+		return false;
+	}
+	State.store(EAkMSweepMeasurementState::Analyzing, std::memory_order_relaxed);
+	PendingResults.Reset();
+	PendingResults.SetNum(NumSpeakerSlots);
+	AnalysisTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this]
+	{
+		ParallelFor(NumSpeakerSlots, [this](int32 Speaker)
+		{
+			Deconvolve(Speaker, PendingResults[Speaker]);
+		});
+	});
+	return true;
+}
+
+void FAkMSweepMeasurement::Cancel()
+{
+	EAkMSweepMeasurementState Expected = EAkMSweepMeasurementState::Armed;
+	if (!State.compare_exchange_strong(Expected, EAkMSweepMeasurementState::Idle))
+	{
+		Expected = EAkMSweepMeasurementState::Running;
+		State.compare_exchange_strong(Expected, EAkMSweepMeasurementState::Idle);
+	}
+}
+
+bool FAkMSweepMeasurement::Tick()
+{
+	switch (GetState())
+	{
+	case EAkMSweepMeasurementState::Armed:
+	case EAkMSweepMeasurementState::Running:
+		if (FPlatformTime::Seconds() - StartTime > double(CaptureLength) / MeasurementSampleRate + TimeoutSeconds)
+		{
+			Cancel();
+		}
+		return false;
+
+	case EAkMSweepMeasurementState::Analyzing:
+		if (!AnalysisTask.IsCompleted())
+		{
+			return false;
+		}
+		Results = MoveTemp(PendingResults);
+		PendingResults.Reset();
+		State.store(EAkMSweepMeasurementState::Idle, std::memory_order_release);
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+void FAkMSweepMeasurement::RenderOutput(float* const* OutputData, int32 NumChannels, int32 NumFrames, uint64 FrameCounter)
+{
+	EAkMSweepMeasurementState Current = State.load(std::memory_order_acquire);
+	if (Current == EAkMSweepMeasurementState::Armed)
+	{
+		EmitFrame.store(FrameCounter, std::memory_order_relaxed);
+		EmitPosition = 0;
+		// Lost to a concurrent Cancel: leave it idle
+		if (!State.compare_exchange_strong(Current, EAkMSweepMeasurementState::Running, std::memory_order_acq_rel))
+		{
+			return;
+		}
+		Current = EAkMSweepMeasurementState::Running;
+	}
+	if (Current != EAkMSweepMeasurementState::Running || EmitPosition >= SweepLength || OutputChannel >= NumChannels || !OutputData[OutputChannel])
+	{
+		return;
+	}
+	float* Out = OutputData[OutputChannel];
+	const int32 Count = FMath::Min(NumFrames, SweepLength - EmitPosition);
+	const float* Source = SweepSamples.GetData() + EmitPosition;
+	for (int32 i = 0; i < Count; ++i)
+	{
+		Out[i] += Source[i] * SweepGain;
+	}
+	EmitPosition += Count;
+}
+
+bool FAkMSweepMeasurement::BeginCapture(int32 NumFrames, uint64 FrameCounter, int32& OutStart, int32& OutEnd, int64& OutOffset) const
+{
+	if (State.load(std::memory_order_acquire) != EAkMSweepMeasurementState::Running)
+	{
+		return false;
+	}
+	// Position of this block relative to the sweep's first frame
+	OutOffset = int64(FrameCounter) - int64(EmitFrame.load(std::memory_order_relaxed));
+	OutStart = int32(FMath::Clamp<int64>(-OutOffset, 0, NumFrames));
+	OutEnd = int32(FMath::Clamp<int64>(CaptureLength - OutOffset, 0, NumFrames));
+	return true;
+}
+
+void FAkMSweepMeasurement::EndCapture(int32 NumFrames, int64 Offset)
+{
+	if (Offset + NumFrames >= CaptureLength)
+	{
+		EAkMSweepMeasurementState Expected = EAkMSweepMeasurementState::Running;
+		State.compare_exchange_strong(Expected, EAkMSweepMeasurementState::Captured, std::memory_order_acq_rel);
+	}
+}
+
+void FAkMSweepMeasurement::CapturePlanar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, uint64 FrameCounter)
+{
+	int32 Start, End;
+	int64 Offset;
+	if (!BeginCapture(NumFrames, FrameCounter, Start, End, Offset))
+	{
+		return;
+	}
+	if (End > Start && InputChannel < NumChannels && ChannelData[InputChannel])
+	{
+		FMemory::Memcpy(Captures.GetData() + CurrentSpeaker * CaptureLength + Offset + Start, ChannelData[InputChannel] + Start, (End - Start) * sizeof(float));
+	}
+	EndCapture(NumFrames, Offset);
+}
+
+void FAkMSweepMeasurement::CaptureInterleaved(const float* Samples, int32 NumChannels, int32 NumFrames, uint64 FrameCounter)
+{
+	int32 Start, End;
+	int64 Offset;
+	if (!BeginCapture(NumFrames, FrameCounter, Start, End, Offset))
+	{
+		return;
+	}
+	if (InputChannel < NumChannels)
+	{
+		float* Capture = Captures.GetData() + CurrentSpeaker * CaptureLength + Offset;
+		for (int32 i = Start; i < End; ++i)
+		{
+			Capture[i] = Samples[i * NumChannels + InputChannel];
+		}
+	}
+	EndCapture(NumFrames, Offset);
+}
+
+void FAkMSweepMeasurement::Deconvolve(int32 Speaker, FAkMSpeakerMeasurement& OutResult) const
+{
+	const int32 FFTSize = FFT->GetSize();
+	TArray<float> Real;
+	TArray<float> Imag;
+	Real.SetNumZeroed(FFTSize);
+	Imag.SetNumZeroed(FFTSize);
+	FMemory::Memcpy(Real.GetData(), Captures.GetData() + Speaker * CaptureLength, CaptureLength * sizeof(float));
+	FFT->Forward(Real.GetData(), Imag.GetData());
+	for (int32 k = 0; k < FFTSize; ++k)
+	{
+		const float Re = Real[k] * InverseReal[k] - Imag[k] * InverseImag[k];
+		const float Im = Real[k] * InverseImag[k] + Imag[k] * InverseReal[k];
+		Real[k] = Re;
+		Imag[k] = Im;
+	}
+	FFT->Inverse(Real.GetData(), Imag.GetData());
+
+	// The linear response sits at lags [0, tail); harmonic distortion products wrap around to the end of the buffer
+	const int32 TailLength = CaptureLength - SweepLength;
+	int32 Peak = 0;
+	for (int32 Lag = 1; Lag < TailLength; ++Lag)
+	{
+		if (FMath::Abs(Real[Lag]) > FMath::Abs(Real[Peak]))
+		{
+			Peak = Lag;
+		}
+	}
+
+	const int32 WindowStart = FMath::Max(0, Peak - int32(LevelWindowBeforeSeconds * MeasurementSampleRate));
+	const int32 WindowEnd = FMath::Min(TailLength, Peak + int32(LevelWindowAfterSeconds * MeasurementSampleRate));
+	double Energy = 0.0;
+	for (int32 i = WindowStart; i < WindowEnd; ++i)
+	{
+		Energy += double(Real[i]) * Real[i];
+	}
+
+	// Noise floor from lags past the response, before the distortion products
+	const int32 NoiseStart = TailLength;
+	const int32 NoiseEnd = FMath::Min(FFTSize / 2, TailLength * 2);
+	double NoiseEnergy = 0.0;
+	for (int32 i = NoiseStart; i < NoiseEnd; ++i)
+	{
+		NoiseEnergy += double(Real[i]) * Real[i];
+	}
+	const double NoiseRms = FMath::Sqrt(NoiseEnergy / FMath::Max(1, NoiseEnd - NoiseStart));
+
+	OutResult.LevelDb = float(10.0 * FMath::LogX(10.0, FMath::Max(Energy, 1e-30)));
+	OutResult.PeakToNoiseDb = float(20.0 * FMath::LogX(10.0, FMath::Max<double>(FMath::Abs(Real[Peak]), 1e-20) / FMath::Max(NoiseRms, 1e-20)));
+	OutResult.DelaySamples = OutResult.PeakToNoiseDb >= DetectionThresholdDb ? Peak : INDEX_NONE;
+}
@@ -97,6 +97,22 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void SetReverb(float InReverb);
 
+	// Send current spatialization parameters to the server (no-op when inactive)
+	void SendParamsToServer() const;
+
+	// While the signal feeding the source is silent, parameter changes are held back and only the latest state is sent
+	// by FlushPendingParams; turning the signal back on sends it at once
+	void SetSignalActive(bool bInSignalActive);
+	bool IsSignalActive() const { return bSignalActive; }
+	// Send held-back parameters if at least MinIntervalSeconds passed since the last send
+	void FlushPendingParams(double MinIntervalSeconds);
+
+	// Custom primitive data slot of the outer sphere holding the source's level; the material reads it (emissive)
+	static constexpr int32 LevelPrimitiveDataIndex = 0;
+
+	// Audio level, 0..1 on the meter scale; only pushed to the renderer when it moves visibly
+	void SetLevel(float InLevel);
+
 
 protected:
 	// Called when the game starts or when spawned
@@ -111,7 +127,6 @@ private:
 	void EnsureDynamicMaterial();
 	void ApplyColorToMaterial();
 	void UpdateTextFacing();
-	void SendParamsToServer() const;
 
 	void SetSpatServerManager(AakMSpatServerManager* InManager) { SpatServerManager = InManager; }
 
@@ -120,6 +135,16 @@ private:
 
 	float InnerMeshRadius = 10.0f;
 
+	// Level last written to the custom primitive data
+	float VisualLevel = -1.0f;
+
+	// Setters go through here: sends now, or holds the change back while the signal is silent
+	void UpdateServerParams();
+
+	bool bSignalActive = true;
+	mutable bool bParamsPending = false;
+	mutable double LastParamsSendSeconds = 0.0;
+
 	// Reference to akM Spat Server Manager (set by SourcesManager)
 	UPROPERTY()
 	AakMSpatServerManager* SpatServerManager = nullptr;
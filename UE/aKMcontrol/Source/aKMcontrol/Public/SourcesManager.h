@@ -8,6 +8,7 @@
 #include "SourcesManager.generated.h"
 
 class AakMSpatServerManager;
+class AakMControlAudioManager;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnResetSourcesDemo);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnSourcesDemo1);
@@ -35,6 +36,27 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Object References")
 	AakMSpatServerManager* SpatServerManager = nullptr;
 
+	// Levels of the client channels feeding the sources
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Object References")
+	AakMControlAudioManager* AudioManager = nullptr;
+
+	// Drive each source's outer sphere from the level of its client channel (see ASource::SetLevel)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|SourcesParameters")
+	bool bAudioReactiveVisuals = true;
+
+	// Level shown as 0; 0 dBFS is shown as 1
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|SourcesParameters")
+	float VisualLevelFloorDb = -60.0f;
+
+	// Hold back parameter updates of sources whose client channel is silent (FAkMActivityDetector); sources without
+	// an observed channel are never held back
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|SourcesParameters")
+	bool bGateSilentSources = true;
+
+	// Rate limit of a silent source's parameter updates
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|SourcesParameters", meta=(ClampMin="0.0"))
+	float SilentSourceUpdateSeconds = 0.5f;
+
 	UPROPERTY(BlueprintAssignable, Category="akM|Events")
 	FOnResetSourcesDemo OnResetSourcesDemo;
 
@@ -67,6 +89,10 @@ public:
 
 	UFUNCTION(BlueprintCallable)
 	int32 GetNumActive() const;
+
+	// Resend parameters of all active sources (e.g. after server failover)
+	UFUNCTION()
+	void ResendAllSourceParams();
 	
 protected:
 	// Called when the game starts or when spawned
@@ -77,4 +103,13 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+private:
+	// All source levels in one pass per frame
+	void UpdateSourceLevels();
+	// Signal activity of every source, and the low-rate updates of the silent ones
+	void UpdateSourceActivity();
+
+	// Unreal input per source, refreshed every frame
+	TArray<int32> SourceInputs;
+
 };
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+// Envelope and gate of one channel
+struct FAkMActivityState
+{
+	float Envelope = 0.0f;			// Linear RMS amplitude
+	float HoldSecondsLeft = 0.0f;
+	bool bActive = false;
+};
+
+/**
+ * Signal activity per input channel: an envelope follower on the block RMS (fast attack, slow release) gated with
+ * hysteresis and a hold time, so breaths and short pauses do not toggle it. Stepped once per block on the audio thread
+ * from the levels the tap already computes; the gates are published as a bit set any thread can read.
+ * Owned by FAkMAudioTap.
+ */
+class AKMCONTROL_API FAkMActivityDetector
+{
+public:
+	static constexpr int32 MaxChannels = 512;
+	static constexpr float OpenDb = -50.0f;
+	static constexpr float CloseDb = -60.0f;
+	static constexpr float AttackSeconds = 0.005f;
+	static constexpr float ReleaseSeconds = 0.3f;
+	static constexpr float HoldSeconds = 0.5f;
+	// Gates older than this are not trusted (the audio callback stopped, or the tap is not fed)
+	static constexpr double StaleSeconds = 0.5;
+
+	FAkMActivityDetector();
+
+	// Audio thread: advance NumChannels by one block whose sums of squares are BlockSumSquares
+	void Process(const float* BlockSumSquares, int32 NumChannels, int32 NumFrames, int32 SampleRate);
+
+	// Any thread; channel is 0-based. Without evidence of silence (no block for StaleSeconds, or a channel the blocks
+	// do not carry) a channel counts as active, so nothing is gated on missing audio.
+	bool IsActive(int32 Channel) const;
+
+private:
+	TArray<FAkMActivityState> States;
+	std::atomic<uint64> ActiveBits[MaxChannels / 64];
+	std::atomic<int32> NumProcessedChannels { 0 };
+	std::atomic<uint64> LastProcessCycles { 0 };			// FPlatformTime::Cycles64 of the last block; 0 = never
+
+	// Envelope factors, recomputed when the block length changes
+	float BlockSeconds = 0.0f;
+	float AttackSmoothing = 0.0f;
+	float ReleaseSmoothing = 0.0f;
+};
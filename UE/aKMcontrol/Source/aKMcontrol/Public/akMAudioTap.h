@@ -0,0 +1,171 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "akMActivityDetector.h"
+#include "akMFilePlayer.h"
+#include "akMLatencyProbe.h"
+#include "akMLevelHistory.h"
+#include "akMLoudnessMeter.h"
+#include "akMMeterBallistics.h"
+#include "akMRecorder.h"
+#include "akMSignalGenerator.h"
+#include "akMSpectrumAnalyzer.h"
+#include "akMSpscRing.h"
+#include "akMSweepMeasurement.h"
+#include "akMTripleBuffer.h"
+#include <atomic>
+
+// Levels of one channel over the blocks a meter frame covers (linear amplitude)
+struct FAkMChannelLevel
+{
+	float Rms = 0.0f;
+	float Peak = 0.0f;			// Sample peak, |x|
+	uint32 ClipCount = 0;		// Clipped samples since the tap started (cumulative, so no frame loses clips)
+	float Meter = 0.0f;			// Level after the meter ballistics, at the end of the frame
+	float HoldPeak = 0.0f;		// Held sample peak, at the end of the frame
+};
+
+// Snapshot published to the game thread; covers every block since the reader's previous snapshot
+struct FAkMLevelMeterFrame
+{
+	TArray<FAkMChannelLevel> Channels;	// Preallocated to FAkMAudioTap::MaxChannels; NumChannels are valid
+	int32 NumChannels = 0;
+	int32 NumBlocks = 0;				// Audio blocks merged into this frame
+	int32 NumFrames = 0;				// Sample frames merged into this frame
+	int32 SampleRate = 0;
+	uint64 BlockCounter = 0;			// Blocks processed since the tap started
+
+	// Loudness per speaker column (FAkMLoudnessMeter layout order) and of the master
+	TArray<FAkMLoudness> GroupLoudness;	// Preallocated to FAkMLoudnessMeter::MaxGroups; NumLoudnessGroups are valid
+	int32 NumLoudnessGroups = 0;
+	FAkMLoudness MasterLoudness;
+};
+
+// One audio block queued for FAkMLevelHistory; followed in the range ring by NumChannels FAkMLevelRange
+struct FAkMHistoryBlock
+{
+	int32 NumChannels = 0;
+	int32 NumFrames = 0;
+	int32 SampleRate = 0;
+};
+
+/**
+ * Per-block analysis of the Unreal JACK client's inputs, run on the audio thread.
+ * The module registers JackProcessHook with UEJackAudioLink at startup (UEJackAudioLink::SetProcessHook); the plugin's
+ * JACK process callback calls it once per block with the client's port buffers. Levels are published through a
+ * wait-free triple buffer; the game thread reads the latest consistent snapshot of all channels with ReadLevels.
+ */
+class AKMCONTROL_API FAkMAudioTap
+{
+public:
+	static constexpr int32 MaxChannels = 512;
+
+	// Samples at or above this magnitude count as clipped
+	static constexpr float ClipThreshold = 0.999f;
+
+	static FAkMAudioTap& Get();
+
+	FAkMAudioTap();
+
+	// Audio thread: UEJackAudioLink process hook; UserData is the tap. Inputs first, then the outputs, which hold the
+	// plugin's own output and are added to.
+	static void JackProcessHook(void* UserData, const float* const* Inputs, int32 NumInputs, float* const* Outputs, int32 NumOutputs, int32 NumFrames, int32 SampleRate);
+
+	// Audio thread: planar float buffers, one per channel. Never allocates or locks.
+	void ProcessBlock(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, int32 SampleRate);
+
+	// Audio thread: one interleaved float buffer
+	void ProcessInterleavedBlock(const float* Samples, int32 NumChannels, int32 NumFrames, int32 SampleRate);
+
+	// Audio thread: planar output buffers of the Unreal client, once per block in the same process callback as the
+	// inputs. Signals generated here are added to what the buffers already hold.
+	void RenderOutputBlock(float* const* OutputData, int32 NumChannels, int32 NumFrames, int32 SampleRate);
+
+	// Any thread; applied from the next audio block
+	void SetBallistics(EAkMMeterBallistics Preset) { RequestedBallistics.store(Preset, std::memory_order_relaxed); }
+	EAkMMeterBallistics GetBallistics() const { return RequestedBallistics.load(std::memory_order_relaxed); }
+
+	// Layout and integrated-loudness reset are set from the game thread
+	FAkMLoudnessMeter& GetLoudnessMeter() { return Loudness; }
+
+	// Fed with every block; its worker thread is started and stopped by the game
+	FAkMSpectrumAnalyzer& GetSpectrumAnalyzer() { return Spectrum; }
+
+	// Driven from the game thread; plays on the outputs and captures the inputs
+	FAkMLatencyProbe& GetLatencyProbe() { return LatencyProbe; }
+
+	// Started and stopped from the game thread; records the selected inputs of every block while running
+	FAkMRecorder& GetRecorder() { return Recorder; }
+
+	// Started and stopped from the game thread; plays into the outputs
+	FAkMFilePlayer& GetFilePlayer() { return FilePlayer; }
+
+	// Calibration signals on the outputs; controlled from any thread
+	FAkMSignalGenerator& GetSignalGenerator() { return SignalGenerator; }
+
+	// Driven from the game thread; plays sweeps on the outputs and captures the measurement input
+	FAkMSweepMeasurement& GetSweepMeasurement() { return SweepMeasurement; }
+
+	// Signal activity of every input, stepped with each block
+	const FAkMActivityDetector& GetActivityDetector() const { return Activity; }
+
+	// Rate of the stream the output callback last ran at; 0 before the first block
+	int32 GetSampleRate() const { return StreamSampleRate.load(std::memory_order_relaxed); }
+
+	// Game thread: take the newest snapshot, if any; the result of LatestLevels() stays valid until the next call
+	bool ReadLevels() { return Levels.Update(); }
+	const FAkMLevelMeterFrame& LatestLevels() const { return Levels.Read(); }
+
+	// Game thread: pop the next queued block's level ranges into OutRanges (MaxChannels); false when none is queued
+	bool ReadHistoryBlock(FAkMHistoryBlock& OutBlock, FAkMLevelRange* OutRanges);
+	// Blocks dropped because the game thread did not drain the history queue in time
+	uint64 GetNumHistoryDrops() const { return NumHistoryDrops.load(std::memory_order_relaxed); }
+
+private:
+	// Merge the Block* results of one block and publish
+	void AccumulateAndPublish(int32 NumChannels, int32 NumFrames, int32 SampleRate);
+
+	// Levels of the current block (FAkMLevelKernel output)
+	TArray<float> BlockSumSquares;
+	TArray<float> BlockPeaks;
+	TArray<uint32> BlockClips;
+
+	// Audio-thread accumulators since the reader's last snapshot
+	TArray<double> SumSquares;
+	TArray<float> Peaks;
+	TArray<uint32> ClipCounts;
+	// Audio-thread ballistics, advanced once per block
+	TArray<FAkMMeterState> MeterStates;
+	FAkMMeterBallistics Ballistics;
+	FAkMMeterBallistics::FStepCoefficients StepCoefficients;
+	EAkMMeterBallistics AppliedBallistics = EAkMMeterBallistics::Num;
+	std::atomic<EAkMMeterBallistics> RequestedBallistics { EAkMMeterBallistics::VU };
+
+	int32 AccumulatedBlocks = 0;
+	int32 AccumulatedFrames = 0;
+	uint64 BlockCounter = 0;
+
+	// Per-block level ranges for the game thread's history, about 5 s of 512 channels at 256-frame blocks
+	TArray<FAkMLevelRange> BlockRanges;
+	TAkMSpscRing<FAkMLevelRange> HistoryRanges { 1 << 19 };
+	TAkMSpscRing<FAkMHistoryBlock> HistoryBlocks { 1 << 12 };
+	std::atomic<uint64> NumHistoryDrops { 0 };
+
+	FAkMActivityDetector Activity;
+	FAkMLoudnessMeter Loudness;
+	FAkMSpectrumAnalyzer Spectrum;
+	FAkMLatencyProbe LatencyProbe;
+	FAkMRecorder Recorder;
+	FAkMFilePlayer FilePlayer;
+	FAkMSignalGenerator SignalGenerator;
+	FAkMSweepMeasurement SweepMeasurement;
+	std::atomic<int32> StreamSampleRate { 0 };
+
+	// Stream position of the next block in each direction; both advance once per process callback
+	uint64 InputFrames = 0;
+	uint64 OutputFrames = 0;
+
+	TAkMTripleBuffer<FAkMLevelMeterFrame> Levels;
+};
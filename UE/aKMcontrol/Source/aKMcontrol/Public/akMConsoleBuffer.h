@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Fixed-capacity ring of console lines. Lines are encoded to UTF-8 once at ingest so the UI can hand them
+ * straight to ImGui, and slot storage is reused once the ring is full. Game-thread only.
+ */
+class AKMCONTROL_API FAkMConsoleBuffer
+{
+public:
+	explicit FAkMConsoleBuffer(int32 InMaxLines = 100000);
+
+	// Tag is an opaque per-line value for the renderer (e.g. line severity)
+	void AddLine(FStringView Line, uint8 Tag = 0);
+	void Clear();
+	void SetMaxLines(int32 InMaxLines);
+
+	int32 Num() const { return Count; }
+	int32 GetMaxLines() const { return MaxLines; }
+
+	// Line at Index (0 = oldest retained line) as a UTF-8 range, not null-terminated
+	void GetLine(int32 Index, const char*& OutBegin, const char*& OutEnd) const;
+	uint8 GetLineTag(int32 Index) const { return Tags[(Head + Index) % MaxLines]; }
+
+	// Monotonic number of the oldest retained line; lines keep their number while they stay in the buffer
+	uint64 GetFirstLineNumber() const { return TotalLinesAdded - Count; }
+	uint64 GetTotalLinesAdded() const { return TotalLinesAdded; }
+
+private:
+	TArray<TArray<ANSICHAR>> Lines;
+	TArray<uint8> Tags;
+	int32 MaxLines = 100000;
+	int32 Head = 0;		// Slot of the oldest line
+	int32 Count = 0;
+	uint64 TotalLinesAdded = 0;
+};
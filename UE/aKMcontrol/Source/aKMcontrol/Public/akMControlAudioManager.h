@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "UEJackAudioLinkSubsystem.h"
+#include "akMJackGraphSubsystem.h"
+#include "akMAudioTap.h"
 
 #include "akMControlAudioManager.generated.h"
 
@@ -22,17 +24,67 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	UPROPERTY()
 	UUEJackAudioLinkSubsystem* JackAudioLinkSubsystem;
 
+	// Cached port registry, read every frame for the channel count
+	UPROPERTY()
+	UakMJackGraphSubsystem* JackGraphSubsystem;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
-	// Level meter state for all channels
+	// Meter ballistics, applied per audio block by FAkMAudioTap (per frame, by elapsed time, when polling)
+	EAkMMeterBallistics MeterBallistics = EAkMMeterBallistics::VU;
+
+	// Level meter state for all channels: level after ballistics and held sample peak
 	TArray<float> SmoothedRmsLevels;
 	TArray<float> PeakLevels;
-	TArray<float> TimesOfLastPeak;
+
+	// Sample peaks and cumulative clip counts from FAkMAudioTap (peaks fall back to the polled RMS without it)
+	TArray<float> SamplePeakLevels;
+	TArray<uint32> ClipCounts;
+
+	// BS.1770 loudness per speaker column and of the master (audio-thread measurement only)
+	TArray<FAkMLoudness> GroupLoudness;
+	FAkMLoudness MasterLoudness;
+
+	// Spectrum analyzer settings, applied every frame: Unreal input (0-based, INDEX_NONE = off) per slot, FFT size and
+	// the share of one core the analyzer worker may use
+	int32 SpectrumChannels[FAkMSpectrumAnalyzer::MaxSlots] = { 0, INDEX_NONE, INDEX_NONE, INDEX_NONE };
+	int32 SpectrumFFTSize = 4096;
+	float SpectrumCpuBudgetPercent = 5.0f;
+
+	// Scroll-back min/max history of the first LevelHistoryChannels inputs at audio-block resolution (FAkMAudioTap
+	// only). The span is cut to stay within LevelHistoryMaxMB; see FAkMLevelHistory for its memory use.
+	FAkMLevelHistory LevelHistory;
+	float LevelHistoryMinutes = 60.0f;
+	int32 LevelHistoryChannels = 64;
+	float LevelHistoryMaxMB = 128.0f;
+
+	// Newest spectra published by the analyzer worker
+	const FAkMSpectrumFrame& GetSpectrum() const { return FAkMAudioTap::Get().GetSpectrumAnalyzer().LatestSpectrum(); }
+
+	// Record the given Unreal inputs (1-based) to a new float WAVE/RF64 file under Saved/akM/Recordings
+	bool StartRecording(const TArray<int32>& Inputs1Based);
+	// Blocks until the file is finalized
+	void StopRecording();
+	const FAkMRecorder& GetRecorder() const { return FAkMAudioTap::Get().GetRecorder(); }
+
+	// True while FAkMAudioTap publishes levels; otherwise levels are polled through GetInputLevel once per frame
+	bool IsUsingAudioThreadLevels() const { return bUsingAudioThreadLevels; }
+
+private:
+	bool bUsingAudioThreadLevels = false;
+	double LastTapSnapshotTime = -1.0;
+
+	// Ballistics of the GetInputLevel fallback
+	TArray<FAkMMeterState> PolledMeterStates;
+
+	// One history block read from the tap
+	TArray<FAkMLevelRange> HistoryBlockRanges;
 
 };
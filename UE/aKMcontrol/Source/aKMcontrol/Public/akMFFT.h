@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * In-place iterative radix-2 complex FFT of a fixed power-of-two size, with twiddles and the bit-reversal table
+ * computed once. Split real/imaginary arrays; Inverse scales by 1/N. Const methods are safe to call concurrently.
+ */
+class AKMCONTROL_API FAkMFFT
+{
+public:
+	explicit FAkMFFT(int32 InSize);
+
+	int32 GetSize() const { return Size; }
+
+	void Forward(float* Real, float* Imag) const { Transform(Real, Imag, false); }
+	void Inverse(float* Real, float* Imag) const;
+
+	// Smallest power of two >= NumSamples
+	static int32 GetSizeFor(int32 NumSamples) { return int32(FMath::RoundUpToPowerOfTwo(uint32(FMath::Max(2, NumSamples)))); }
+
+private:
+	void Transform(float* Real, float* Imag, bool bInverse) const;
+
+	int32 Size = 0;
+	TArray<int32> BitReverse;
+	TArray<float> Cos;
+	TArray<float> Sin;
+};
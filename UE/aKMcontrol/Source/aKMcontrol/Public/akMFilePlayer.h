@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "akMSpscRing.h"
+#include <atomic>
+
+class IFileHandle;
+
+// Sample layout and data chunk of a WAVE/RF64 file
+struct FAkMWaveFormat
+{
+	int32 NumChannels = 0;
+	int32 SampleRate = 0;
+	int32 BitsPerSample = 0;
+	bool bFloat = false;
+	int64 DataOffset = 0;
+	int64 DataBytes = 0;
+
+	int32 GetBlockAlign() const { return NumChannels * BitsPerSample / 8; }
+	int64 GetNumFrames() const { return GetBlockAlign() > 0 ? DataBytes / GetBlockAlign() : 0; }
+
+	// Parse the header of an open file (16/24/32-bit PCM or 32-bit float, plain or extensible); false if unsupported
+	static bool Read(IFileHandle& File, FAkMWaveFormat& OutFormat);
+};
+
+/**
+ * Streams a multichannel WAVE/RF64 file out of the Unreal JACK client's outputs. A reader thread decodes the file to
+ * float ahead of playback into a lock-free ring; the audio thread only copies from the ring, so it never touches the
+ * disk. Looping seeks back on the reader thread and keeps filling the same ring, so the loop point is gapless.
+ * A ring that runs dry plays silence for the missing frames (an underrun). The file is played at the stream's rate.
+ */
+class AKMCONTROL_API FAkMFilePlayer : public FRunnable
+{
+public:
+	static constexpr int32 MaxChannels = 256;
+	static constexpr int32 StagingFrames = 512;
+	static constexpr int32 ReadChunkFrames = 4096;
+	static constexpr int32 AssumedSampleRate = 48000;
+
+	virtual ~FAkMFilePlayer() override;
+
+	// Game thread: play FilePath, file channel N going to OutputChannels[N] (0-based, INDEX_NONE = not played),
+	// reading up to ReadAheadSeconds ahead
+	bool StartPlayback(const FString& FilePath, TConstArrayView<int32> OutputChannels, bool bLoop, float ReadAheadSeconds = 2.0f);
+	// Game thread: stop and close the file; blocks until the reader thread has finished
+	void StopPlayback();
+
+	bool IsPlaying() const { return Thread != nullptr; }
+	// The whole file has been played (never while looping)
+	bool IsFinished() const { return bFinished.load(std::memory_order_acquire); }
+	const FString& GetFilePath() const { return FilePath; }
+	const FAkMWaveFormat& GetFormat() const { return Format; }
+	int64 GetFramesPlayed() const { return FramesPlayed.load(std::memory_order_relaxed); }
+	uint64 GetNumUnderruns() const { return NumUnderruns.load(std::memory_order_relaxed); }
+	// 0..1, how full the read-ahead ring is
+	float GetRingFill() const;
+
+	// Audio thread; adds the file to the output buffers, never blocks or allocates
+	void RenderOutput(float* const* OutputData, int32 NumChannels, int32 NumFrames);
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	enum class EState : uint8
+	{
+		Idle,
+		Playing,
+		Stopping,		// Set by the game thread
+		Stopped			// Acknowledged by the audio thread: it no longer touches the ring
+	};
+
+	// Reader thread: decode the next chunk into the ring; false when there is nothing to do right now
+	bool ReadChunk();
+
+	FString FilePath;
+	FAkMWaveFormat Format;
+	int32 OutputChannelMap[MaxChannels] = {};
+	int32 NumFileChannels = 0;
+	bool bLooping = false;
+
+	std::atomic<EState> State { EState::Idle };
+	TUniquePtr<TAkMSpscRing<float>> Ring;
+	std::atomic<bool> bPrimed { false };
+	std::atomic<bool> bEndOfFile { false };
+	std::atomic<bool> bFinished { false };
+	std::atomic<int64> FramesPlayed { 0 };
+	std::atomic<uint64> NumUnderruns { 0 };
+
+	// Audio thread
+	TArray<float> Staging;
+
+	// Reader thread
+	IFileHandle* File = nullptr;
+	int64 ReadPosition = 0;			// Bytes into the data chunk
+	TArray<uint8> ReadBuffer;
+	TArray<float> DecodeBuffer;
+
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeEvent = nullptr;
+	FThreadSafeBool bStopRequested = false;
+};
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UUEJackAudioLinkSubsystem;
+
+/**
+ * The part of the JACK API the routing code uses. The live implementation forwards to UEJackAudioLink;
+ * FAkMMockJackBackend simulates a JACK server in-process for headless runs and benchmarks.
+ */
+class AKMCONTROL_API IAkMJackBackend
+{
+public:
+	virtual ~IAkMJackBackend() = default;
+
+	virtual FString GetJackClientName() const = 0;
+	virtual TArray<FString> GetConnectedClients() const = 0;
+
+	// Full port names of ClientName, in JACK order
+	virtual void GetClientPorts(const FString& ClientName, TArray<FString>& OutInputPorts, TArray<FString>& OutOutputPorts) const = 0;
+
+	// Full names of the ports connected to Port (either direction); false if the backend cannot list connections
+	virtual bool GetPortConnections(const FString& Port, TArray<FString>& OutConnectedPorts) const = 0;
+
+	virtual bool ConnectPorts(const FString& SourcePort, const FString& DestinationPort) = 0;
+	virtual bool DisconnectPorts(const FString& SourcePort, const FString& DestinationPort) = 0;
+};
+
+// Backend forwarding to the UEJackAudioLink engine subsystem
+class AKMCONTROL_API FAkMJackLinkBackend : public IAkMJackBackend
+{
+public:
+	virtual FString GetJackClientName() const override;
+	virtual TArray<FString> GetConnectedClients() const override;
+	virtual void GetClientPorts(const FString& ClientName, TArray<FString>& OutInputPorts, TArray<FString>& OutOutputPorts) const override;
+	virtual bool GetPortConnections(const FString& Port, TArray<FString>& OutConnectedPorts) const override;
+	virtual bool ConnectPorts(const FString& SourcePort, const FString& DestinationPort) override;
+	virtual bool DisconnectPorts(const FString& SourcePort, const FString& DestinationPort) override;
+
+private:
+	static UUEJackAudioLinkSubsystem* GetJackSubsystem();
+};
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// One JACK connection between two full port names ("client:port"), from an output port to an input port
+struct FAkMJackConnection
+{
+	FString Source;
+	FString Destination;
+
+	FAkMJackConnection() = default;
+	FAkMJackConnection(const FString& InSource, const FString& InDestination)
+		: Source(InSource), Destination(InDestination) {}
+
+	bool operator==(const FAkMJackConnection& Other) const
+	{
+		return Source.Equals(Other.Source, ESearchCase::IgnoreCase) && Destination.Equals(Other.Destination, ESearchCase::IgnoreCase);
+	}
+
+	friend uint32 GetTypeHash(const FAkMJackConnection& Connection)
+	{
+		return HashCombine(GetTypeHash(Connection.Source), GetTypeHash(Connection.Destination));
+	}
+};
+
+// Batch of routing operations, applied disconnects first
+struct FAkMJackRoutingTransaction
+{
+	TArray<FAkMJackConnection> Connects;
+	TArray<FAkMJackConnection> Disconnects;
+
+	void Connect(const FString& Source, const FString& Destination) { Connects.Emplace(Source, Destination); }
+	void Disconnect(const FString& Source, const FString& Destination) { Disconnects.Emplace(Source, Destination); }
+	bool IsEmpty() const { return Connects.IsEmpty() && Disconnects.IsEmpty(); }
+	int32 Num() const { return Connects.Num() + Disconnects.Num(); }
+	void Reset() { Connects.Reset(); Disconnects.Reset(); }
+};
+
+/**
+ * Cached model of the JACK graph: clients, their ports (ordered as JACK reports them) and the connections between
+ * ports. Routing changes are reduced against the model so only operations that change the graph reach JACK.
+ * Game-thread only; every change bumps the generation counter.
+ */
+class AKMCONTROL_API FAkMJackGraph
+{
+public:
+	struct FClient
+	{
+		TArray<FString> InputPorts;
+		TArray<FString> OutputPorts;
+	};
+
+	// Clients and ports
+	void SetClient(const FString& ClientName, TArray<FString> InputPorts, TArray<FString> OutputPorts);
+	void RemoveClient(const FString& ClientName);
+	void Reset();
+
+	const FClient* FindClient(const FString& ClientName) const { return Clients.Find(ClientName); }
+	const TMap<FString, FClient>& GetClients() const { return Clients; }
+
+	// Full port name of the 1-based input/output port of a client, or nullptr when unknown
+	const FString* GetInputPort(const FString& ClientName, int32 Index1Based) const;
+	const FString* GetOutputPort(const FString& ClientName, int32 Index1Based) const;
+
+	// Connections
+	void AddConnection(const FString& Source, const FString& Destination);
+	void RemoveConnection(const FString& Source, const FString& Destination);
+
+	bool IsConnected(const FString& Source, const FString& Destination) const;
+	void GetDestinations(const FString& SourcePort, TArray<FString>& OutDestinations) const;
+	void GetSources(const FString& DestinationPort, TArray<FString>& OutSources) const;
+
+	// All known connections with at least one end on ClientName
+	void GetClientConnections(const FString& ClientName, TArray<FAkMJackConnection>& OutConnections) const;
+	int32 GetNumConnections() const { return NumConnections; }
+
+	// Drops operations of Transaction that would not change the graph (existing connects, missing disconnects, duplicates)
+	void Reduce(const FAkMJackRoutingTransaction& Transaction, FAkMJackRoutingTransaction& OutMinimal) const;
+
+	// Adds to OutTransaction the operations turning all connections from SourceClient to DestinationClient into Desired
+	void DiffClientPair(const FString& SourceClient, const FString& DestinationClient, const TArray<FAkMJackConnection>& Desired, FAkMJackRoutingTransaction& OutTransaction) const;
+
+	uint64 GetGeneration() const { return Generation; }
+
+	// Client part of a full port name ("client:port" -> "client")
+	static FString GetClientOfPort(const FString& PortName);
+
+private:
+	TMap<FString, FClient> Clients;
+
+	// Output port -> input ports and input port -> output ports
+	TMultiMap<FString, FString> Downstream;
+	TMultiMap<FString, FString> Upstream;
+	int32 NumConnections = 0;
+
+	uint64 Generation = 0;
+};
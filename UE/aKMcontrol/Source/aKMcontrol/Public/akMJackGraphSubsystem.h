@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "akMJackBackend.h"
+#include "akMJackGraph.h"
+#include "akMJackGraphSubsystem.generated.h"
+
+class UUEJackAudioLinkSubsystem;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogAkMJackGraph, Log, All);
+
+/**
+ * Owns the cached JACK graph and applies routing changes to JACK as minimal batches.
+ * Clients and ports follow the UEJackAudioLink client connect/disconnect events (ports are fetched once per client,
+ * or again when a lookup misses). Connections are tracked from the operations applied here and, when the plugin
+ * forwards JACK's port-connect callback (OnJackPortConnectionChanged), from changes made by other patchbays.
+ * JACK is reached through an IAkMJackBackend, so a standalone instance can run against FAkMMockJackBackend.
+ */
+UCLASS()
+class AKMCONTROL_API UakMJackGraphSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Set up an instance created with NewObject (not the engine subsystem) on top of Backend.
+	// No plugin events are bound: the owner forwards client events to the handlers below. bGraphComplete states that
+	// nothing else patches Backend (a mock in a benchmark), so the graph is trusted and JACK is never probed.
+	void InitializeWithBackend(const TSharedRef<IAkMJackBackend>& InBackend, bool bGraphComplete = false);
+
+	IAkMJackBackend* GetBackend() const { return Backend.Get(); }
+
+	const FAkMJackGraph& GetGraph() const { return Graph; }
+
+	// Cached client, fetched from JACK on first use
+	const FAkMJackGraph::FClient* GetClient(const FString& ClientName);
+
+	// Port counts read from the cache without allocating; returns false if the client is unknown.
+	// A missing client is fetched from JACK at most once per second, so per-frame callers stay cheap.
+	bool GetPortCounts(const FString& ClientName, int32& OutNumInputs, int32& OutNumOutputs);
+
+	// Fetch the ports of ClientName again (e.g. after the Unreal client changed its port count)
+	void RefreshClient(const FString& ClientName);
+
+	// Name of our Unreal JACK client (empty while not connected to JACK)
+	const FString& GetUnrealClientName();
+
+	// Queue a connection between 1-based port indices (as ConnectPortsByIndex); false if either port is unknown
+	bool AddConnectByIndex(FAkMJackRoutingTransaction& Transaction, const FString& SourceClient, int32 OutputIndex1Based, const FString& DestinationClient, int32 InputIndex1Based);
+
+	bool IsConnectedByIndex(const FString& SourceClient, int32 OutputIndex1Based, const FString& DestinationClient, int32 InputIndex1Based);
+
+	// Reduce Transaction against the graph, apply what is left (disconnects first) and record the result.
+	// Returns the number of operations that failed.
+	int32 ApplyRouting(const FAkMJackRoutingTransaction& Transaction);
+
+	// Remove every connection touching ClientName from JACK, including ones never seen here (left by a crashed run,
+	// made in another patchbay): UEJackAudioLink cannot list a port's connections, so every port pair with the other
+	// live clients is tried. Returns the number of connections removed.
+	int32 DisconnectClient(const FString& ClientName);
+
+	// Record the connections JACK really has from SourceClient's outputs to DestinationClient's inputs (made by another
+	// patchbay or a previous session). UEJackAudioLink cannot list them, so each pair is probed with a disconnect that is
+	// undone at once when it succeeds; the first hit per output ends its probe. When the port-connect event is bound a
+	// pair is probed once, later changes arrive through HandlePortConnect. Returns the number of connections found.
+	int32 SyncConnections(const FString& SourceClient, const FString& DestinationClient);
+
+	// Record a connection change made outside this subsystem
+	UFUNCTION()
+	void HandlePortConnect(const FString& SourcePort, const FString& DestinationPort, bool bConnected);
+
+	// Whether connection changes made by other patchbays reach the graph as they happen
+	bool TracksExternalConnections() const { return bPortConnectEventBound || bGraphComplete; }
+
+	// Number of operations sent to JACK since startup, and how long the last ApplyRouting call took
+	int64 GetNumAppliedOperations() const { return NumAppliedOperations; }
+	double GetLastApplySeconds() const { return LastApplySeconds; }
+
+	UFUNCTION()
+	void HandleJackClientConnected(const FString& ClientName, int32 NumInputPorts, int32 NumOutputPorts);
+
+	UFUNCTION()
+	void HandleJackClientDisconnected(const FString& ClientName);
+
+private:
+	UUEJackAudioLinkSubsystem* GetJackSubsystem() const;
+
+	TSharedPtr<IAkMJackBackend> Backend;
+	FAkMJackGraph Graph;
+	FString UnrealClientName;
+	TMap<FString, double> LastMissRefreshTimes;
+	int64 NumAppliedOperations = 0;
+	double LastApplySeconds = 0.0;
+	bool bPortConnectEventBound = false;
+	bool bGraphComplete = false;
+	// Client pairs already probed by SyncConnections (only kept while the port-connect event is bound)
+	TSet<TPair<FString, FString>> SyncedClientPairs;
+};
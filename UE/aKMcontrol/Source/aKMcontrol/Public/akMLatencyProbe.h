@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+#include "akMFFT.h"
+#include <atomic>
+
+// Latency of one tap channel: frames from the start of the probe's marker on the output to its start on the input
+struct FAkMLatencyResult
+{
+	int32 Channel = INDEX_NONE;				// Tap channel (0-based Unreal input)
+	int32 LatencySamples = INDEX_NONE;		// INDEX_NONE when the marker was not found
+	float PeakToNoiseDb = 0.0f;				// Correlation peak over the RMS of the other lags
+};
+
+enum class EAkMLatencyProbeState : uint8
+{
+	Idle,
+	Armed,			// Waiting for the next output block
+	Running,		// Marker playing, inputs being captured
+	Captured,
+	Analyzing		// Correlation running on a task
+};
+
+/**
+ * Round-trip latency measurement through the Unreal JACK client. A maximum length sequence is added to one output
+ * channel and the selected input channels are captured from the same stream frame on; the game thread then
+ * cross-correlates each capture with the sequence (FFT, on a UE::Tasks task) and reports the lag of the peak.
+ * The sequence's processing gain (~42 dB) lets it run well below audibility. Owned by FAkMAudioTap, which feeds it
+ * the block frame counters of both directions.
+ */
+class AKMCONTROL_API FAkMLatencyProbe
+{
+public:
+	static constexpr int32 MlsOrder = 14;
+	static constexpr int32 MlsLength = (1 << MlsOrder) - 1;
+	static constexpr int32 MaxLatencySamples = 16384;
+	static constexpr int32 CaptureLength = MlsLength + MaxLatencySamples;
+	static constexpr int32 MaxInputs = 128;
+	static constexpr float DetectionThresholdDb = 15.0f;
+	// Armed or running longer than this (audio not flowing) cancels the measurement
+	static constexpr double TimeoutSeconds = 3.0;
+
+	FAkMLatencyProbe();
+	~FAkMLatencyProbe();
+
+	// Game thread: play the marker on OutputChannel at LevelDb (dBFS peak) and capture InputChannels; false if busy
+	bool Start(int32 OutputChannel, TConstArrayView<int32> InputChannels, float LevelDb);
+	void Cancel();
+
+	// Game thread: launch the analysis once the capture is complete; true when new results are available
+	bool Tick();
+
+	EAkMLatencyProbeState GetState() const { return State.load(std::memory_order_acquire); }
+	bool IsBusy() const { return GetState() != EAkMLatencyProbeState::Idle; }
+
+	// Game thread: results of the last completed measurement, in Start's channel order
+	const TArray<FAkMLatencyResult>& GetResults() const { return Results; }
+	int32 GetResultSampleRate() const { return ResultSampleRate; }
+
+	// Audio thread; FrameCounter is the stream frame of the block's first sample in each direction
+	void RenderOutput(float* const* OutputData, int32 NumChannels, int32 NumFrames, uint64 FrameCounter, int32 SampleRate);
+	void CapturePlanar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, uint64 FrameCounter);
+	void CaptureInterleaved(const float* Samples, int32 NumChannels, int32 NumFrames, uint64 FrameCounter);
+
+private:
+	// Block frames [OutStart, OutEnd) that fall in the capture, which they enter at OutOffset + frame; false when idle
+	bool BeginCapture(int32 NumFrames, uint64 FrameCounter, int32& OutStart, int32& OutEnd, int64& OutOffset) const;
+	// Hand the capture to the game thread once the block reached its end
+	void EndCapture(int32 NumFrames, int64 Offset);
+
+	void Analyze();
+
+	TArray<float> Mls;							// +-1
+	TUniquePtr<FAkMFFT> FFT;
+	TArray<float> MlsSpectrumReal;
+	TArray<float> MlsSpectrumImag;
+
+	std::atomic<EAkMLatencyProbeState> State { EAkMLatencyProbeState::Idle };
+
+	// Written by the game thread before arming
+	int32 ProbeChannel = 0;
+	int32 CaptureChannels[MaxInputs] = {};
+	int32 NumCaptureChannels = 0;
+	TArray<float> Captures;						// Channel-major, MaxInputs * CaptureLength, allocated on first Start
+	float ProbeGain = 0.0f;
+	double StartTime = 0.0;
+
+	// Audio thread
+	std::atomic<uint64> EmitFrame { 0 };
+	int32 EmitPosition = 0;
+	std::atomic<int32> StreamSampleRate { 0 };
+
+	// Analysis task output, read once the task has completed
+	UE::Tasks::FTask AnalysisTask;
+	TArray<FAkMLatencyResult> PendingResults;
+
+	TArray<FAkMLatencyResult> Results;
+	int32 ResultSampleRate = 0;
+};
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+
+// Level range of one history entry, in 0.5 dB steps from -120 dBFS (0) to +7.5 dBFS (255)
+struct FAkMLevelRange
+{
+	uint8 Min = 0;		// Lowest block RMS, so dropouts show
+	uint8 Max = 0;		// Highest sample peak, so clips show
+
+	static constexpr float FloorDb = -120.0f;
+
+	static uint8 Encode(float Linear)
+	{
+		return Linear > 0.0f ? uint8(FMath::Clamp(FMath::RoundToInt((20.0f * FMath::LogX(10.0f, Linear) - FloorDb) * 2.0f), 0, 255)) : 0;
+	}
+	static float DecodeDb(uint8 Code) { return Code * 0.5f + FloorDb; }
+};
+
+/**
+ * Scroll-back history of every tap channel: a ring at audio-block resolution plus min/max decimation levels, each
+ * four times coarser than the one below (x4, x16, ...) and covering the same span. Any time range is drawn by reading
+ * the coarsest level that still has one entry per output point, so a query costs O(points), not O(blocks).
+ *
+ * Memory is 2 bytes per channel per block at the base level, plus a third of that for the pyramid. At 48 kHz with
+ * 256-frame blocks (187.5 blocks/s) one hour is 675,000 blocks: about 1.8 MB per channel per hour (115 MB for 64
+ * channels). The span is shortened to stay under the byte budget given to Configure, and the buffers are allocated
+ * on a task; blocks added before it is done are dropped. Game thread only; blocks arrive from
+ * FAkMAudioTap::ReadHistoryBlock.
+ */
+class AKMCONTROL_API FAkMLevelHistory
+{
+public:
+	// Reallocates (and clears) the history when any argument differs from the current configuration; the span is
+	// cut to fit MaxBytes
+	void Configure(int32 InNumChannels, double InBlockSeconds, double HistorySeconds, SIZE_T MaxBytes);
+
+	void AddBlock(const FAkMLevelRange* Ranges);
+
+	int32 GetNumChannels() const { return NumChannels; }
+	double GetBlockSeconds() const { return BlockSeconds; }
+
+	// Seconds of history held, up to the span
+	double GetDurationSeconds() const;
+
+	// Seconds the history can hold: the configured span, or less if that would exceed the byte budget
+	double GetSpanSeconds() const { return SpanSeconds; }
+
+	// Decimate [StartSeconds, EndSeconds] (relative to the newest block, so <= 0) of Channel to at most NumPoints
+	// points; writes each point's time and dB range and returns how many points had data
+	int32 Query(int32 Channel, double StartSeconds, double EndSeconds, int32 NumPoints, float* OutSeconds, float* OutMinDb, float* OutMaxDb) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FLevel
+	{
+		TArray<FAkMLevelRange> Entries;		// Channel-major, NumChannels * Capacity
+		int32 Capacity = 0;
+		int64 NumEntries = 0;				// Completed entries since Configure
+	};
+
+	static TArray<FLevel> AllocateLevels(int32 NumChannels, int32 BaseCapacity);
+
+	TArray<FLevel> Levels;
+	UE::Tasks::TTask<TArray<FLevel>> PendingLevels;
+	int32 NumChannels = 0;
+	double BlockSeconds = 0.0;
+	double ConfiguredSeconds = 0.0;
+	SIZE_T ConfiguredMaxBytes = 0;
+	double SpanSeconds = 0.0;
+	int64 NumBlocks = 0;
+};
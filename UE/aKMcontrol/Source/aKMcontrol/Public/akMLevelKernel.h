@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Sum of squares, absolute peak and clip count of many channels of one audio block.
+ * The vector path uses UE's 4-wide VectorRegister (SSE on x64, NEON on arm64) and an 8-wide AVX loop for planar
+ * buffers when the build targets AVX (MinCpuArchX64); the scalar path is the reference and handles the tails.
+ * Outputs are per channel and overwritten, not accumulated. A null planar channel reads as silence.
+ */
+struct AKMCONTROL_API FAkMLevelKernel
+{
+	static void AnalyzePlanar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, float ClipThreshold,
+		float* OutSumSquares, float* OutPeaks, uint32* OutClips);
+
+	static void AnalyzeInterleaved(const float* Samples, int32 NumChannels, int32 NumFrames, float ClipThreshold,
+		float* OutSumSquares, float* OutPeaks, uint32* OutClips);
+
+	static void AnalyzePlanarScalar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, float ClipThreshold,
+		float* OutSumSquares, float* OutPeaks, uint32* OutClips);
+
+	static void AnalyzeInterleavedScalar(const float* Samples, int32 NumChannels, int32 NumFrames, float ClipThreshold,
+		float* OutSumSquares, float* OutPeaks, uint32* OutClips);
+
+	// Instruction set of the vector path in this build ("AVX", "SSE", "NEON" or "scalar")
+	static const TCHAR* GetVectorPathName();
+};
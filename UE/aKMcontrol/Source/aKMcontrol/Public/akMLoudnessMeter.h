@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "akMTripleBuffer.h"
+#include <atomic>
+
+// Loudness of one channel group, in LUFS (MinLufs when below the absolute gate or not measured yet)
+struct FAkMLoudness
+{
+	static constexpr float MinLufs = -70.0f;
+
+	float MomentaryLufs = MinLufs;		// 400 ms window
+	float ShortTermLufs = MinLufs;		// 3 s window
+	float IntegratedLufs = MinLufs;		// Gated, since the last reset
+};
+
+// Channel grouping, written by the game thread
+struct FAkMLoudnessLayout
+{
+	TArray<int32> GroupOfChannel;		// Per tap channel: group index or INDEX_NONE
+	TArray<bool> GroupInMaster;			// Per group: counts towards the master (false for LFE/subs, as BS.1770)
+	int32 NumGroups = 0;
+	uint32 Version = 0;
+};
+
+/**
+ * ITU-R BS.1770-4 loudness of channel groups (speaker columns) and of their sum (master), run on the audio thread.
+ * Each channel goes through the K-weighting pre-filter (two biquads); mean squares are gathered per 100 ms step.
+ * Momentary and short-term loudness come from the last 4 and 30 steps. Integrated loudness keeps one histogram of
+ * 400 ms block loudness per group (0.1 LU bins, count and energy per bin), so the -70 LUFS absolute and -10 LU
+ * relative gates cost O(bins) per step instead of keeping every block. Channel weights are 1 (no surround weighting).
+ */
+class AKMCONTROL_API FAkMLoudnessMeter
+{
+public:
+	static constexpr int32 MaxChannels = 512;
+	static constexpr int32 MaxGroups = 128;
+
+	FAkMLoudnessMeter();
+
+	// Game thread: group tap channels; channels not listed are not filtered. Resets all measurements.
+	void SetLayout(const TArray<TArray<int32>>& ChannelsByGroup, const TArray<bool>& GroupInMaster);
+
+	// Any thread: restart integrated loudness from the next block
+	void ResetIntegrated() { bResetRequested.store(true, std::memory_order_relaxed); }
+
+	// Audio thread: feed one block. Channel c is at ChannelData[c] (planar) or Interleaved[Frame * NumChannels + c].
+	void ProcessPlanar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, int32 SampleRate);
+	void ProcessInterleaved(const float* Samples, int32 NumChannels, int32 NumFrames, int32 SampleRate);
+
+	// Audio thread: current results; OutGroups must hold MaxGroups entries
+	int32 GetResults(FAkMLoudness* OutGroups, FAkMLoudness& OutMaster) const;
+
+private:
+	static constexpr int32 StepsPerMomentary = 4;
+	static constexpr int32 StepsPerShortTerm = 30;
+	static constexpr int32 NumHistogramBins = 800;	// -70 .. +10 LUFS
+
+	struct FBiquad
+	{
+		double B0 = 1.0, B1 = 0.0, B2 = 0.0, A1 = 0.0, A2 = 0.0;
+	};
+
+	struct FChannelState
+	{
+		double Z[4] = {};		// Two transposed direct form II stages
+		double SumSquares = 0.0;
+	};
+
+	struct FGroupState
+	{
+		double StepEnergy[StepsPerShortTerm] = {};	// Ring of per-step mean squares (summed over channels)
+		int32 NumSteps = 0;
+		TArray<uint32> BinCounts;
+		TArray<double> BinEnergy;
+		FAkMLoudness Loudness;
+
+		void Reset(bool bIntegratedOnly);
+		void CloseStep(double Energy);
+	};
+
+	template<typename SampleAccessorType>
+	void Process(int32 NumChannels, int32 NumFrames, int32 SampleRate, SampleAccessorType&& GetChannel);
+
+	void UpdateFilters(int32 SampleRate);
+	void CloseStep();
+
+	// Game thread -> audio thread; the audio thread works on Layouts.Read() in place
+	TAkMTripleBuffer<FAkMLoudnessLayout> Layouts;
+	std::atomic<bool> bResetRequested { false };
+	uint32 NextLayoutVersion = 1;
+
+	// Audio-thread state
+	FBiquad Shelf;
+	FBiquad HighPass;
+	int32 FilterSampleRate = 0;
+	int32 StepFrames = 0;
+	int32 StepPosition = 0;
+	TArray<FChannelState> Channels;
+	TArray<FGroupState> Groups;
+	FGroupState Master;
+	TArray<double> GroupStepEnergy;
+};
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EAkMMeterBallistics : uint8
+{
+	VU,				// IEC 60268-17: RMS, 300 ms to 99 % both ways
+	PPMTypeI,		// IEC 60268-10 Type I (DIN): 5 ms integration, 20 dB return in 1.5 s
+	PPMTypeII,		// IEC 60268-10 Type II (BBC/EBU): 10 ms integration, 24 dB return in 2.8 s
+	DigitalPeak,	// IEC 60268-18 sample peak: instant attack, 20 dB return in 1.7 s
+	Num
+};
+
+// Ballistic state of one meter channel (linear amplitude)
+struct FAkMMeterState
+{
+	float Level = 0.0f;
+	float HoldPeak = 0.0f;
+	float HoldSecondsLeft = 0.0f;
+};
+
+/**
+ * Meter ballistics defined in real time. Step advances a channel by an interval of audio, so the result depends on
+ * how much audio passed and not on how often it is called (once per JACK block on the audio thread).
+ */
+struct AKMCONTROL_API FAkMMeterBallistics
+{
+	bool bPeakDetector = false;			// Rectified sample peak instead of RMS
+	float IntegrationSeconds = 0.0f;	// Attack time constant; 0 = instant
+	float ReleaseDbPerSecond = 0.0f;	// Fall rate of the level; 0 = same time constant as the attack (VU)
+	float PeakHoldSeconds = 1.5f;
+	float PeakReleaseDbPerSecond = 20.0f;
+
+	static FAkMMeterBallistics FromPreset(EAkMMeterBallistics Preset);
+	static const TCHAR* GetPresetName(EAkMMeterBallistics Preset);
+
+	// Per-interval factors; computed once per block size rather than per channel
+	struct FStepCoefficients
+	{
+		float Seconds = 0.0f;
+		float Smoothing = 0.0f;
+		float ReleaseGain = 1.0f;
+		float PeakReleaseGain = 1.0f;
+	};
+	FStepCoefficients GetStepCoefficients(float Seconds) const;
+
+	// Advance State by an interval of audio whose RMS and sample peak were Rms and Peak
+	void Step(FAkMMeterState& State, float Rms, float Peak, const FStepCoefficients& Coefficients) const;
+};
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "imgui.h"
+
+/**
+ * Bank of level meters laid out in groups (one table column each). The layout, UTF-8 headers and labels are built
+ * once per routing change; per frame, levels go through a lookup table to pixel heights and all meters of the bank
+ * are emitted as a single pre-sized vertex batch instead of several draw calls per meter.
+ */
+class AKMCONTROL_API FAkMMeterBank
+{
+public:
+	static constexpr float MeterWidth = 10.0f;
+	static constexpr float MeterSpacing = 8.0f;
+	static constexpr float GroupPadding = 4.0f;
+	static constexpr float MinDb = -60.0f;
+	static constexpr float MaxDb = 6.0f;
+
+	// Layout: valid while the routing generation and the number of routed inputs are unchanged
+	bool IsLayoutValid(uint64 Generation, int32 NumInputs) const { return bHasLayout && Generation == LayoutGeneration && NumInputs == LayoutNumInputs; }
+	void ResetLayout(uint64 Generation, int32 NumInputs);
+	// Inputs are 1-based Unreal inputs; Labels are printed under the meters
+	void AddGroup(const FString& Header, TConstArrayView<int32> Inputs1Based, TConstArrayView<int32> Labels);
+
+	int32 GetNumGroups() const { return Groups.Num(); }
+	const char* GetHeader(int32 Group) const { return Groups[Group].Header.GetData(); }
+	const char* GetColumnId(int32 Group) const { return Groups[Group].ColumnId.GetData(); }
+	float GetGroupWidth(int32 Group) const { return Groups[Group].Width; }
+
+	// Per frame, inside the table: reserve a group's cell in the meters row, then draw every meter in one batch
+	void MeterCell(int32 Group, float MeterHeight);
+	void DrawMeters(ImDrawList* DrawList, const TArray<float>& Levels, const TArray<float>& Peaks, float MeterHeight);
+
+	// Per frame, inside the table: cached input labels of a group, aligned under its meters
+	void LabelCell(int32 Group) const;
+
+	// Level (linear amplitude) to the filled fraction of a meter, through the lookup table
+	static float LevelToFraction(float Linear);
+
+private:
+	struct FGroup
+	{
+		TArray<ANSICHAR> Header;
+		TArray<ANSICHAR> ColumnId;
+		TArray<int32> Channels;					// 0-based tap channels
+		TArray<TArray<ANSICHAR>> Labels;
+		float Width = 0.0f;
+	};
+
+	TArray<FGroup> Groups;
+	bool bHasLayout = false;
+	uint64 LayoutGeneration = 0;
+	int32 LayoutNumInputs = 0;
+
+	// Per frame: top-left corner of each group's meters, written by MeterCell, and filled heights in pixels
+	TArray<ImVec2> CellPositions;
+	TArray<float> LevelHeights;
+	TArray<float> PeakHeights;
+};
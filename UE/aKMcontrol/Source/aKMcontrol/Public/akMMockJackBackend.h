@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "akMJackBackend.h"
+#include "akMJackGraph.h"
+
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FAkMMockJackClientConnected, const FString& /*ClientName*/, int32 /*NumInputPorts*/, int32 /*NumOutputPorts*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FAkMMockJackClientDisconnected, const FString& /*ClientName*/);
+
+/**
+ * In-process stand-in for a JACK server: clients with "client:in_N"/"client:out_N" ports and the connections
+ * between them, with JACK's failure rules (unknown ports, wrong direction, duplicate or missing connections).
+ * Every call can be delayed by a simulated round trip, and calls are counted for benchmarks. Game-thread only.
+ */
+class AKMCONTROL_API FAkMMockJackBackend : public IAkMJackBackend
+{
+public:
+	explicit FAkMMockJackBackend(const FString& InOwnClientName = TEXT("akM-mock"));
+
+	// Register/unregister a client and broadcast the matching event
+	void AddClient(const FString& ClientName, int32 NumInputPorts, int32 NumOutputPorts);
+	void RemoveClient(const FString& ClientName);
+
+	bool IsConnected(const FString& SourcePort, const FString& DestinationPort) const { return Connections.Contains(FAkMJackConnection(SourcePort, DestinationPort)); }
+	int32 GetNumConnections() const { return Connections.Num(); }
+
+	// IAkMJackBackend
+	virtual FString GetJackClientName() const override { return OwnClientName; }
+	virtual TArray<FString> GetConnectedClients() const override;
+	virtual void GetClientPorts(const FString& ClientName, TArray<FString>& OutInputPorts, TArray<FString>& OutOutputPorts) const override;
+	virtual bool GetPortConnections(const FString& Port, TArray<FString>& OutConnectedPorts) const override;
+	virtual bool ConnectPorts(const FString& SourcePort, const FString& DestinationPort) override;
+	virtual bool DisconnectPorts(const FString& SourcePort, const FString& DestinationPort) override;
+
+	FAkMMockJackClientConnected OnClientConnected;
+	FAkMMockJackClientDisconnected OnClientDisconnected;
+
+	// Busy-wait added to every call, to model the JACK server round trip
+	float SimulatedCallLatencyUs = 0.0f;
+
+	// Call counters
+	mutable int64 NumPortQueries = 0;
+	mutable int64 NumConnectionQueries = 0;
+	int64 NumConnectCalls = 0;
+	int64 NumDisconnectCalls = 0;
+	void ResetCounters() { NumPortQueries = 0; NumConnectionQueries = 0; NumConnectCalls = 0; NumDisconnectCalls = 0; }
+
+private:
+	struct FMockClient
+	{
+		TArray<FString> InputPorts;
+		TArray<FString> OutputPorts;
+	};
+
+	void SimulateLatency() const;
+
+	FString OwnClientName;
+	TMap<FString, FMockClient> Clients;
+	TArray<FString> ClientOrder;
+	TSet<FString> InputPortNames;
+	TSet<FString> OutputPortNames;
+	TSet<FAkMJackConnection> Connections;
+};
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "akMPatchbay.generated.h"
+
+// Routing of one JACK client, matched by name
+USTRUCT(BlueprintType)
+struct AKMCONTROL_API FAkMPatchbayRule
+{
+	GENERATED_BODY()
+
+	// Client name, '*' and '?' wildcards allowed (case-insensitive)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Patchbay")
+	FString ClientPattern;
+
+	// scsynth input (1-based) fed by client output N; empty means output N feeds input N
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Patchbay")
+	TArray<int32> ScsynthInputs;
+
+	// Unreal input (1-based) fed by client output N; empty or missing entries are allocated
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Patchbay")
+	TArray<int32> UnrealInputs;
+
+	// Number of client outputs to wire (0 = all)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Patchbay")
+	int32 MaxChannels = 0;
+
+	bool Matches(const FString& ClientName) const { return ClientName.MatchesWildcard(ClientPattern, ESearchCase::IgnoreCase); }
+};
+
+USTRUCT(BlueprintType)
+struct AKMCONTROL_API FAkMPatchbayProfile
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Patchbay")
+	FString Name;
+
+	// First matching rule wins
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Patchbay")
+	TArray<FAkMPatchbayRule> Rules;
+
+	const FAkMPatchbayRule* FindRule(const FString& ClientName) const;
+};
+
+/** Set of patchbay profiles stored as JSON (Saved/akM/PatchbayProfiles.json), one of them active. */
+USTRUCT()
+struct AKMCONTROL_API FAkMPatchbayProfiles
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString ActiveProfile;
+
+	UPROPERTY()
+	TArray<FAkMPatchbayProfile> Profiles;
+
+	static FString GetDefaultFilePath();
+
+	bool LoadFromFile(const FString& FilePath);
+	bool SaveToFile(const FString& FilePath) const;
+
+	FAkMPatchbayProfile* FindProfile(const FString& ProfileName);
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/BitArray.h"
+
+enum class EAkMPortAllocation : uint8
+{
+	Any,				// Lowest free ports
+	PreferContiguous,	// One contiguous range if available, otherwise lowest free ports
+	Contiguous			// One contiguous range or nothing
+};
+
+/**
+ * Allocator of 1-based port indices (e.g. the Unreal JACK client inputs) backed by a bitset, with ports grouped per
+ * owner. Single ports are found from a lowest-free hint, ranges by skipping whole runs of used ports, and freeing an
+ * owner releases all its ports at once. Owners that are no longer alive can be detected and reclaimed. Game-thread only.
+ */
+class AKMCONTROL_API FAkMPortAllocator
+{
+public:
+	// Resize the index space; allocations above the new size are dropped from their owners
+	void SetNumPorts(int32 InNumPorts);
+	void Reset();
+
+	int32 GetNumPorts() const { return Used.Num(); }
+	int32 GetNumFree() const { return Used.Num() - NumUsed; }
+	bool IsAllocated(int32 Index1Based) const { return Used.IsValidIndex(Index1Based - 1) && Used[Index1Based - 1]; }
+
+	// Allocate Count ports for Owner and append their indices to OutIndices; nothing is allocated on failure
+	bool Allocate(const FString& Owner, int32 Count, TArray<int32>& OutIndices, EAkMPortAllocation Policy = EAkMPortAllocation::PreferContiguous);
+
+	// Give Owner a specific port (e.g. one it is already connected to); true if free or already owned by Owner
+	bool Claim(const FString& Owner, int32 Index1Based);
+
+	void Free(const FString& Owner, int32 Index1Based);
+
+	// Release every port of Owner; returns how many were released
+	int32 FreeOwner(const FString& Owner);
+
+	// Ports of Owner in allocation order, or nullptr
+	const TArray<int32>* GetOwnerPorts(const FString& Owner) const { return Owners.Find(Owner); }
+	const TMap<FString, TArray<int32>>& GetOwners() const { return Owners; }
+
+	// Free indices in ascending order
+	void GetFreeIndices(TArray<int32>& OutIndices) const;
+
+	// Release the ports of owners for which IsOwnerAlive returns false; returns the number of ports reclaimed
+	int32 ReclaimLeaks(TFunctionRef<bool(const FString&)> IsOwnerAlive, TArray<FString>* OutLeakedOwners = nullptr);
+
+private:
+	// Start of the first free run of at least Count ports at or after StartBit, or INDEX_NONE
+	int32 FindFreeRange(int32 Count, int32 StartBit) const;
+	void SetUsed(int32 Bit, bool bInUsed);
+
+	TBitArray<> Used;
+	int32 NumUsed = 0;
+
+	// No port below this bit is free
+	int32 FirstFreeHint = 0;
+
+	TMap<FString, TArray<int32>> Owners;
+};
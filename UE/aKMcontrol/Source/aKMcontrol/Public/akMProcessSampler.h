@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "akMRingHistory.h"
+
+// One resource sample of a process. Negative values mean "not available on this platform".
+struct FAkMProcessSample
+{
+	double Time = 0.0;				// FPlatformTime::Seconds()
+	float CpuPercent = 0.0f;		// Percent of one core over the last interval
+	float ResidentMB = 0.0f;
+	float NumThreads = 0.0f;
+	float ContextSwitchesPerSec = -1.0f;
+};
+
+/**
+ * Background sampler of sclang and its scsynth child: CPU time, resident memory, thread count and context
+ * switches, read once per interval from /proc on Linux, proc_pidinfo on Mac and the Win32 process API on Windows.
+ * The sclang PID is set by the owner; scsynth is found as the child process of sclang. Thread-safe snapshots.
+ */
+class AKMCONTROL_API FAkMProcessSampler : public FRunnable
+{
+public:
+	enum class ETarget : uint8
+	{
+		Sclang = 0,
+		Scsynth,
+		Num
+	};
+
+	explicit FAkMProcessSampler(float InIntervalSeconds = 1.0f, int32 InHistoryCapacity = 3600);
+	virtual ~FAkMProcessSampler() override;
+
+	void Start();
+	void StopAndWait();
+
+	// PID of the sclang process to follow (0 to stop sampling)
+	void SetSclangProcessId(uint32 InProcessId);
+
+	// Copies the history of Target (oldest first) and returns its current PID (0 when not found)
+	uint32 GetSnapshot(ETarget Target, TArray<FAkMProcessSample>& OutSamples) const;
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	// Raw cumulative counters read from the OS
+	struct FRawCounters
+	{
+		double CpuSeconds = 0.0;
+		double ResidentMB = 0.0;
+		int32 NumThreads = 0;
+		int64 ContextSwitches = -1;
+	};
+
+	struct FTargetState
+	{
+		uint32 ProcessId = 0;
+		bool bHasPrevious = false;
+		double PreviousTime = 0.0;
+		FRawCounters Previous;
+		TAkMRingHistory<FAkMProcessSample> History;
+
+		explicit FTargetState(int32 Capacity) : History(Capacity) {}
+	};
+
+	void SampleTarget(FTargetState& State, double Now);
+	static bool ReadCounters(uint32 ProcessId, FRawCounters& OutCounters);
+	static uint32 FindChildProcess(uint32 ParentProcessId, const TCHAR* ExecutableName);
+
+	float IntervalSeconds;
+	std::atomic<uint32> RequestedSclangProcessId { 0 };
+
+	mutable FCriticalSection Mutex;
+	TArray<FTargetState> Targets;
+
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeEvent = nullptr;
+	FThreadSafeBool bStopRequested = false;
+};
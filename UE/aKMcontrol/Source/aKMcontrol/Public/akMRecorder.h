@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "akMSpscRing.h"
+#include <atomic>
+
+class IFileHandle;
+
+/**
+ * Multichannel recorder of tap channels to a 32-bit float RF64 file. The audio thread interleaves the selected
+ * channels into a preallocated lock-free ring; a writer thread streams the ring to disk in 4 MB writes with the sample
+ * data starting on a 4 KB boundary. The file is a plain WAVE until it outgrows 4 GB, when the reserved ds64 chunk is
+ * filled in (EBU Tech 3306). If the disk falls behind and the ring fills, the block is dropped on the audio thread
+ * (an xrun) and the writer puts the same number of silent frames in its place, so the file keeps the stream's timing.
+ */
+class AKMCONTROL_API FAkMRecorder : public FRunnable
+{
+public:
+	static constexpr int32 MaxChannels = 512;
+	static constexpr int32 StagingFrames = 512;
+	static constexpr int32 WriteChunkBytes = 4 << 20;
+	static constexpr int32 DataOffset = 4096;
+	FAkMRecorder();
+	virtual ~FAkMRecorder() override;
+
+	// Game thread: record Channels (0-based tap channels) of a stream at SampleRate into FilePath, buffering up to
+	// RingSeconds. Refused without a known rate, so the header never claims 0 Hz even if no block arrives.
+	bool StartRecording(const FString& FilePath, TConstArrayView<int32> Channels, int32 SampleRate, float RingSeconds = 2.0f);
+	// Game thread: stop, drain the ring and finalize the file; blocks until done
+	void StopRecording();
+
+	bool IsRecording() const { return Thread != nullptr; }
+	const FString& GetFilePath() const { return FilePath; }
+	int32 GetNumChannels() const { return NumRecordChannels; }
+	int32 GetSampleRate() const { return StreamSampleRate.load(std::memory_order_relaxed); }
+	int64 GetFramesWritten() const { return FramesWritten.load(std::memory_order_relaxed); }
+	uint64 GetNumXruns() const { return NumXruns.load(std::memory_order_relaxed); }
+	int64 GetDroppedFrames() const { return DroppedFrames.load(std::memory_order_relaxed); }
+	// 0..1, how full the ring is
+	float GetRingFill() const;
+
+	// Audio thread; never blocks or allocates
+	void PushPlanar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, int32 SampleRate);
+	void PushInterleaved(const float* Samples, int32 NumChannels, int32 NumFrames, int32 SampleRate);
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	enum class EState : uint8
+	{
+		Idle,
+		Recording,
+		Stopping,		// Set by the game thread
+		Stopped			// Acknowledged by the audio thread: it no longer touches the ring
+	};
+
+	// Silence the writer inserts at ring position Position (in samples) for frames dropped before it
+	struct FGap
+	{
+		uint64 Position = 0;
+		int32 NumFrames = 0;
+	};
+
+	// Audio thread: true while recording (acknowledges a stop otherwise)
+	bool BeginPush(int32 SampleRate);
+	void WriteFrames(const float* Interleaved, int32 NumFrames);
+
+	// Writer thread
+	bool Drain();
+	void AppendSilence(int64 NumSamples);
+	void Flush();
+	void WriteHeader(uint64 DataBytes);
+
+	FString FilePath;
+	int32 RecordChannels[MaxChannels] = {};
+	int32 NumRecordChannels = 0;
+
+	std::atomic<EState> State { EState::Idle };
+	TUniquePtr<TAkMSpscRing<float>> Ring;
+	TAkMSpscRing<FGap> Gaps { 256 };
+	std::atomic<int32> StreamSampleRate { 0 };
+	std::atomic<int64> FramesWritten { 0 };
+	std::atomic<uint64> NumXruns { 0 };
+	std::atomic<int64> DroppedFrames { 0 };
+
+	// Audio thread
+	TArray<float> Staging;
+	uint64 SamplesPushed = 0;
+	int32 PendingGapFrames = 0;
+
+	// Writer thread
+	IFileHandle* File = nullptr;
+	uint8* WriteBuffer = nullptr;
+	int32 WriteBufferFill = 0;
+	uint64 SamplesConsumed = 0;
+	uint64 DataBytesWritten = 0;
+	TArray<FGap> PendingGaps;
+
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeEvent = nullptr;
+	FThreadSafeBool bStopRequested = false;
+};
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Fixed-capacity history of samples for plotting. Storage never grows past the capacity; once full, the oldest
+ * sample is overwritten. GetData()/GetOffset() follow ImPlot's ring-buffer convention (element i is at (Offset + i) % Num).
+ */
+template<typename SampleType>
+class TAkMRingHistory
+{
+public:
+	explicit TAkMRingHistory(int32 InCapacity)
+		: Capacity(FMath::Max(1, InCapacity))
+	{
+		Samples.Reserve(Capacity);
+	}
+
+	void Add(const SampleType& Sample)
+	{
+		if (Samples.Num() < Capacity)
+		{
+			Samples.Add(Sample);
+		}
+		else
+		{
+			Samples[Head] = Sample;
+			Head = (Head + 1) % Capacity;
+		}
+	}
+
+	void Reset()
+	{
+		Samples.Reset();
+		Head = 0;
+	}
+
+	int32 Num() const { return Samples.Num(); }
+	bool IsEmpty() const { return Samples.Num() == 0; }
+	int32 GetCapacity() const { return Capacity; }
+	int32 GetOffset() const { return Head; }
+	const SampleType* GetData() const { return Samples.GetData(); }
+
+	// Index 0 is the oldest sample
+	const SampleType& operator[](int32 Index) const { return Samples[(Head + Index) % Samples.Num()]; }
+	const SampleType& Last() const { return (*this)[Samples.Num() - 1]; }
+
+private:
+	TArray<SampleType> Samples;
+	int32 Capacity;
+	int32 Head = 0;
+};
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Rolling round-trip-time histogram over the last WindowSize samples. Buckets are log-spaced from MinRttMs to
+ * MaxRttMs so both sub-millisecond and multi-second RTTs stay readable. Game-thread only.
+ */
+class AKMCONTROL_API FAkMRttHistogram
+{
+public:
+	static constexpr int32 NumBuckets = 48;
+	static constexpr float MinRttMs = 0.05f;
+	static constexpr float MaxRttMs = 5000.0f;
+
+	explicit FAkMRttHistogram(int32 InWindowSize = 1024);
+
+	void AddSample(float RttMs);
+	void Reset();
+
+	int32 Num() const { return Window.Num(); }
+	float GetLast() const { return Window.Num() > 0 ? Window[(Head + Window.Num() - 1) % Window.Num()] : 0.0f; }
+	float GetMax() const;
+
+	// Percentile in [0, 1] estimated from bucket counts, interpolated in log space inside the bucket
+	float GetPercentile(float Fraction) const;
+
+	const int32* GetBucketCounts() const { return BucketCounts; }
+
+	// Lower edge of bucket Index in ms (Index == NumBuckets gives the upper edge of the last bucket)
+	static float GetBucketEdgeMs(int32 Index);
+	static int32 GetBucketIndex(float RttMs);
+
+private:
+	TArray<float> Window;
+	int32 WindowSize;
+	int32 Head = 0;
+	int32 BucketCounts[NumBuckets] = {};
+};
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "akMRingHistory.h"
+
+// Kind of a recognized sclang/scsynth output line. Values double as console line tags.
+enum class EAkMServerEventType : uint8
+{
+	None = 0,
+	Boot,
+	Ready,
+	Warning,
+	Error,
+	Status
+};
+
+// Numbers carried by a /status reply
+struct FAkMServerStatus
+{
+	double Time = 0.0;		// FPlatformTime::Seconds() when the reply was seen
+	int32 NumUGens = 0;
+	int32 NumSynths = 0;
+	int32 NumGroups = 0;
+	int32 NumSynthDefs = 0;
+	float AvgCPU = 0.0f;
+	float PeakCPU = 0.0f;
+};
+
+/**
+ * Classifies server console lines. Status replies are recognized both as the raw OSC dump sclang prints
+ * ([ "/status.reply", 1, ugens, synths, groups, synthdefs, avgCPU, peakCPU, ... ]) and as labelled
+ * "UGens: N Synths: N ... avgCPU: X peakCPU: Y" lines.
+ */
+class AKMCONTROL_API FAkMServerOutputParser
+{
+public:
+	static EAkMServerEventType ParseLine(const FString& Line, FAkMServerStatus& OutStatus);
+
+private:
+	static bool ParseStatusReplyDump(const FString& Line, FAkMServerStatus& OutStatus);
+	static bool ParseLabelledStatus(const FString& Line, FAkMServerStatus& OutStatus);
+};
+
+/**
+ * Counters and histories built from parsed server output. Game-thread only.
+ */
+class AKMCONTROL_API FAkMServerOutputStats
+{
+public:
+	FAkMServerOutputStats();
+
+	// Parses Line, updates counters and returns its type. LineNumber is the console line number, used to index errors.
+	EAkMServerEventType Ingest(const FString& Line, uint64 LineNumber);
+	void Reset();
+
+	// Events that do not come from a console line: errors the manager detects itself, /status replies received by OSC
+	void AddError(uint64 LineNumber);
+	void AddStatus(FAkMServerStatus Status);
+
+	int32 NumErrors = 0;
+	int32 NumWarnings = 0;
+	int32 NumStatusReplies = 0;
+	bool bServerReady = false;
+	double ServerReadyTime = 0.0;
+
+	// Latest /status values, valid when NumStatusReplies > 0
+	FAkMServerStatus LastStatus;
+
+	// /status history for plotting
+	TAkMRingHistory<FAkMServerStatus> StatusHistory;
+
+	// Console line numbers of error lines, oldest first
+	TArray<uint64> ErrorLineNumbers;
+	int32 MaxIndexedErrors = 1000;
+};
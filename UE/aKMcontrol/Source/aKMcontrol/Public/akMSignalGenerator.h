@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+enum class EAkMTestSignal : uint8
+{
+	Off,
+	PinkNoise,
+	Sweep,		// Exponential sine sweep followed by silence, repeated
+	Pulse,		// One-sample impulse, repeated
+	Num
+};
+
+// Exponential sine sweep; one period is the sweep followed by GapSeconds of silence
+struct FAkMSweepSettings
+{
+	float StartHz = 20.0f;
+	float EndHz = 20000.0f;
+	float Seconds = 5.0f;
+	float GapSeconds = 1.0f;
+
+	int64 GetSweepFrames(int32 SampleRate) const { return int64(double(Seconds) * SampleRate); }
+	int64 GetPeriodFrames(int32 SampleRate) const { return GetSweepFrames(SampleRate) + int64(double(GapSeconds) * SampleRate); }
+};
+
+/**
+ * Calibration signals (pink noise, exponential sweeps, pulses) rendered on the audio thread into one output channel of
+ * the Unreal JACK client. Moving the signal to another channel, or changing signal, is an equal-power crossfade of
+ * FadeFrames inside the audio callback, so a speaker change is click-free and done within a few milliseconds.
+ * Level changes are ramped over one block. Owned by FAkMAudioTap.
+ */
+class AKMCONTROL_API FAkMSignalGenerator
+{
+public:
+	static constexpr int32 FadeFrames = 128;
+	static constexpr int32 ChunkFrames = 256;
+	static constexpr float PulsePeriodSeconds = 1.0f;
+
+	FAkMSignalGenerator();
+
+	static const TCHAR* GetSignalName(EAkMTestSignal Signal);
+
+	// Any thread; applied from the next audio block. Channel is 0-based, INDEX_NONE = silent.
+	void SetSignal(EAkMTestSignal Signal) { RequestedSignal.store(Signal, std::memory_order_relaxed); }
+	void SetOutputChannel(int32 Channel) { RequestedChannel.store(Channel, std::memory_order_relaxed); }
+	// Peak level of the sweep and pulse, about the peak level of the noise
+	void SetLevelDb(float LevelDb) { RequestedGain.store(FMath::Pow(10.0f, FMath::Min(LevelDb, 0.0f) / 20.0f), std::memory_order_relaxed); }
+	// Taken at the start of the next sweep
+	void SetSweep(const FAkMSweepSettings& Settings);
+
+	EAkMTestSignal GetSignal() const { return RequestedSignal.load(std::memory_order_relaxed); }
+	int32 GetOutputChannel() const { return RequestedChannel.load(std::memory_order_relaxed); }
+	// True until the audio thread has finished crossfading to the requested channel and signal
+	bool IsSwitching() const;
+
+	// Render the sweep of Settings from StartFrame of its period (the gap is silence) at unit amplitude
+	static void RenderSweep(const FAkMSweepSettings& Settings, int32 SampleRate, int64 StartFrame, float* Out, int32 NumFrames);
+
+	// Audio thread: add the signal to the output buffers; never blocks or allocates
+	void Render(float* const* OutputData, int32 NumChannels, int32 NumFrames, int32 SampleRate);
+
+private:
+	// Per-signal state, so the outgoing and incoming signals of a crossfade both keep running
+	struct FPinkState
+	{
+		uint32 Seed = 0x12345678u;
+		float B[7] = {};
+	};
+
+	// Audio thread: NumFrames of Signal at unit level into Out
+	void Generate(EAkMTestSignal Signal, float* Out, int32 NumFrames, int32 SampleRate);
+
+	std::atomic<EAkMTestSignal> RequestedSignal { EAkMTestSignal::Off };
+	std::atomic<int32> RequestedChannel { INDEX_NONE };
+	std::atomic<float> RequestedGain { 0.1f };
+	std::atomic<float> RequestedSweepStartHz;
+	std::atomic<float> RequestedSweepEndHz;
+	std::atomic<float> RequestedSweepSeconds;
+	std::atomic<float> RequestedSweepGapSeconds;
+
+	// Published by the audio thread when a crossfade completes
+	std::atomic<EAkMTestSignal> AppliedSignal { EAkMTestSignal::Off };
+	std::atomic<int32> AppliedChannel { INDEX_NONE };
+
+	// Audio thread
+	EAkMTestSignal CurrentSignal = EAkMTestSignal::Off;
+	int32 CurrentChannel = INDEX_NONE;
+	EAkMTestSignal NextSignal = EAkMTestSignal::Off;
+	int32 NextChannel = INDEX_NONE;
+	int32 FadePosition = INDEX_NONE;		// INDEX_NONE when not fading
+	float Gain = 0.0f;
+	FPinkState Pink;
+	FAkMSweepSettings Sweep;
+	int64 SweepPosition = 0;
+	int64 PulsePosition = 0;
+	float FadeIn[FadeFrames];				// sin(pi/2 * t)
+	float CurrentBuffer[ChunkFrames];
+	float NextBuffer[ChunkFrames];
+};
@@ -4,14 +4,31 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "akMConsoleBuffer.h"
+#include "akMServerOutputParser.h"
+#include "akMRttHistogram.h"
+#include "OSCMessage.h"
+#include "akMProcessSampler.h"
+#include "akMSignalGenerator.h"
+#include "akMJackGraph.h"
+#include "akMLatencyProbe.h"
+#include "akMPortAllocator.h"
+#include "akMPatchbay.h"
 #include "akMSpatServerManager.generated.h"
 
+class UakMJackGraphSubsystem;
+class UOSCClient;
+class UOSCServer;
+
 DECLARE_LOG_CATEGORY_EXTERN(LogSpatServer, Log, All);
 DECLARE_LOG_CATEGORY_EXTERN(LogAkMOSC, Log, All);
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnRequestedOSCSend_Float, FString, OSCAddress, float, Value);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnRequestedOSCSend_Int, FString, OSCAddress, int32, Value);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnRequestedOSCSend_FloatArray, FString, OSCAddress, const TArray<float>&, Value);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnActiveServerChanged, int32, ServerOSCPort);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnServerStateResyncRequested);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnPatchbayRuleNotApplied, FString, ClientName, int32, NumInputs, int32, NumOutputs);
 
 UCLASS()
 class AKMCONTROL_API AakMSpatServerManager : public AActor
@@ -46,9 +63,145 @@ public:
 	bool StartSpatServerProcess();
 	void StopSpatServerProcess();
 
-	// Holds console log lines for ImGui rendering
-	TArray<FString> ImGuiConsoleBuffer;
-	int32 MaxConsoleLines = 500;
+	// HOT STANDBY
+	// When enabled, a second sclang/scsynth instance is booted next to the active one and kept idle (no JACK
+	// connections, no OSC traffic). If the active server is lost, the standby is promoted: JACK routing is moved
+	// over, server state is resent and a new standby is booted in the background.
+	// The standby runs the same script with two extra arguments, "<OSC port> <JACK client name>", which
+	// akM_spatServer.scd reads from thisProcess.argv to avoid clashing with the active instance. The script also
+	// tags its heartbeat replies with that OSC port (see HEARTBEAT RTT). Both live in the akm-server scripts, not here.
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Standby")
+	bool bEnableHotStandby = false;
+
+	// JACK client name of the server currently carrying audio; swapped with StandbyJackClientName on failover
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="akM|Standby")
+	FString ActiveServerJackClientName = TEXT("scsynth");
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Standby")
+	FString StandbyJackClientName = TEXT("scsynth_standby");
+
+	// OSC port of the active server (aKMServer default) and of the standby; swapped on failover
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="akM|Standby")
+	int32 ActiveServerOSCPort = 23446;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Standby")
+	int32 StandbyOSCPort = 23447;
+
+	// Standby process is running / its scsynth has registered on JACK
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="akM|Standby")
+	bool bStandbyRunning = false;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="akM|Standby")
+	bool bStandbyReady = false;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="akM|Standby")
+	int32 FailoverCount = 0;
+
+	// Time from loss detection to JACK rewiring and state resync done, and to the first heartbeat of the promoted server
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="akM|Standby")
+	float LastFailoverSwitchMs = 0.0f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="akM|Standby")
+	float LastFailoverRecoveryMs = 0.0f;
+
+	// JACK operations that failed while rewiring the last promotion (0 = clean switch); a failed promotion leaves the
+	// promoted server's outputs unconnected and is not counted in FailoverCount
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="akM|Standby")
+	int32 LastFailoverRoutingFailures = 0;
+
+	// Broadcast after failover with the promoted server's OSC port; OSC senders retarget on it (the manager's own
+	// client, if used, already points there)
+	UPROPERTY(BlueprintAssignable, Category="akM|Events")
+	FOnActiveServerChanged OnActiveServerChanged;
+
+	// Broadcast when the server needs all runtime state resent (e.g. sources after failover)
+	UPROPERTY(BlueprintAssignable, Category="akM|Events")
+	FOnServerStateResyncRequested OnServerStateResyncRequested;
+
+	// Broadcast when a client matches a patchbay rule but could not be wired by it (ports unknown, no free Unreal
+	// inputs), so it can be offered for manual routing instead
+	UPROPERTY(BlueprintAssignable, Category="akM|Events")
+	FOnPatchbayRuleNotApplied OnPatchbayRuleNotApplied;
+
+	// Whether ClientName is one of our scsynth instances (active or standby)
+	bool IsServerJackClient(const FString& ClientName) const;
+
+	// Resend all general and speaker parameters, then ask listeners to resend theirs
+	UFUNCTION(BlueprintCallable, Category="akM|SpatServer")
+	void ResyncServerState();
+
+	// HEARTBEAT RTT
+	// Every PingIntervalSeconds the manager sends "/akm/ping <seq>" to the server, which answers
+	// "/akm/pong <seq> <its OSC port>" to 127.0.0.1:HeartbeatReplyPort; pongs tagged with another port (a standby) are
+	// ignored. The manager listens there itself and feeds the rolling RTT histogram. Once a first
+	// pong has been seen, StallMissedPings unanswered pings, the oldest older than the stall threshold, mark the server
+	// stalled and not alive.
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Heartbeat")
+	int32 HeartbeatReplyPort = 23448;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Heartbeat")
+	float PingIntervalSeconds = 0.25f;
+
+	// Stall threshold is StallFactor x p99 RTT, clamped to [MinStallMs, MaxStallMs]; never less than
+	// MinStallPingIntervals ping intervals, so one late pong cannot trip it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Heartbeat")
+	float StallFactor = 4.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Heartbeat")
+	float MinStallMs = 100.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Heartbeat", meta=(ClampMin="1.0"))
+	float MinStallPingIntervals = 4.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Heartbeat", meta=(ClampMin="1"))
+	int32 StallMissedPings = 3;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Heartbeat")
+	float MaxStallMs = 2000.0f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="akM|Heartbeat")
+	bool bServerStalled = false;
+
+	UFUNCTION(BlueprintCallable, Category="akM|Heartbeat")
+	void HandleServerPong(int32 Seq);
+
+	// Receive path of HeartbeatReplyPort
+	UFUNCTION()
+	void HandleHeartbeatOSCMessage(const FOSCMessage& Message, const FString& IPAddress, int32 Port);
+
+	float GetStallThresholdMs() const;
+
+	// Age of the oldest unanswered ping in ms (0 when none)
+	float GetOldestPendingPingAgeMs() const;
+
+	FAkMRttHistogram RttHistogram;
+
+	// PROCESS RESOURCES
+	// Background sampling of sclang and its scsynth child (CPU, resident memory, threads, context switches)
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|ServerStatus")
+	float ProcessSampleIntervalSeconds = 1.0f;
+
+	// Number of samples kept per process (one hour at the default interval)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|ServerStatus")
+	int32 ProcessHistoryCapacity = 3600;
+
+	TUniquePtr<FAkMProcessSampler> ProcessSampler;
+
+	// Holds console log lines for ImGui rendering (UTF-8, ring of MaxConsoleLines)
+	FAkMConsoleBuffer ImGuiConsoleBuffer;
+	int32 MaxConsoleLines = 100000;
+
+	// Parsed server output: boot/error/warning counters, /status history and error line index
+	FAkMServerOutputStats ServerOutputStats;
+
+	// Every StatusPollIntervalSeconds (0 = never) "/akm/status" is sent to the server, whose script answers
+	// "/akm/status.reply <ugens> <synths> <groups> <synthdefs> <avgCPU> <peakCPU> <its OSC port>" to HeartbeatReplyPort,
+	// tagged like the pongs. Status lines sclang prints to the console are counted too.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|ServerStatus")
+	float StatusPollIntervalSeconds = 1.0f;
 	
 	// JACK auto-connection state
 	UFUNCTION()
@@ -60,6 +213,13 @@ public:
 	// Returns 1-based indices of Unreal JACK client's input ports that we have not reserved yet
 	TArray<int32> GetAvailableUnrealInputPortIndices() const;
 
+	// Owner of the Unreal JACK client's input ports; scsynth's ports are held under ServerPortOwner so they
+	// survive the client name swap on failover. The two mappings below mirror it for the UI and Blueprints.
+	FAkMPortAllocator UnrealInputAllocator;
+	static constexpr const TCHAR* ServerPortOwner = TEXT("@akM server");
+	// Unreal inputs fed by clients this manager did not route (qjackctl, a previous session); never handed out
+	static constexpr const TCHAR* ExternalPortOwner = TEXT("@external connections");
+
 	// Name of our Unreal JACK client
 	FString UnrealJackClientName;
 
@@ -74,14 +234,126 @@ public:
 	// Map new external clients to Unreal input indices we connected for them (not exposed to UHT)
 	TMap<FString, TArray<int32>> ConnectedUnrealInputIndicesByClient;
 
+	// Unreal input (1-based, INDEX_NONE if none) carrying each source's client channel, indexed by source ID - 1
+	void GetUnrealInputsBySource(TArray<int32>& OutInputs, int32 NumSources) const;
+
 	// Accept a newly detected external JACK client and wire it to scsynth and Unreal
 	UFUNCTION(BlueprintCallable, Category="akM|SpatServer")
 	void AcceptExternalClient(const FString& ClientName, int32 NumInputPorts, int32 NumOutputPorts);
 
+	// Disconnect all connections to/from our Unreal JACK client
+	void DisconnectAllConnectionsToUnreal();
+
+	// Graph used instead of the engine subsystem, e.g. one running on FAkMMockJackBackend (akM.Jack.BenchmarkRouting).
+	// Set before BeginPlay. Such a manager only routes: it binds no UEJackAudioLink events, opens no OSC sockets, runs no
+	// process sampler, does not tick and leaves the audio tap (probe, file player, generator, sweep) alone.
+	UPROPERTY(Transient)
+	UakMJackGraphSubsystem* JackGraphOverride = nullptr;
+
+	// PATCHBAY
+	// Routing profiles (client-name patterns -> scsynth inputs / Unreal inputs) stored in Saved/akM/PatchbayProfiles.json.
+	// Clients matching the active profile are wired without a prompt: those present when scsynth is connected in one
+	// transaction, later ones as they appear.
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Patchbay")
+	bool bEnablePatchbay = true;
+
+	// Profile to use; empty uses the file's ActiveProfile
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Patchbay")
+	FString PatchbayProfileName;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="akM|Patchbay")
+	FAkMPatchbayProfile ActivePatchbayProfile;
+
+	UFUNCTION(BlueprintCallable, Category="akM|Patchbay")
+	void LoadPatchbayProfiles();
+
+	// Store the current client routing as ProfileName (exact client names) and make it active
+	UFUNCTION(BlueprintCallable, Category="akM|Patchbay")
+	bool SavePatchbayProfileFromCurrentRouting(const FString& ProfileName);
+
+	// Rule of the active profile for ClientName, or nullptr (never for the servers, system or Unreal clients)
+	const FAkMPatchbayRule* FindPatchbayRule(const FString& ClientName) const;
+
+	// LATENCY
+	// Round trip Unreal output -> scsynth input -> speaker feeds -> Unreal inputs, measured with FAkMLatencyProbe.
+	// The probe output is wired to the scsynth input only while a measurement runs.
+
+	// Unreal JACK output (1-based) carrying the probe, and the scsynth input (1-based) it is connected to
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Latency")
+	int32 LatencyProbeUnrealOutput = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Latency")
+	int32 LatencyProbeServerInput = 1;
+
+	// Peak level of the probe sequence; the correlation finds it about 40 dB below the programme
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Latency")
+	float LatencyProbeLevelDb = -60.0f;
+
+	// Measure in the background every LatencyProbeIntervalSeconds while the server is connected
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Latency")
+	bool bEnablePeriodicLatencyProbe = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Latency")
+	float LatencyProbeIntervalSeconds = 60.0f;
+
+	// A speaker feed whose latency moves further than this from the first measurement raises a drift alarm
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Latency")
+	int32 LatencyDriftToleranceSamples = 2;
+
+	UFUNCTION(BlueprintCallable, Category="akM|Latency")
+	bool StartLatencyMeasurement();
+
+	// Forget the drift baseline; the next measurement becomes the new one
+	UFUNCTION(BlueprintCallable, Category="akM|Latency")
+	void ResetLatencyBaseline();
+
+	bool IsLatencyMeasurementRunning() const;
+
+	// Latest measurement (one result per speaker feed, in ConnectedUnrealInputIndicesFromScsynth order) and baseline
+	TArray<FAkMLatencyResult> LatencyResults;
+	TArray<int32> LatencyBaselineSamples;
+	int32 LatencySampleRate = 0;
+	double LastLatencyMeasurementTime = -1.0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="akM|Latency")
+	bool bLatencyDrift = false;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="akM|Latency")
+	int32 LatencyDriftAlarmCount = 0;
+
+	// First Unreal JACK output (1-based) of the file player; file channel N plays on this output + N. The defaults of
+	// the latency probe (1), the calibration generator (2, 3) and the file player (4 and up) do not overlap.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|FilePlayer")
+	int32 FilePlayerFirstUnrealOutput = 4;
+
+	// Play a WAVE/RF64 file from the Unreal client into scsynth: file channel N feeds source SourceIds[N] (the scsynth
+	// input of that number; < 1 leaves the channel out)
+	UFUNCTION(BlueprintCallable, Category="akM|FilePlayer")
+	bool StartFilePlayback(const FString& FilePath, const TArray<int32>& SourceIds, bool bLoop);
+
+	UFUNCTION(BlueprintCallable, Category="akM|FilePlayer")
+	void StopFilePlayback();
+
+	bool IsFilePlaying() const;
+
+	// Sources of the file being played, in file channel order
+	TArray<int32> FilePlayerSourceIds;
+
 	UFUNCTION(BlueprintCallable, Category="akM|SpatServer")
 	void PrintToInternalLogs_OSC(FString message);
 	
-	// Events to send OSC
+	// OSC destination of the active server: ServerOSCAddress:ActiveServerOSCPort, followed across failover
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|OSC")
+	FString ServerOSCAddress = TEXT("127.0.0.1");
+
+	// Send through the manager's own OSC client instead of broadcasting OnRequestedOSCSend_*. Off by default: the
+	// Blueprint sender (BP_OSCInterface) bound to those events does the sending and retargets on OnActiveServerChanged.
+	// When on, the events are not broadcast and the Blueprint sender stays idle.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|OSC")
+	bool bSendOSCFromManager = false;
+
+	// Events to send OSC (only broadcast when the manager does not send itself)
 	UPROPERTY(BlueprintAssignable, Category="akM|Events")
 	FOnRequestedOSCSend_Float OnRequestedOSCSend_Float;
 
@@ -126,10 +398,65 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|SpeakersParameters")
 	TArray<float> subsGains = { 3.0f, 3.0f };
+
+	// Calibration generator: JACK input port of each speaker (12 satellites, then 2 subs). The generator alternates
+	// between two Unreal outputs so the next speaker is wired while the current one is still playing. Neither may be an
+	// output the latency probe or the file player is using at the time.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Calibration")
+	TArray<FString> CalibrationSpeakerPorts = {
+		TEXT("system:playback_1"), TEXT("system:playback_2"), TEXT("system:playback_3"), TEXT("system:playback_4"),
+		TEXT("system:playback_5"), TEXT("system:playback_6"), TEXT("system:playback_7"), TEXT("system:playback_8"),
+		TEXT("system:playback_9"), TEXT("system:playback_10"), TEXT("system:playback_11"), TEXT("system:playback_12"),
+		TEXT("system:playback_13"), TEXT("system:playback_14") };
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Calibration")
+	int32 CalibrationUnrealOutputA = 2;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Calibration")
+	int32 CalibrationUnrealOutputB = 3;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Calibration")
+	float CalibrationLevelDb = -20.0f;
+
+	// Signal and speaker (index into CalibrationSpeakerPorts, INDEX_NONE = none), applied on the next tick
+	EAkMTestSignal CalibrationSignal = EAkMTestSignal::Off;
+	int32 CalibrationSpeaker = INDEX_NONE;
+	FAkMSweepSettings CalibrationSweep;
+
+	// Speaker the generator is currently wired to
+	int32 GetWiredCalibrationSpeaker() const { return WiredCalibrationSpeaker; }
+
+	// Delay added to each speaker feed by scsynth, set by the speaker alignment
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|SpeakersParameters")
+	TArray<float> satsDelaysMs = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|SpeakersParameters")
+	TArray<float> subsDelaysMs = { 0.0f, 0.0f };
+
+	// Measurement microphone (a JACK output port), connected to a free Unreal input while the alignment runs
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="akM|Calibration")
+	FString CalibrationMicPort = TEXT("system:capture_1");
+
+	// Sweep every speaker in turn through output A, then set satsDelaysMs/subsDelaysMs so all arrivals line up with
+	// the latest and satsGains/subsGains so each group matches its quietest speaker
+	UFUNCTION(BlueprintCallable, Category="akM|Calibration")
+	bool StartSpeakerAlignment();
+
+	UFUNCTION(BlueprintCallable, Category="akM|Calibration")
+	void CancelSpeakerAlignment();
+
+	bool IsSpeakerAlignmentRunning() const { return AlignmentSpeaker != INDEX_NONE || bAlignmentAnalyzing; }
+	// Speaker being measured, INDEX_NONE while analyzing or idle
+	int32 GetAlignmentSpeaker() const { return AlignmentSpeaker; }
+
+	// Last alignment, one entry per CalibrationSpeakerPorts speaker
+	TArray<FAkMSpeakerMeasurement> AlignmentResults;
+	int32 AlignmentSampleRate = 0;
 	
 private:
 	// Child process handle and pipes for stdout/stderr
 	FProcHandle SpatServerProcessHandle;
+	uint32 SpatServerProcessId = 0;
 	void* ReadPipe;
 	void* WritePipe;
 
@@ -140,13 +467,137 @@ private:
 	// Runtime state
 	bool bIsServerRunning;
 
-	// Helpers
-	void PumpSpatServerOutput();
-	bool ValidateRequiredPaths() const;
+	// Standby child process and pipes
+	FProcHandle StandbyProcessHandle;
+	uint32 StandbyProcessId = 0;
+	void* StandbyReadPipe = nullptr;
+	void* StandbyWritePipe = nullptr;
 
-	// Disconnect all connections to/from our Unreal JACK client
-	void DisconnectAllConnectionsToUnreal();
+	// Failover bookkeeping
+	bool bWasServerAlive = false;
+	bool bAwaitingPromotedHeartbeat = false;
+	double FailoverStartTime = 0.0;
+
+	// Ping bookkeeping: send time of ping Seq is kept in slot Seq % MaxPendingPings
+	static constexpr int32 MaxPendingPings = 64;
+	uint64 PingSendCycles[MaxPendingPings] = {};
+	int32 NextPingSeq = 1;
+	int32 LastPongSeq = 0;
+	double LastPingTime = 0.0;
+	bool bPongSeen = false;
+	double LastHeartbeatTickTime = 0.0;
 
+	UPROPERTY(Transient)
+	UOSCServer* HeartbeatOSCServer = nullptr;
 
+	UPROPERTY(Transient)
+	UOSCClient* ServerOSCClient = nullptr;
 
+	// Point the OSC client at the new active server and notify listeners
+	void HandleActiveServerChanged();
+
+	// A standby that failed to launch is retried after a while rather than given up on
+	static constexpr double StandbyRetrySeconds = 10.0;
+	double StandbyRetryTime = 0.0;
+
+	double LastStatusPollTime = 0.0;
+
+	// Helpers
+	void TickHeartbeat();
+	void TickStatusPoll();
+	void ResetHeartbeat();
+	void PumpSpatServerOutput();
+	void PumpStandbyOutput();
+	bool ValidateRequiredPaths() const;
+	FProcHandle LaunchSclang(const FString& Args, void*& OutReadPipe, void*& OutWritePipe, uint32& OutProcessId) const;
+	bool StartStandbyProcess();
+	void StopStandbyProcess();
+
+	// Promote the standby to active server; returns false if no standby was ready
+	bool TryFailoverToStandby(const TCHAR* Reason);
+
+	// Disconnect default scsynth <-> system connections made by scsynth at boot
+	void DisconnectServerFromSystem(const FString& ServerClientName) const;
+
+	// Cached JACK graph all routing changes go through (JackGraphOverride if set)
+	UakMJackGraphSubsystem* GetJackGraph() const;
+
+	// Routing of one external client, planned against the graph before the transaction is applied
+	struct FClientRoutingPlan
+	{
+		FString ClientName;
+		TArray<int32> ScsynthInputByChannel;	// 1-based scsynth input of client output N+1
+		TArray<int32> UnrealIndexByChannel;		// 1-based Unreal input of client output N+1
+		TArray<int32> PreviousPorts;			// Unreal inputs the client held before
+		int32 NumExisting = 0;
+	};
+
+	// Reserve Unreal inputs for ClientName (following Rule if given) and queue its connections into Transaction
+	bool PlanExternalClient(const FString& ClientName, int32 NumOutputPorts, const FAkMPatchbayRule* Rule, FAkMJackRoutingTransaction& Transaction, FClientRoutingPlan& OutPlan);
+
+	// After the transaction: record what got connected and release what did not
+	void CommitExternalClient(const FClientRoutingPlan& Plan);
+
+	// Wire the matching clients in one routing transaction and log their bring-up time
+	void ApplyPatchbay(const TArray<FString>& ClientNames);
+	void ApplyPatchbayToPresentClients();
+
+	// scsynth inputs fed by each accepted client (mirrors ConnectedUnrealInputIndicesByClient), used on failover
+	TMap<FString, TArray<int32>> ScsynthInputsByClient;
+
+	// When each external client appeared on JACK, and when scsynth got wired
+	TMap<FString, double> ClientAppearTimes;
+	double ServerConnectedTime = 0.0;
+
+	// Match the allocator size to the Unreal client's current input count
+	void SyncUnrealInputAllocator();
+
+	// Release ports of owners that have left JACK without a disconnect event reaching us
+	void ReclaimLeakedUnrealInputs();
+
+	// Hand the speaker columns (groups of 3 scsynth outputs, last group = subs) to the loudness meter when they change
+	void SyncLoudnessLayout();
+	TArray<int32> LoudnessLayoutInputs;
+
+	// Features playing into Unreal outputs; each refuses to start on an output another one is using
+	enum class EUnrealOutputUser : uint8 { None, LatencyProbe, FilePlayer, CalibrationGenerator, SpeakerAlignment };
+	EUnrealOutputUser FindUnrealOutputUser(int32 Output1Based, EUnrealOutputUser Ignore) const;
+	static const TCHAR* GetUnrealOutputUserName(EUnrealOutputUser User);
+
+	// Collect probe results, unwire the probe and start periodic measurements
+	void TickLatencyProbe();
+	void DisconnectLatencyProbe();
+	bool bLatencyProbeWired = false;
+	FAkMJackConnection LatencyProbeConnection;
+	double NextPeriodicLatencyProbeTime = 0.0;
+
+	// Stop the file player at the end of the file and unwire it
+	void TickFilePlayer();
+	void DisconnectFilePlayer();
+	// Queue the file player's connections to the active server; false if a port is unknown
+	bool AddFilePlayerRoutes(const TArray<int32>& SourceIds, FAkMJackRoutingTransaction& Transaction, TArray<int32>& OutOutputChannels);
+	// Move a playing file over to the active server after failover
+	void RerouteFilePlayer();
+	TArray<FAkMJackConnection> FilePlayerConnections;
+
+	// Wire the calibration generator's free output to the requested speaker, move the signal over and release the
+	// previous speaker once the crossfade is done
+	void TickCalibration();
+	void ReleaseCalibrationOutput(int32 Output);
+	int32 WiredCalibrationSpeaker = INDEX_NONE;
+	int32 CalibrationActiveOutput = 0;			// 0 = A, 1 = B
+	int32 CalibrationReleaseOutput = INDEX_NONE;
+	FAkMJackConnection CalibrationConnections[2];
+
+	// Speaker alignment: wire and sweep the next speaker once the previous capture is in, then apply the analysis
+	void TickSpeakerAlignment();
+	void MeasureNextAlignmentSpeaker();
+	void ApplySpeakerAlignment();
+	void EndSpeakerAlignment();
+	static constexpr const TCHAR* AlignmentMicOwner = TEXT("@akM calibration mic");
+	int32 AlignmentSpeaker = INDEX_NONE;
+	bool bAlignmentAnalyzing = false;
+	int32 AlignmentMicInput = INDEX_NONE;		// 1-based Unreal input
+	FAkMJackConnection AlignmentMicConnection;
+	FAkMJackConnection AlignmentSpeakerConnection;
 };
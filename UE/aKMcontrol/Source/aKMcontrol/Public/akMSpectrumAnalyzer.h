@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "akMFFT.h"
+#include "akMSpscRing.h"
+#include "akMTripleBuffer.h"
+#include <atomic>
+
+// Spectra of the analyzed channels, decimated to log-spaced bins (peak of the FFT bins each one covers)
+struct FAkMSpectrumFrame
+{
+	TArray<float> FrequenciesHz;		// Bin centres, NumBins
+	TArray<float> MagnitudesDb;			// Slot-major, MaxSlots * NumBins; dBFS of a full-scale sine
+	int32 Channels[4] = { INDEX_NONE, INDEX_NONE, INDEX_NONE, INDEX_NONE };
+	int32 NumBins = 0;
+	int32 FFTSize = 0;
+	int32 SampleRate = 0;
+	float CpuPercent = 0.0f;			// Worker busy time, percent of one core over the last second
+	int64 NumAnalyzed = 0;				// FFT frames computed since start
+	int64 NumSkipped = 0;				// FFT frames dropped to stay within the CPU budget
+	int64 NumOverflows = 0;				// Samples dropped because a ring was full
+};
+
+/**
+ * Spectrum analyzer for up to four tap channels. The audio thread copies the selected channels into lock-free rings;
+ * a worker thread runs Hann-windowed FFTs with 50 % overlap, smooths the power and decimates it to log-frequency bins
+ * for display. The worker spends at most CpuBudgetPercent of one core: frames that do not fit in the budget are
+ * dropped (and counted) rather than queued. Results reach the game thread through a triple buffer.
+ */
+class AKMCONTROL_API FAkMSpectrumAnalyzer : public FRunnable
+{
+public:
+	static constexpr int32 MaxSlots = 4;
+	static constexpr int32 MinFFTSize = 256;
+	static constexpr int32 MaxFFTSize = 8192;
+	static constexpr int32 NumDisplayBins = 256;
+	static constexpr float MinFrequencyHz = 20.0f;
+
+	FAkMSpectrumAnalyzer();
+	virtual ~FAkMSpectrumAnalyzer() override;
+
+	// Game thread
+	void Start();
+	void StopAndWait();
+	bool IsRunning() const { return bRunning.load(std::memory_order_relaxed); }
+
+	// Any thread: tap channel (0-based) analyzed in Slot, INDEX_NONE to turn the slot off
+	void SetChannel(int32 Slot, int32 Channel);
+	int32 GetChannel(int32 Slot) const { return SlotChannels[Slot].load(std::memory_order_relaxed); }
+	void SetFFTSize(int32 InFFTSize) { RequestedFFTSize.store(FMath::Clamp(FAkMFFT::GetSizeFor(InFFTSize), MinFFTSize, MaxFFTSize), std::memory_order_relaxed); }
+	int32 GetFFTSize() const { return RequestedFFTSize.load(std::memory_order_relaxed); }
+	void SetCpuBudgetPercent(float Percent) { CpuBudgetPercent.store(FMath::Clamp(Percent, 0.1f, 100.0f), std::memory_order_relaxed); }
+	float GetCpuBudgetPercent() const { return CpuBudgetPercent.load(std::memory_order_relaxed); }
+
+	// Audio thread: copy the selected channels of one block; never blocks or allocates
+	void PushPlanar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, int32 SampleRate);
+	void PushInterleaved(const float* Samples, int32 NumChannels, int32 NumFrames, int32 SampleRate);
+
+	// Game thread: take the newest spectra, if any
+	bool ReadSpectrum() { return Spectra.Update(); }
+	const FAkMSpectrumFrame& LatestSpectrum() const { return Spectra.Read(); }
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	struct FSlotState
+	{
+		TAkMSpscRing<float> Ring;
+		TArray<float> Window;			// Last FFTSize samples
+		int32 NumBuffered = 0;
+		int32 Channel = INDEX_NONE;
+		TArray<float> SmoothedPower;	// Per display bin
+
+		FSlotState() : Ring(1 << 16) {}
+	};
+
+	void Configure(int32 InFFTSize, int32 InSampleRate);
+	void Analyze(FSlotState& Slot);
+	void Publish(float CpuPercent);
+
+	// Shared with the audio thread
+	std::atomic<int32> SlotChannels[MaxSlots];
+	std::atomic<int32> RequestedFFTSize { 4096 };
+	std::atomic<float> CpuBudgetPercent { 5.0f };
+	std::atomic<int32> StreamSampleRate { 0 };
+	std::atomic<int64> NumOverflows { 0 };
+	std::atomic<bool> bRunning { false };
+
+	// Worker state
+	FSlotState Slots[MaxSlots];
+	TUniquePtr<FAkMFFT> FFT;
+	int32 FFTSize = 0;
+	int32 SampleRate = 0;
+	TArray<float> HannWindow;
+	TArray<float> Real;
+	TArray<float> Imag;
+	TArray<int32> BinStart;				// First FFT bin of each display bin
+	TArray<int32> BinEnd;				// One past the last
+	TArray<float> BinFrequencies;
+	int64 NumAnalyzed = 0;
+	int64 NumSkipped = 0;
+
+	TAkMTripleBuffer<FAkMSpectrumFrame> Spectra;
+
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeEvent = nullptr;
+	FThreadSafeBool bStopRequested = false;
+};
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Lock-free single-producer/single-consumer ring of samples. Capacity is rounded up to a power of two and fixed at
+ * construction; a full ring drops what does not fit (Write returns how much was taken), so the producer never waits.
+ */
+template<typename T>
+class TAkMSpscRing
+{
+public:
+	explicit TAkMSpscRing(int32 MinCapacity)
+	{
+		Capacity = int32(FMath::RoundUpToPowerOfTwo(uint32(FMath::Max(2, MinCapacity))));
+		Mask = uint64(Capacity - 1);
+		Buffer.SetNumZeroed(Capacity);
+	}
+
+	int32 GetCapacity() const { return Capacity; }
+
+	// Producer: copy Count items, Stride apart in Data; returns the number written
+	int32 Write(const T* Data, int32 Count, int32 Stride = 1)
+	{
+		const uint64 WriteIndex = WritePos.load(std::memory_order_relaxed);
+		const uint64 ReadIndex = ReadPos.load(std::memory_order_acquire);
+		const int32 NumToWrite = FMath::Min(Count, Capacity - int32(WriteIndex - ReadIndex));
+		T* Items = Buffer.GetData();
+		for (int32 i = 0; i < NumToWrite; ++i)
+		{
+			Items[(WriteIndex + i) & Mask] = Data[i * Stride];
+		}
+		WritePos.store(WriteIndex + NumToWrite, std::memory_order_release);
+		return NumToWrite;
+	}
+
+	// Producer: free space
+	int32 NumFree() const { return Capacity - int32(WritePos.load(std::memory_order_relaxed) - ReadPos.load(std::memory_order_acquire)); }
+
+	// Consumer: items ready
+	int32 NumReadable() const { return int32(WritePos.load(std::memory_order_acquire) - ReadPos.load(std::memory_order_relaxed)); }
+
+	// Consumer: copy up to Count items into Out; returns the number read
+	int32 Read(T* Out, int32 Count)
+	{
+		const uint64 ReadIndex = ReadPos.load(std::memory_order_relaxed);
+		const uint64 WriteIndex = WritePos.load(std::memory_order_acquire);
+		const int32 NumToRead = FMath::Min(Count, int32(WriteIndex - ReadIndex));
+		const int32 First = FMath::Min(NumToRead, Capacity - int32(ReadIndex & Mask));
+		FMemory::Memcpy(Out, Buffer.GetData() + (ReadIndex & Mask), First * sizeof(T));
+		FMemory::Memcpy(Out + First, Buffer.GetData(), (NumToRead - First) * sizeof(T));
+		ReadPos.store(ReadIndex + NumToRead, std::memory_order_release);
+		return NumToRead;
+	}
+
+	// Consumer: drop up to Count items
+	int32 Skip(int32 Count)
+	{
+		const uint64 ReadIndex = ReadPos.load(std::memory_order_relaxed);
+		const int32 NumToSkip = FMath::Min(Count, int32(WritePos.load(std::memory_order_acquire) - ReadIndex));
+		ReadPos.store(ReadIndex + NumToSkip, std::memory_order_release);
+		return NumToSkip;
+	}
+
+private:
+	TArray<T> Buffer;
+	int32 Capacity = 0;
+	uint64 Mask = 0;
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> WritePos { 0 };
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> ReadPos { 0 };
+};
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+#include "akMFFT.h"
+#include "akMSignalGenerator.h"
+#include <atomic>
+
+// Impulse response summary of one speaker, as seen by the measurement input
+struct FAkMSpeakerMeasurement
+{
+	int32 DelaySamples = INDEX_NONE;	// Output to input, peak of the impulse response; INDEX_NONE when not found
+	float LevelDb = 0.0f;				// Energy of the impulse response around its peak, dB re a unit impulse
+	float PeakToNoiseDb = 0.0f;			// Peak over the RMS of the response's tail
+
+	bool IsValid() const { return DelaySamples != INDEX_NONE; }
+};
+
+enum class EAkMSweepMeasurementState : uint8
+{
+	Idle,
+	Armed,			// Waiting for the next output block
+	Running,		// Sweep playing, input being captured
+	Captured,		// Capture of the current speaker complete
+	Analyzing		// Deconvolution running on a task
+};
+
+/**
+ * Impulse responses of a set of speakers from exponential sweeps. One speaker at a time, the sweep is played on an
+ * output channel and the measurement input is captured from the same stream frame on (as FAkMLatencyProbe does).
+ * Once every speaker has been captured, Analyze deconvolves all captures with the sweep's regularized inverse
+ * spectrum in a ParallelFor on a UE::Tasks task. Owned by FAkMAudioTap, which feeds it the block frame counters.
+ */
+class AKMCONTROL_API FAkMSweepMeasurement
+{
+public:
+	static constexpr int32 MaxSpeakers = 32;
+	static constexpr float TailSeconds = 1.0f;
+	static constexpr float DetectionThresholdDb = 20.0f;
+	// Window of the response's energy around the peak: long enough for the subs' low end
+	static constexpr float LevelWindowBeforeSeconds = 0.001f;
+	static constexpr float LevelWindowAfterSeconds = 0.050f;
+	// A capture not complete this long after the sweep should have ended is cancelled
+	static constexpr double TimeoutSeconds = 3.0;
+
+	~FAkMSweepMeasurement();
+
+	// Game thread: prepare for NumSpeakers captures of Sweep (its gap is replaced by TailSeconds) at SampleRate
+	bool Begin(const FAkMSweepSettings& Sweep, int32 SampleRate, int32 NumSpeakers, float LevelDb);
+	// Game thread: play on OutputChannel and capture InputChannel into slot Speaker; false if busy
+	bool MeasureSpeaker(int32 Speaker, int32 OutputChannel, int32 InputChannel);
+	// Game thread: deconvolve every captured speaker on a task
+	bool Analyze();
+	void Cancel();
+
+	// Game thread: advances timeouts and the analysis; true when new results are available
+	bool Tick();
+
+	EAkMSweepMeasurementState GetState() const { return State.load(std::memory_order_acquire); }
+	bool IsBusy() const { return GetState() != EAkMSweepMeasurementState::Idle && GetState() != EAkMSweepMeasurementState::Captured; }
+	int32 GetSampleRate() const { return MeasurementSampleRate; }
+
+	// Game thread: results of the last analysis, one per speaker slot
+	const TArray<FAkMSpeakerMeasurement>& GetResults() const { return Results; }
+
+	// Audio thread; FrameCounter is the stream frame of the block's first sample in each direction
+	void RenderOutput(float* const* OutputData, int32 NumChannels, int32 NumFrames, uint64 FrameCounter);
+	void CapturePlanar(const float* const* ChannelData, int32 NumChannels, int32 NumFrames, uint64 FrameCounter);
+	void CaptureInterleaved(const float* Samples, int32 NumChannels, int32 NumFrames, uint64 FrameCounter);
+
+private:
+	// Block frames [OutStart, OutEnd) that fall in the capture, which they enter at OutOffset + frame; false when idle
+	bool BeginCapture(int32 NumFrames, uint64 FrameCounter, int32& OutStart, int32& OutEnd, int64& OutOffset) const;
+	void EndCapture(int32 NumFrames, int64 Offset);
+
+	void Deconvolve(int32 Speaker, FAkMSpeakerMeasurement& OutResult) const;
+
+	std::atomic<EAkMSweepMeasurementState> State { EAkMSweepMeasurementState::Idle };
+
+	// Set up by Begin; fixed while measuring
+	FAkMSweepSettings Sweep;
+	int32 MeasurementSampleRate = 0;
+	int32 NumSpeakerSlots = 0;
+	int32 SweepLength = 0;
+	int32 CaptureLength = 0;
+	float SweepGain = 0.0f;
+	TArray<float> SweepSamples;
+	TArray<float> Captures;						// Speaker-major, NumSpeakerSlots * CaptureLength
+	TUniquePtr<FAkMFFT> FFT;
+	TArray<float> InverseReal;					// Regularized inverse spectrum of the sweep
+	TArray<float> InverseImag;
+
+	// Current speaker, written by the game thread before arming
+	int32 CurrentSpeaker = 0;
+	int32 OutputChannel = 0;
+	int32 InputChannel = 0;
+	double StartTime = 0.0;
+
+	// Audio thread
+	std::atomic<uint64> EmitFrame { 0 };
+	int32 EmitPosition = 0;
+
+	UE::Tasks::FTask AnalysisTask;
+	TArray<FAkMSpeakerMeasurement> PendingResults;
+	TArray<FAkMSpeakerMeasurement> Results;
+};
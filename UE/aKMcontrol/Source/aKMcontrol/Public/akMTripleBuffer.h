@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Wait-free single-producer/single-consumer triple buffer. The writer fills GetWriteBuffer() and publishes it;
+ * the reader picks up the most recent published buffer with Update(). Neither side ever blocks or sees a partially
+ * written buffer; buffers published while the reader is not looking are replaced by newer ones.
+ */
+template<typename T>
+class TAkMTripleBuffer
+{
+public:
+	// Writer side
+	T& GetWriteBuffer() { return Buffers[WriteIndex]; }
+
+	void Publish()
+	{
+		const uint8 Previous = Shared.exchange(WriteIndex | DirtyBit, std::memory_order_acq_rel);
+		WriteIndex = Previous & IndexMask;
+	}
+
+	// True once the reader has taken the last published buffer (or nothing was published yet)
+	bool IsLastPublishConsumed() const { return (Shared.load(std::memory_order_acquire) & DirtyBit) == 0; }
+
+	// Reader side: returns true if a newer buffer was taken
+	bool Update()
+	{
+		if ((Shared.load(std::memory_order_relaxed) & DirtyBit) == 0)
+		{
+			return false;
+		}
+		const uint8 Previous = Shared.exchange(ReadIndex, std::memory_order_acq_rel);
+		ReadIndex = Previous & IndexMask;
+		return true;
+	}
+
+	const T& Read() const { return Buffers[ReadIndex]; }
+
+	// Set up every buffer (e.g. preallocate); only while neither side is running
+	template<typename FuncType>
+	void ForEachBuffer(FuncType&& Func)
+	{
+		for (T& Buffer : Buffers)
+		{
+			Func(Buffer);
+		}
+	}
+
+private:
+	static constexpr uint8 IndexMask = 0x3;
+	static constexpr uint8 DirtyBit = 0x4;
+
+	T Buffers[3];
+	alignas(PLATFORM_CACHE_LINE_SIZE) uint8 WriteIndex = 0;
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint8> Shared { 1 };
+	alignas(PLATFORM_CACHE_LINE_SIZE) uint8 ReadIndex = 2;
+};
@@ -1,5 +1,6 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
+using System.IO;
 using UnrealBuildTool;
 
 public class aKMcontrol : ModuleRules
@@ -13,6 +14,21 @@ public class aKMcontrol : ModuleRules
 		PublicDependencyModuleNames.AddRange(new string[] { "OSC" });
 		// JackAudioLink
 		PrivateDependencyModuleNames.AddRange(new string[] { "UEJackAudioLink" });
+		string JackLinkPublicDir = Path.Combine(ModuleDirectory, "..", "..", "Plugins", "UEJackAudioLink", "Source", "UEJackAudioLink", "Public");
+		// Audio tap fed from the plugin's JACK process callback (UEJackAudioLinkProcessHook.h); plugin versions without
+		// the hook build without it and the tap stays idle
+		PrivateDefinitions.Add("AKM_WITH_JACK_PROCESS_HOOK=" + (File.Exists(Path.Combine(JackLinkPublicDir, "UEJackAudioLinkProcessHook.h")) ? "1" : "0"));
+		// JACK port-connect notifications (OnJackPortConnectionChanged); without them external connections are only
+		// seen when the routing code queries JACK
+		string JackSubsystemHeader = Path.Combine(JackLinkPublicDir, "UEJackAudioLinkSubsystem.h");
+		bool bHasPortConnectEvent = File.Exists(JackSubsystemHeader) && File.ReadAllText(JackSubsystemHeader).Contains("OnJackPortConnectionChanged");
+		PrivateDefinitions.Add("AKM_WITH_JACK_PORT_CONNECT_EVENT=" + (bHasPortConnectEvent ? "1" : "0"));
+		// Per-port connection query (GetPortConnections, jack_port_get_all_connections); without it connections made
+		// outside the routing code are removed by sweeping port pairs
+		bool bHasPortConnections = File.Exists(JackSubsystemHeader) && File.ReadAllText(JackSubsystemHeader).Contains("GetPortConnections");
+		PrivateDefinitions.Add("AKM_WITH_JACK_PORT_CONNECTIONS=" + (bHasPortConnections ? "1" : "0"));
+		// Patchbay profiles (JSON)
+		PrivateDependencyModuleNames.AddRange(new string[] { "Json", "JsonUtilities" });
 		
 	}
 }
@@ -2,5 +2,33 @@
 
 #include "aKMcontrol.h"
 #include "Modules/ModuleManager.h"
+#include "akMAudioTap.h"
+#if AKM_WITH_JACK_PROCESS_HOOK
+#include "UEJackAudioLinkProcessHook.h"
+#endif
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, aKMcontrol, "aKMcontrol" );
+DEFINE_LOG_CATEGORY_STATIC(LogAkMModule, Log, All);
+
+class FAkMControlModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		// UEJackAudioLink is a dependency, so it is loaded by now; the tap runs inside its JACK process callback
+#if AKM_WITH_JACK_PROCESS_HOOK
+		UEJackAudioLink::SetProcessHook(&FAkMAudioTap::JackProcessHook, &FAkMAudioTap::Get());
+#else
+		UE_LOG(LogAkMModule, Warning, TEXT("UEJackAudioLink has no process hook; audio-thread meters, measurements, recording and playback are disabled."));
+#endif
+	}
+
+	virtual void ShutdownModule() override
+	{
+#if AKM_WITH_JACK_PROCESS_HOOK
+		// Returns once the callback can no longer be inside the tap
+		UEJackAudioLink::SetProcessHook(nullptr, nullptr);
+#endif
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FAkMControlModule, aKMcontrol, "aKMcontrol" );